@@ -78,3 +78,35 @@ nhm_helper_str_in_strv(const gchar *str,
 
   return retval;
 }
+
+
+/**
+ * nhm_helper_crc32:
+ * @data:   Data for which the checksum is calculated
+ * @len:    Length of @data in bytes
+ * @return: CRC-32 (IEEE 802.3) of the data.
+ *
+ * The function calculates the CRC-32 of the passed data. It is used to detect
+ * torn or corrupted records in files written by the NHM.
+ */
+guint32
+nhm_helper_crc32(gconstpointer data,
+                 gsize         len)
+{
+  const guint8 *byte    = (const guint8*) data;
+  guint32       crc     = 0xFFFFFFFF;
+  gsize         idx     = 0;
+  guint         bit_idx = 0;
+
+  for(idx = 0; idx < len; idx++)
+  {
+    crc ^= byte[idx];
+
+    for(bit_idx = 0; bit_idx < 8; bit_idx++)
+    {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+  }
+
+  return ~crc;
+}
@@ -41,5 +41,8 @@ DLT_IMPORT_CONTEXT(nhm_helper_trace_ctx);
 gboolean nhm_helper_str_in_strv(const gchar *str,
                                 gchar       *strv[]);
 
+guint32  nhm_helper_crc32      (gconstpointer data,
+                                gsize         len);
+
 
 #endif /* NHM_HELPER_H */
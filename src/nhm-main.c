@@ -60,6 +60,14 @@
 #include <stdlib.h>                         /* Use strtol                   */
 #include <signal.h>                         /* Define SIGTERM               */
 #include <errno.h>                          /* Use errno                    */
+#include <unistd.h>                         /* Use readlink                 */
+#include <limits.h>                         /* Use PATH_MAX                 */
+#include <fcntl.h>                          /* Use open                     */
+#include <sys/syscall.h>                    /* Use pidfd_open               */
+#include <sys/socket.h>                     /* Socket for proc connector    */
+#include <linux/netlink.h>                  /* Netlink messages             */
+#include <linux/connector.h>                /* Connector messages           */
+#include <linux/cn_proc.h>                  /* Proc connector events        */
 #include <glib-unix.h>                      /* Catch SIGTERM                */
 #include <gio/gio.h>                        /* GIO for dbus                 */
 #include <glib-2.0/glib.h>                  /* GLIB for lists, arrays, etc. */
@@ -84,7 +92,15 @@
 ******************************************************************************/
 
 /* File to manage data */
-#define NHM_LC_DATA_FILE (DATADIR"lcdata")
+#define NHM_LC_DATA_FILE   (DATADIR"lcdata")
+#define NHM_LC_DATA_MAGIC  0x4C4D484E /* "NHML" */
+#define NHM_LC_DATA_FORMAT 2
+
+/* Journal for changes of the current LC, since 'NHM_LC_DATA_FILE' was written */
+#define NHM_LC_JOURNAL_FILE      (DATADIR"lcjournal")
+#define NHM_JOURNAL_HEADER_MAGIC 0x4E484D4A /* "NHMJ" */
+#define NHM_JOURNAL_RECORD_MAGIC 0x4E484D52 /* "NHMR" */
+#define NHM_JOURNAL_NAME_SIZE    256
 
 /* Persistence IDs to manage shutdown flag */
 #define NHM_SHUTDOWN_FLAG_LDBID 0xFF
@@ -93,10 +109,47 @@
 /* File to load config from (flag 'CONFDIR' comes from Makefile) */
 #define NHM_CFG_FILE (CONFDIR"node-health-monitor.conf")
 
+/* Folder with process infos (flag 'PROCDIR' comes from Makefile) and size of
+ * the paths to the infos of a process */
+#define NHM_PROC_DIR       PROCDIR
+#define NHM_PROC_PATH_SIZE (sizeof(NHM_PROC_DIR) + 32)
+
 /* Definitions for NSM connection */
 #define NHM_LC_CLIENT_OBJ     "/org/genivi/NodeHealthMonitor/LifecycleClient"
 #define NHM_LC_CLIENT_TIMEOUT 1000
 
+/* Default for max. amount of parallel 'SetAppHealthStatus' calls to the NSM */
+#define NHM_NSM_CALLS_DEFAULT 8
+
+/* Default for max. amount of monitored procs. that are executed in parallel */
+#define NHM_PROC_CHECKS_DEFAULT 4
+
+/* Default timeout in s for monitored procs., after which they are killed */
+#define NHM_PROC_CHECK_TIMEOUT_DEFAULT 60
+
+/* Timer wheel of the userland checks. Each level has 2^6 slots. A slot of
+ * level 0 covers 1 s, of level 1 64 s and of level 2 4096 s. */
+#define NHM_WHEEL_BITS   6
+#define NHM_WHEEL_SLOTS  (1 << NHM_WHEEL_BITS)
+#define NHM_WHEEL_MASK   (NHM_WHEEL_SLOTS - 1)
+#define NHM_WHEEL_LEVELS 3
+
+/* Name under which the grouped check of all monitored programs is reported */
+#define NHM_PROG_CHECK_NAME "monitored_progs"
+
+/* Max. time in s, which a sweep of all checks waits for pending checks. It is
+ * below the default timeout of D-Bus calls (25 s). */
+#define NHM_SWEEP_TIMEOUT 20
+
+/* Deadline in ms of a probe of a monitored dbus, if no probe timeout is
+ * configured. It is the default timeout of D-Bus calls (25 s), which bounds
+ * the connect to the bus as well. */
+#define NHM_DBUS_PROBE_TIMEOUT_DEFAULT 25000
+
+/* Amount of buckets of the RTT histogram of a monitored dbus. Bucket 'n'
+ * counts RTTs below 4^n ms. The last bucket counts all longer RTTs. */
+#define NHM_DBUS_RTT_BUCKETS 8
+
 /**
  * NhmNodeState:
  * @NHM_NODESTATE_NOTSET:   Default value to init. variables.
@@ -112,23 +165,12 @@ typedef enum
   NHM_NODESTATE_SHUTDOWN
 } NhmNodeState;
 
-/**
- * NhmCurrentFailedApp:
- * @name: Name of the failed app.
- *
- * Info for currently failed app, used to create list of currently failed apps
- */
-typedef struct
-{
-  gchar *name;
-} NhmCurrentFailedApp;
-
 /**
  * NhmFailedApp:
  * @name:      Name of the failed app.
  * @failcount: Number of times, the app. switched from running to failed.
  *
- * Info for a failed app, used to create list of failed apps in a LC.
+ * Info for a failed app, used to create the table of failed apps in a LC.
  */
 typedef struct
 {
@@ -139,20 +181,197 @@ typedef struct
 /**
  * NhmLcInfo:
  * @start_state: State which was found in flag file, when NHM started.
- * @failed_apps: List of failed apps in the LC.
+ * @failed_apps: Table of failed apps in the LC. Key is the app. name owned by
+ *               the value, the 'NhmFailedApp'. %NULL, until a LC that has been
+ *               read from the LC data file is decoded.
+ * @map:         Mapped LC data file, while the LC is not decoded.
+ * @block:       Block of the LC in @map, while the LC is not decoded.
+ * @block_size:  Size of @block in bytes.
+ * @app_count:   Number of failed apps. in @block.
  *
  * Info for a LC. Used to create an array with info. for multiple LCs.
+ * Always access the failed apps. with 'nhm_main_get_failed_apps'.
  */
 typedef struct
 {
   NhmNodeState  start_state;
-  GSList       *failed_apps;
+  GHashTable   *failed_apps;
+  GMappedFile  *map;
+  const gchar  *block;
+  guint         block_size;
+  guint         app_count;
 } NhmLcInfo;
 
 /**
- * NhmMonitoredDbus:
- * @bus_addr: Bus address of the observed dbus.
- * @bus_conn: Connection to bus, created at startup.
+ * NhmLcDataHeader:
+ * @magic:       Always 'NHM_LC_DATA_MAGIC'.
+ * @format:      Format of the file. Always 'NHM_LC_DATA_FORMAT'.
+ * @nhm_version: Version of the NHM that wrote the file.
+ * @lc_count:    Number of LCs in the file.
+ * @generation:  Incremented whenever the file is written. Never 0.
+ *
+ * Header of the LC data file. It is followed by the index of the LCs.
+ */
+typedef struct
+{
+  guint32 magic;
+  guint32 format;
+  guint32 nhm_version;
+  guint32 lc_count;
+  guint32 generation;
+} NhmLcDataHeader;
+
+/**
+ * NhmLcDataIndex:
+ * @start_state:  State which was found in flag file, when the LC started.
+ * @app_count:    Number of failed apps. in the LC.
+ * @block_offset: Offset of the LCs block from the start of the file.
+ * @block_size:   Size of the LCs block in bytes.
+ *
+ * Index entry of a LC in the LC data file.
+ */
+typedef struct
+{
+  guint32 start_state;
+  guint32 app_count;
+  guint32 block_offset;
+  guint32 block_size;
+} NhmLcDataIndex;
+
+/**
+ * NhmLcDataApp:
+ * @name_offset: Offset of the app. name from the start of the LCs block.
+ * @failcount:   Number of times, the app. switched from running to failed.
+ *
+ * Entry of a failed app. in the block of a LC in the LC data file.
+ */
+typedef struct
+{
+  guint32 name_offset;
+  guint32 failcount;
+} NhmLcDataApp;
+
+/**
+ * NhmNsmCall:
+ * @name:       Name of the app., whose status is forwarded to the NSM.
+ * @running:    Status that is forwarded to the NSM.
+ * @queue_time: Monotonic time (in us) when the status has been queued.
+ * @send_time:  Monotonic time (in us) when the status has been sent to NSM.
+ *
+ * A queued or pending 'SetAppHealthStatus' call to the NSM.
+ */
+typedef struct
+{
+  gchar    *name;
+  gboolean  running;
+  gint64    queue_time;
+  gint64    send_time;
+} NhmNsmCall;
+
+/**
+ * NhmNsmCallStats:
+ * @sent:       Number of calls that have been sent to the NSM.
+ * @failed:     Number of calls that failed because of D-Bus errors.
+ * @timed_out:  Number of calls for which the NSM did not answer in time.
+ * @max_queued: Highest number of states that had to wait in the queue.
+ * @sum_wait:   Sum of times (in us) that states waited in the queue.
+ * @sum_rtt:    Sum of round trip times (in us) of completed calls.
+ * @max_rtt:    Highest round trip time (in us) of a completed call.
+ *
+ * Accounting for the forwarding of app. states to the NSM.
+ */
+typedef struct
+{
+  guint  sent;
+  guint  failed;
+  guint  timed_out;
+  guint  max_queued;
+  gint64 sum_wait;
+  gint64 sum_rtt;
+  gint64 max_rtt;
+} NhmNsmCallStats;
+
+/**
+ * NhmLcStats:
+ * @app_totals:       Table of fail counts of the apps. in the LCs used for
+ *                    statistics. Key is the app. name of one of the LCs, value
+ *                    the sum of the apps. fail counts. %NULL, if not
+ *                    calculated.
+ * @lc_count:         Number of LCs used for the statistics.
+ * @failed_shutdowns: Number of LCs used for statistics, whose previous LC
+ *                    was not shut down completely.
+ *
+ * Rolling statistics over the LCs used for 'ReadStatistics'.
+ */
+typedef struct
+{
+  GHashTable *app_totals;
+  guint       lc_count;
+  guint       failed_shutdowns;
+} NhmLcStats;
+
+/**
+ * NhmJournalHeader:
+ * @magic:      Always 'NHM_JOURNAL_HEADER_MAGIC'.
+ * @generation: Generation of the 'NHM_LC_DATA_FILE', the journal belongs to.
+ * @crc:        CRC-32 of the preceding members.
+ *
+ * First entry in the journal. Binds the journal to one LC data file.
+ */
+typedef struct
+{
+  guint32 magic;
+  guint32 generation;
+  guint32 crc;
+} NhmJournalHeader;
+
+/**
+ * NhmJournalRecord:
+ * @magic:     Always 'NHM_JOURNAL_RECORD_MAGIC'.
+ * @failcount: New fail count of the app. in the LC.
+ * @name:      Name of the app. (zero terminated).
+ * @crc:       CRC-32 of the preceding members.
+ *
+ * Journal entry, written when the fail count of an app. increased.
+ */
+typedef struct
+{
+  guint32 magic;
+  guint32 failcount;
+  gchar   name[NHM_JOURNAL_NAME_SIZE];
+  guint32 crc;
+} NhmJournalRecord;
+
+/**
+ * NhmLcDataStats:
+ * @flushes:   Number of times the LC data has been written.
+ * @coalesced: Number of changes that did not cause an own write.
+ * @snapshots: Number of times the whole LC data file has been written.
+ * @records:   Number of records that have been appended to the journal.
+ * @bytes:     Sum of bytes that have been written.
+ * @max_time:  Highest time (in us) that was needed for a write.
+ *
+ * Accounting for the (delayed) writing of the LC data.
+ */
+typedef struct
+{
+  guint  flushes;
+  guint  coalesced;
+  guint  snapshots;
+  guint  records;
+  guint  bytes;
+  gint64 max_time;
+} NhmLcDataStats;
+
+/**
+ * NhmCheckedDbus:
+ * @bus_addr:   Bus address of the observed dbus.
+ * @bus_conn:   Connection to bus, opened by the first probe.
+ * @probe:      Cancellable of the pending probe. %NULL, if no probe is pending.
+ * @deadline:   ID of the source that fails the pending probe, if it takes
+ *              too long.
+ * @start_time: Monotonic time (in us) when the pending probe has been started.
+ * @rtt_hist:   Histogram of the RTTs of all finished probes.
  *
  * Used to create an array of monitored busses, based on the config.
  */
@@ -160,8 +379,186 @@ typedef struct
 {
   gchar           *bus_addr;
   GDBusConnection *bus_conn;
+  GCancellable    *probe;
+  guint            deadline;
+  gint64           start_time;
+  guint            rtt_hist[NHM_DBUS_RTT_BUCKETS];
 } NhmCheckedDbus;
 
+/**
+ * NhmCheckType:
+ * @NHM_CHECK_FILE: Check of a monitored file.
+ * @NHM_CHECK_PROG: Check of a monitored program.
+ * @NHM_CHECK_PROC: Check of a monitored proc.
+ * @NHM_CHECK_DBUS: Check of a monitored dbus.
+ *
+ * Kind of a userland check.
+ */
+typedef enum
+{
+  NHM_CHECK_FILE,
+  NHM_CHECK_PROG,
+  NHM_CHECK_PROC,
+  NHM_CHECK_DBUS
+} NhmCheckType;
+
+/**
+ * NhmCheckEvent:
+ * @NHM_CHECK_EVENT_FAILED:   A userland check failed.
+ * @NHM_CHECK_EVENT_INTERVAL: The effective interval of a check changed.
+ * @NHM_CHECK_EVENT_REPORT:   A sweep of all checks finished.
+ *
+ * Kind of a result, which is posted by the check worker to the main loop.
+ */
+typedef enum
+{
+  NHM_CHECK_EVENT_FAILED,
+  NHM_CHECK_EVENT_INTERVAL,
+  NHM_CHECK_EVENT_REPORT
+} NhmCheckEvent;
+
+/**
+ * NhmCheckResult:
+ * @next:     Result that has been posted before.
+ * @event:    Kind of the result.
+ * @type:     Kind of the check.
+ * @name:     Interned name of the checked file, program, proc. or bus.
+ * @reason:   Static description of the failure. Only set for
+ *            %NHM_CHECK_EVENT_FAILED.
+ * @interval: Effective interval of the check in s. Only set for
+ *            %NHM_CHECK_EVENT_INTERVAL.
+ * @report:   Health report ("a{sv}") built by a sweep. Only set for
+ *            %NHM_CHECK_EVENT_REPORT.
+ *
+ * Failure of a userland check, change of its cadence or health report,
+ * posted by the check worker to the main loop.
+ */
+typedef struct _NhmCheckResult NhmCheckResult;
+
+struct _NhmCheckResult
+{
+  NhmCheckResult *next;
+  NhmCheckEvent   event;
+  NhmCheckType    type;
+  const gchar    *name;
+  const gchar    *reason;
+  guint           interval;
+  GVariant       *report;
+};
+
+/**
+ * NhmCheckEntry:
+ * @type:         Kind of the check.
+ * @idx:          Index of the checked object in its config list. Not used for
+ *                programs, which are all checked by one scan.
+ * @name:         Interned name under which the check is reported.
+ * @interval:     Configured (fast) period of the check in s.
+ * @cur_interval: Effective period of the check in s. It grows up to
+ *                'ul_chk_backoff_max', while the node is healthy.
+ * @failures:     Value of 'check_failures' when the check was scheduled last.
+ * @phase:        Offset in s of the first execution after the start of the
+ *                checks.
+ * @jitter:       Max. random delay in s added to each period.
+ * @due:          Tick of the timer wheel, at which the check is executed next.
+ * @level:        Level of the wheel that holds the check.
+ * @slot:         Slot of the level that holds the check.
+ * @running:      %TRUE, if the check has been started and not finished yet.
+ * @started:      Monotonic time, when the check has been started.
+ * @duration:     Duration in us of the last finished execution.
+ * @failed:       %TRUE, if the last finished execution failed.
+ * @reason:       Static description of the last failure.
+ * @missing:      Interned names of the programs that were not running in the
+ *                last execution. Only used for the check of the programs.
+ * @changed:      Real time, when the status of the check changed last. 0, if
+ *                the check has not finished yet.
+ * @sweep:        %TRUE, if the pending sweep waits for the check.
+ *
+ * Scheduling and status of one userland check in the timer wheel.
+ */
+typedef struct
+{
+  NhmCheckType  type;
+  guint         idx;
+  const gchar  *name;
+  guint         interval;
+  guint         cur_interval;
+  gint          failures;
+  guint         phase;
+  guint         jitter;
+  guint64       due;
+  guint         level;
+  guint         slot;
+  gboolean      running;
+  gint64        started;
+  gint64        duration;
+  gboolean      failed;
+  const gchar  *reason;
+  GPtrArray    *missing;
+  gint64        changed;
+  gboolean      sweep;
+} NhmCheckEntry;
+
+/**
+ * NhmProcCheck:
+ * @name:        Interned full path to the executable of the monitored proc.
+ * @pid:         Process ID of the running check. 0, if the check is not
+ *               running.
+ * @queued:      %TRUE, if the check is queued for execution.
+ * @child_watch: ID of the source that watches the exit of the check.
+ * @timeout:     ID of the source that kills the check, if it takes too long.
+ * @timed_out:   %TRUE, if the running check has been killed.
+ * @start_time:  Monotonic time (in us) when the check has been started.
+ * @duration:    Wall time (in us) of the last finished check.
+ * @status:      Wait status of the last finished check. -1, if it could not
+ *               be started.
+ *
+ * Execution state of a monitored proc. The procs. are executed in parallel.
+ */
+typedef struct
+{
+  const gchar *name;
+  GPid         pid;
+  gboolean     queued;
+  guint        child_watch;
+  guint        timeout;
+  gboolean     timed_out;
+  gint64       start_time;
+  gint64       duration;
+  gint         status;
+} NhmProcCheck;
+
+/**
+ * NhmWatchedDir:
+ * @monitor: Monitor of the directory.
+ * @files:   Indices of the monitored files (in 'monitored_files') that are
+ *           located in the directory.
+ *
+ * Parent directory of monitored files. Changes in the directory are used to
+ * keep the existence bitmap of the monitored files up to date.
+ */
+typedef struct
+{
+  GFileMonitor *monitor;
+  GArray       *files;
+} NhmWatchedDir;
+
+/**
+ * NhmProgPid:
+ * @pid:        Process ID of a running monitored program.
+ * @start_time: Start time of the process (field 22 of '/proc/<pid>/stat').
+ * @watch:      ID of the source that watches the pidfd of the process. 0, if
+ *              the process is not watched.
+ *
+ * Cached process of a monitored program. The start time identifies the
+ * process, because a PID can be reused by another process.
+ */
+typedef struct
+{
+  glong   pid;
+  guint64 start_time;
+  guint   watch;
+} NhmProgPid;
+
 /******************************************************************************
 *
 * Prototypes for file local functions (see implementation for description)
@@ -171,26 +568,60 @@ typedef struct
 /* Functions to free occupied memory */
 static void                  nhm_main_free_lc_info             (gpointer                lc_info);
 static void                  nhm_main_free_failed_app          (gpointer                failed_app);
-static void                  nhm_main_free_current_failed_app  (gpointer                failed_app);
 static void                  nhm_main_free_checked_dbus        (gpointer                checked_dbus);
 static void                  nhm_main_free_nhm_objects         (void);
 static void                  nhm_main_free_nsm_objects         (void);
 static void                  nhm_main_free_config_objects      (void);
+static void                  nhm_main_free_check_entry         (gpointer                entry);
 static void                  nhm_main_free_check_objects       (void);
 
-/* Functions to find apps. */
+/* Functions to create LCs and to find and add apps. */
+static NhmLcInfo            *nhm_main_new_lc_info              (NhmNodeState            start_state);
+static NhmLcInfo            *nhm_main_new_mapped_lc_info       (NhmNodeState            start_state,
+                                                                GMappedFile            *map,
+                                                                const NhmLcDataIndex   *index);
+static GHashTable           *nhm_main_get_failed_apps          (NhmLcInfo              *lc_info);
+static NhmFailedApp         *nhm_main_add_failed_app           (NhmLcInfo              *lc_info,
+                                                                const gchar            *app_name,
+                                                                guint                   failcount);
 static NhmFailedApp         *nhm_main_find_failed_app          (NhmLcInfo              *lc_info,
                                                                 const gchar            *search_app);
-static NhmCurrentFailedApp  *nhm_main_find_current_failed_app  (const gchar            *search_app);
+static const gchar          *nhm_main_find_current_failed_app  (const gchar            *search_app);
+
+/* Rolling statistics for 'ReadStatistics' */
+static void                  nhm_main_update_lc_stats          (void);
+static void                  nhm_main_reset_lc_stats           (void);
+static void                  nhm_main_count_app_failure        (const gchar            *name);
 
 /* Helper functions for dbus callbacks */
 static void                  nhm_main_check_failed_app_restart (void);
 static NhmErrorStatus_e      nhm_main_request_restart          (NsmRestartReason_e      restart_reason,
                                                                 guint                   restart_type);
+static gboolean              nhm_main_apply_app_status         (const gchar            *name,
+                                                                NhmAppStatus_e          status);
 static void                  nhm_main_register_app_status      (const gchar            *name,
                                                                 NhmAppStatus_e          status);
 
+/* Asynchronous forwarding of app. states to the NSM */
+static void                  nhm_main_free_nsm_call            (gpointer                nsm_call);
+static void                  nhm_main_queue_nsm_call           (const gchar            *name,
+                                                                gboolean                running);
+static void                  nhm_main_send_nsm_calls           (void);
+static void                  nhm_main_nsm_call_finished_cb     (GObject                *source_object,
+                                                                GAsyncResult           *res,
+                                                                gpointer                user_data);
+
 /* Callbacks for D-Bus interfaces */
+static gboolean              nhm_main_read_all_statistics_cb   (NhmDbusInfo            *object,
+                                                                GDBusMethodInvocation  *invocation,
+                                                                const gchar            *prefix,
+                                                                gpointer                user_data);
+static gboolean              nhm_main_read_check_intervals_cb  (NhmDbusInfo            *object,
+                                                                GDBusMethodInvocation  *invocation,
+                                                                gpointer                user_data);
+static gboolean              nhm_main_get_health_report_cb     (NhmDbusInfo            *object,
+                                                                GDBusMethodInvocation  *invocation,
+                                                                gpointer                user_data);
 static gboolean              nhm_main_read_statistics_cb       (NhmDbusInfo            *object,
                                                                 GDBusMethodInvocation  *invocation,
                                                                 const gchar            *app_name,
@@ -200,6 +631,10 @@ static gboolean              nhm_main_register_app_status_cb   (NhmDbusInfo
                                                                 const gchar           *app_name,
                                                                 gint                   app_status,
                                                                 gpointer               user_data);
+static gboolean              nhm_main_register_batch_cb        (NhmDbusInfo           *object,
+                                                                GDBusMethodInvocation *invocation,
+                                                                GVariant              *app_status_list,
+                                                                gpointer               user_data);
 static gboolean              nhm_main_request_node_restart_cb  (NhmDbusInfo           *object,
                                                                 GDBusMethodInvocation *invocation,
                                                                 const gchar           *app_name,
@@ -228,14 +663,123 @@ static void                  nhm_main_name_lost_cb             (GDBusConnection
 
 /* Functions for userland checks */
 static gboolean              nhm_does_file_exist                (gchar                *file_name);
-static gboolean              nhm_main_is_process_running        (gchar                *prog);
-static gboolean              nhm_main_is_process_ok             (gchar                *process);
-static gboolean              nhm_main_is_dbus_alive             (NhmCheckedDbus       *checked_dbus);
-static gboolean              nhm_main_timer_userland_check_cb   (gpointer              user_data);
+static gboolean              nhm_main_bitmap_get                (const guint8         *bitmap,
+                                                                 guint                 idx);
+static void                  nhm_main_bitmap_set                (guint8               *bitmap,
+                                                                 guint                 idx,
+                                                                 gboolean              value);
+static void                  nhm_main_free_watched_dir          (gpointer              watched_dir);
+static void                  nhm_main_watch_files               (void);
+static void                  nhm_main_file_changed_cb           (GFileMonitor         *monitor,
+                                                                 GFile                *file,
+                                                                 GFile                *other_file,
+                                                                 GFileMonitorEvent     event_type,
+                                                                 gpointer              user_data);
+static gboolean              nhm_main_is_file_present           (guint                 file_idx);
+static gboolean              nhm_main_read_start_time           (const gchar          *pid,
+                                                                 guint64              *start_time);
+static gboolean              nhm_main_is_prog_pid               (const gchar          *prog,
+                                                                 const gchar          *pid,
+                                                                 guint64              *start_time);
+static void                  nhm_main_free_prog_pid             (gpointer              prog_pid);
+static void                  nhm_main_watch_indexed_prog        (const gchar          *prog);
+static guint                 nhm_main_watch_prog_pid            (const gchar          *prog,
+                                                                 glong                 pid);
+static gboolean              nhm_main_prog_exit_cb              (GIOChannel           *channel,
+                                                                 GIOCondition          condition,
+                                                                 gpointer              user_data);
+static void                  nhm_main_proc_events_add_pid       (glong                 pid);
+static void                  nhm_main_proc_events_index_pid     (glong                 pid,
+                                                                 gpointer              prog);
+static void                  nhm_main_proc_events_remove_pid    (glong                 pid);
+static void                  nhm_main_proc_events_scan          (void);
+static gboolean              nhm_main_proc_events_connect       (void);
+static void                  nhm_main_proc_events_disconnect    (void);
+static gboolean              nhm_main_proc_events_cb            (GIOChannel           *channel,
+                                                                 GIOCondition          condition,
+                                                                 gpointer              user_data);
+static const gchar*          nhm_main_find_missing_prog         (gchar               **progs,
+                                                                 GPtrArray            *missing_progs);
+static void                  nhm_main_free_proc_check           (gpointer              proc_check);
+static void                  nhm_main_queue_proc_check          (const gchar          *proc);
+static void                  nhm_main_run_proc_checks           (void);
+static void                  nhm_main_start_proc_check          (NhmProcCheck         *check);
+static void                  nhm_main_proc_check_exit_cb        (GPid                  pid,
+                                                                 gint                  status,
+                                                                 gpointer              user_data);
+static gboolean              nhm_main_proc_check_timeout_cb     (gpointer              user_data);
+static void                  nhm_main_probe_dbus                (NhmCheckedDbus       *checked_dbus);
+static void                  nhm_main_dbus_connected_cb         (GObject              *source_object,
+                                                                 GAsyncResult         *res,
+                                                                 gpointer              user_data);
+static void                  nhm_main_dbus_call_get_id          (NhmCheckedDbus       *checked_dbus);
+static void                  nhm_main_dbus_get_id_cb            (GObject              *source_object,
+                                                                 GAsyncResult         *res,
+                                                                 gpointer              user_data);
+static void                  nhm_main_dbus_probe_finished       (NhmCheckedDbus       *checked_dbus,
+                                                                 const GError         *error);
+static gint64                nhm_main_dbus_count_rtt            (NhmCheckedDbus       *checked_dbus);
+static gboolean              nhm_main_dbus_deadline_cb          (gpointer              user_data);
+static void                  nhm_main_dbus_failed               (NhmCheckedDbus       *checked_dbus,
+                                                                 const gchar          *reason);
+static void                  nhm_main_add_check_entry           (NhmCheckType          type,
+                                                                 guint                 idx,
+                                                                 const gchar          *name,
+                                                                 guint                 count,
+                                                                 guint                 interval);
+static void                  nhm_main_schedule_checks           (void);
+static void                  nhm_main_wheel_insert              (NhmCheckEntry        *entry);
+static void                  nhm_main_wheel_remove              (NhmCheckEntry        *entry);
+static void                  nhm_main_adapt_check_interval      (NhmCheckEntry        *entry);
+static void                  nhm_main_reset_check_intervals     (void);
+static void                  nhm_main_wheel_cascade             (guint                 level);
+static void                  nhm_main_wheel_advance             (void);
+static gboolean              nhm_main_wheel_tick_cb             (gpointer              user_data);
+static void                  nhm_main_run_check                 (NhmCheckEntry        *entry);
+static void                  nhm_main_finish_check              (NhmCheckEntry        *entry,
+                                                                 const gchar          *reason);
+static void                  nhm_main_finish_check_by_name      (const gchar          *name,
+                                                                 const gchar          *reason);
+static gboolean              nhm_main_start_sweep_cb            (gpointer              user_data);
+static gboolean              nhm_main_sweep_timeout_cb          (gpointer              user_data);
+static void                  nhm_main_finish_sweep              (void);
+static GVariant*             nhm_main_build_health_report       (void);
+static guint                 nhm_main_add_check_source          (GSource              *source,
+                                                                 GSourceFunc           func,
+                                                                 gpointer              user_data);
+static void                  nhm_main_remove_check_source       (guint                 source_id);
+static void                  nhm_main_post_check_result         (NhmCheckType          type,
+                                                                 const gchar          *name,
+                                                                 const gchar          *reason);
+static void                  nhm_main_post_check_interval       (NhmCheckEntry        *entry);
+static void                  nhm_main_push_check_result         (NhmCheckResult       *result);
+static gboolean              nhm_main_check_results_cb          (gpointer              user_data);
+static void                  nhm_main_install_checks            (void);
+static gpointer              nhm_main_check_worker              (gpointer              user_data);
+static gboolean              nhm_main_quit_check_worker_cb      (gpointer              user_data);
+static void                  nhm_main_start_check_worker        (void);
+static void                  nhm_main_stop_check_worker         (void);
 
 /* Functions to read and write run time data */
 static void                  nhm_main_write_data                (void);
+static void                  nhm_main_write_journal             (void);
+static void                  nhm_main_open_journal              (void);
+static void                  nhm_main_close_journal             (void);
+static void                  nhm_main_update_data_stats         (guint                 bytes,
+                                                                 gint64                start_time);
+static void                  nhm_main_mark_data_dirty           (void);
+static void                  nhm_main_flush_data                (void);
+static gboolean              nhm_main_timer_write_data_cb       (gpointer              user_data);
 static void                  nhm_main_read_data                 (void);
+static NhmLcInfo            *nhm_main_read_data_v1              (const gchar          *data,
+                                                                 gsize                 data_len);
+static NhmLcInfo            *nhm_main_read_data_v2              (GMappedFile          *map);
+static gboolean              nhm_main_read_uint                 (const gchar          *data,
+                                                                 gsize                 data_len,
+                                                                 gsize                *offset,
+                                                                 guint                *value);
+static void                  nhm_main_read_journal              (NhmLcInfo            *lc_info,
+                                                                 guint32               generation);
 static NhmNodeState          nhm_main_read_shutdown_flag        (void);
 static gboolean              nhm_main_write_shutdown_flag       (NhmNodeState          flagval);
 
@@ -269,24 +813,109 @@ static NsmDbusLcConsumer *dbus_lc_consumer_obj = NULL;
 static gint               mainreturn           = 0;
 static GMainLoop         *mainloop             = NULL;
 
-/* Run time data. Array for life cycles and list for the current LC */
+/* Run time data. Array for life cycles and set of failed apps. in current LC */
 static GPtrArray         *nodeinfo             = NULL;
-static GSList            *current_failed_apps  = NULL;
+static GHashTable        *current_failed_apps  = NULL;
 
 /* Variables to handle configured checks */
 static GPtrArray         *checked_dbusses      = NULL;
 
+/* Timer wheel of the checks. All entries, lists of entries per slot, current
+ * tick, start time and the single source that drives the wheel */
+static GPtrArray         *check_entries        = NULL;
+static GSList            *check_wheel[NHM_WHEEL_LEVELS][NHM_WHEEL_SLOTS];
+static guint64            check_wheel_now      = 0;
+static gint64             check_wheel_start    = 0;
+static guint              check_wheel_timer    = 0;
+static gint               check_wheel_failures = 0;
+static GHashTable        *check_entry_names    = NULL;
+
+/* Sweep of all checks. Amount of checks the sweep waits for and its timeout.
+ * D-Bus calls waiting for the report are queued by the main loop. */
+static guint              sweep_pending        = 0;
+static guint              sweep_timer          = 0;
+static GQueue            *sweep_invocations    = NULL;
+
+/* Health of the node for the cadence of the checks. Count of failures, which
+ * is incremented by the checks and by failing apps., and amount of currently
+ * failed apps. Effective intervals of the checks, kept by the main loop. */
+static volatile gint      check_failures       = 0;
+static volatile gint      check_apps_failed    = 0;
+static GHashTable        *check_intervals      = NULL;
+
+/* Worker thread that runs the checks in its own main context. Failures are
+ * posted to the main loop through a lock-free list. */
+static GMainContext      *check_context        = NULL;
+static GMainLoop         *check_loop           = NULL;
+static GThread           *check_thread         = NULL;
+static NhmCheckResult    *check_results        = NULL;
+
+/* Watched parent dirs. of monitored files and bitmaps of the monitored files
+ * that are watched and that exist */
+static GHashTable        *watched_dirs         = NULL;
+static guint8            *files_watched        = NULL;
+static guint8            *files_exist          = NULL;
+static GHashTable        *monitored_pids       = NULL;
+
+/* Monitored procs. Table of all checks, queue of checks to be executed */
+static GHashTable        *proc_checks          = NULL;
+static GQueue            *proc_check_queue     = NULL;
+static guint              proc_checks_running  = 0;
+
+/* Process index maintained by the proc connector. PIDs -> program and
+ * program -> amount of running processes */
+static guint              proc_events_watch    = 0;
+static GHashTable        *proc_events_pids     = NULL;
+static GHashTable        *proc_events_progs    = NULL;
+
+/* Queue of app. states for the NSM. Table of apps. with a pending call */
+static GQueue            *nsm_call_queue       = NULL;
+static GHashTable        *nsm_call_apps        = NULL;
+static GCancellable      *nsm_call_cancel      = NULL;
+static guint              nsm_calls_pending    = 0;
+static NhmNsmCallStats    nsm_call_stats;
+
+/* Delayed writing of LC data */
+static guint              lc_data_changes      = 0;
+static guint              lc_data_timer        = 0;
+static GHashTable        *lc_data_dirty_apps   = NULL;
+static FILE              *lc_journal           = NULL;
+static guint32            lc_data_generation   = 0;
+static NhmLcDataStats     lc_data_stats;
+
+/* Rolling statistics */
+static NhmLcStats         lc_stats;
+
 /* Variables to read the configuration */
 static gchar            **no_restart_apps      = NULL;
 static guint              max_lc_count         = 0;
 static guint              max_failed_apps      = 0;
+static guint              max_nsm_calls        = NHM_NSM_CALLS_DEFAULT;
+static guint              nsm_call_timeout     = 0;
+static guint              lc_data_write_delay  = 0;
 
 static guint              ul_chk_interval      = 0;
+static guint              ul_chk_jitter        = 0;
+static guint              ul_chk_backoff_max   = 0;
+static guint              file_chk_interval    = 0;
+static guint              prog_chk_interval    = 0;
+static guint              proc_chk_interval    = 0;
+static guint              dbus_chk_interval    = 0;
+static guint              max_proc_checks      = NHM_PROC_CHECKS_DEFAULT;
+static guint              proc_check_timeout   = NHM_PROC_CHECK_TIMEOUT_DEFAULT;
+static guint              dbus_probe_timeout   = 0;
+static guint              dbus_max_rtt         = 0;
+static gboolean           watch_progs          = FALSE;
+static gboolean           proc_events          = FALSE;
 static gchar            **monitored_files      = NULL;
 static gchar            **monitored_procs      = NULL;
 static gchar            **monitored_progs      = NULL;
 static gchar            **monitored_dbus       = NULL;
 
+static gchar            **include_units        = NULL;
+static gchar            **exclude_units        = NULL;
+static gchar            **unit_types           = NULL;
+
 
 /******************************************************************************
 *
@@ -309,6 +938,18 @@ nhm_main_free_checked_dbus(gpointer checked_dbus)
 
   g_free(bus->bus_addr);
 
+  if(bus->deadline != 0)
+  {
+    nhm_main_remove_check_source(bus->deadline);
+  }
+
+  /* The callback of a pending probe will not access the bus any more */
+  if(bus->probe != NULL)
+  {
+    g_cancellable_cancel(bus->probe);
+    g_object_unref(bus->probe);
+  }
+
   if(bus->bus_conn != NULL)
   {
     g_object_unref(bus->bus_conn);
@@ -317,34 +958,18 @@ nhm_main_free_checked_dbus(gpointer checked_dbus)
   g_free(checked_dbus);
 }
 
-/**
- * nhm_main_free_current_failed_app:
- * @failed_app: Pointer to 'NhmCurrentFailedApp' object.
- *
- * Frees the memory occupied by a 'NhmCurrentFailedApp' object.
- * Can be used in 'g_slist_free_full' to free list of current failed apps.
- *
- */
-static void
-nhm_main_free_current_failed_app(gpointer failed_app)
-{
-  g_free(((NhmCurrentFailedApp*) failed_app)->name);
-  g_free(failed_app);
-}
-
-
 /**
  * nhm_main_free_failed_app:
  * @failed_app: Pointer to 'NhmFailedApp' object.
  *
- * Frees the memory occupied by a 'NhmFailedApp' object.
- * Can be used in 'g_slist_free_full' to free the list of failed apps.
+ * Frees the memory occupied by a 'NhmFailedApp' object and its name. It is
+ * used as 'value destroy func' for the failed apps. of a LC.
  */
 static void
 nhm_main_free_failed_app(gpointer failed_app)
 {
   g_free(((NhmFailedApp*) failed_app)->name);
-  g_free(failed_app);
+  g_slice_free(NhmFailedApp, failed_app);
 }
 
 
@@ -358,9 +983,152 @@ nhm_main_free_failed_app(gpointer failed_app)
 static void
 nhm_main_free_lc_info(gpointer lcinfo)
 {
-  g_slist_free_full(((NhmLcInfo*) lcinfo)->failed_apps,
-                    &nhm_main_free_failed_app);
-  g_free(lcinfo);
+  NhmLcInfo *lc_info = (NhmLcInfo*) lcinfo;
+
+  if(lc_info->failed_apps != NULL)
+  {
+    g_hash_table_unref(lc_info->failed_apps);
+  }
+
+  if(lc_info->map != NULL)
+  {
+    g_mapped_file_unref(lc_info->map);
+  }
+
+  g_slice_free(NhmLcInfo, lc_info);
+}
+
+
+/**
+ * nhm_main_new_lc_info:
+ * @start_state: State which was found in flag file, when the LC started.
+ *
+ * Creates a new LC without failed apps.
+ *
+ * Return value: Pointer to the new LC. Free it with 'nhm_main_free_lc_info'.
+ */
+static NhmLcInfo*
+nhm_main_new_lc_info(NhmNodeState start_state)
+{
+  NhmLcInfo *lcinfo = g_slice_new0(NhmLcInfo);
+
+  lcinfo->start_state = start_state;
+  lcinfo->failed_apps = g_hash_table_new_full(&g_str_hash,
+                                              &g_str_equal,
+                                              NULL,
+                                              &nhm_main_free_failed_app);
+  return lcinfo;
+}
+
+
+/**
+ * nhm_main_new_mapped_lc_info:
+ * @start_state: State which was found in flag file, when the LC started.
+ * @map:         Mapped LC data file, which contains the LC.
+ * @index:       Index entry of the LC in @map. Has to be checked by the caller.
+ *
+ * Creates a LC that has been read from the LC data file. The failed apps. of
+ * the LC are not decoded, before they are accessed the first time (see
+ * 'nhm_main_get_failed_apps'). Until then, the LC keeps a reference on @map.
+ *
+ * Return value: Pointer to the new LC. Free it with 'nhm_main_free_lc_info'.
+ */
+static NhmLcInfo*
+nhm_main_new_mapped_lc_info(NhmNodeState          start_state,
+                            GMappedFile          *map,
+                            const NhmLcDataIndex *index)
+{
+  NhmLcInfo *lcinfo = g_slice_new0(NhmLcInfo);
+
+  lcinfo->start_state = start_state;
+  lcinfo->failed_apps = NULL;
+  lcinfo->map         = g_mapped_file_ref(map);
+  lcinfo->block       = g_mapped_file_get_contents(map) + index->block_offset;
+  lcinfo->block_size  = index->block_size;
+  lcinfo->app_count   = index->app_count;
+
+  return lcinfo;
+}
+
+
+/**
+ * nhm_main_get_failed_apps:
+ * @lcinfo: Pointer to the life cycle whose failed apps. are requested.
+ *
+ * Returns the table of failed apps. of the LC. If the LC has been read from
+ * the LC data file and is accessed the first time, its block is decoded and
+ * the reference on the mapped file is dropped. Invalid entries are skipped.
+ *
+ * Return value: Table of failed apps. of the LC. Owned by the LC.
+ */
+static GHashTable*
+nhm_main_get_failed_apps(NhmLcInfo *lcinfo)
+{
+  NhmLcDataApp  app_entry;
+  const gchar  *app_name = NULL;
+  NhmFailedApp *app      = NULL;
+  guint         app_idx  = 0;
+
+  if(lcinfo->failed_apps == NULL)
+  {
+    lcinfo->failed_apps = g_hash_table_new_full(&g_str_hash,
+                                                &g_str_equal,
+                                                NULL,
+                                                &nhm_main_free_failed_app);
+
+    for(app_idx = 0; app_idx < lcinfo->app_count; app_idx++)
+    {
+      memcpy(&app_entry,
+             lcinfo->block + (app_idx * sizeof(app_entry)),
+             sizeof(app_entry));
+
+      app_name = lcinfo->block + app_entry.name_offset;
+
+      /* The name has to be terminated within the block of the LC */
+      if(   (app_entry.name_offset < lcinfo->block_size)
+         && (memchr(app_name, '\0', lcinfo->block_size - app_entry.name_offset) != NULL))
+      {
+        app = g_slice_new(NhmFailedApp);
+        app->name      = g_strdup(app_name);
+        app->failcount = app_entry.failcount;
+        g_hash_table_replace(lcinfo->failed_apps, app->name, app);
+      }
+    }
+
+    g_mapped_file_unref(lcinfo->map);
+    lcinfo->map        = NULL;
+    lcinfo->block      = NULL;
+    lcinfo->block_size = 0;
+    lcinfo->app_count  = 0;
+  }
+
+  return lcinfo->failed_apps;
+}
+
+
+/**
+ * nhm_main_add_failed_app:
+ * @lcinfo:    Pointer to the life cycle to which the app. should be added.
+ * @appname:   Name of the app. that should be added.
+ * @failcount: Initial fail count of the app.
+ *
+ * Adds a failed app. to the table of failed apps. of the passed LC. The app.
+ * info owns a copy of the name.
+ *
+ * Return value: Ptr. to the app. info of the added app.
+ */
+static NhmFailedApp*
+nhm_main_add_failed_app(NhmLcInfo   *lcinfo,
+                        const gchar *appname,
+                        guint        failcount)
+{
+  NhmFailedApp *app = g_slice_new(NhmFailedApp);
+
+  app->name      = g_strdup(appname);
+  app->failcount = failcount;
+  g_hash_table_replace(nhm_main_get_failed_apps(lcinfo), app->name, app);
+
+  return app;
 }
 
 
@@ -369,7 +1137,7 @@ nhm_main_free_lc_info(gpointer lcinfo)
  * @lcinfo:  Pointer to the life cycle in which the app. should be searched.
  * @appname: Name of the app. that is searched for.
  *
- * The function searches in the failed app. list
+ * The function searches in the failed app. table
  * of the passed LC for an app. with the passed name.
  *
  * Return value: Ptr. to the app. info of searched app.
@@ -379,20 +1147,8 @@ static NhmFailedApp*
 nhm_main_find_failed_app(NhmLcInfo   *lcinfo,
                          const gchar *appname)
 {
-  GSList       *list = NULL;
-  NhmFailedApp *app  = NULL;
-
-  /* Loop through the list of failed apps. until app is found or list ends */
-  for(list = lcinfo->failed_apps;
-      (list != NULL) && (app == NULL);
-      list = g_slist_next(list))
-  {
-    /* App. found, if the app. name of the stored object equals passed name */
-    app =   (g_strcmp0(((NhmFailedApp*) list->data)->name, appname) == 0)
-          ? (NhmFailedApp*) list->data : NULL;
-  }
-
-  return app;
+  return (NhmFailedApp*) g_hash_table_lookup(nhm_main_get_failed_apps(lcinfo),
+                                             appname);
 }
 
 
@@ -400,27 +1156,15 @@ nhm_main_find_failed_app(NhmLcInfo   *lcinfo,
  * nhm_main_find_current_failed_app:
  * @appname: Name of the app. that is searched for.
  *
- * Searches in the currently failed app. list for an app. with the passed name.
+ * Searches in the currently failed apps. for an app. with the passed name.
  *
- * Return value: Pointer to the current failed app. info.
- * of the searched app. or %NULL if app. is not found.
+ * Return value: Name of the searched app. in the table of the current LC.
+ *               %NULL if app. is not found.
  */
-static NhmCurrentFailedApp*
+static const gchar*
 nhm_main_find_current_failed_app(const gchar *appname)
 {
-  GSList              *list = NULL;
-  NhmCurrentFailedApp *app  = NULL;
-
-  /* Loop through currently failed apps. until app is found or list ends */
-  for(list = current_failed_apps;
-      (list != NULL) && (app == NULL);
-      list = g_slist_next(list))
-  {
-    app =   (g_strcmp0(((NhmCurrentFailedApp*) list->data)->name, appname) == 0)
-          ? (NhmCurrentFailedApp*) list->data : NULL;
-  }
-
-  return app;
+  return (const gchar*) g_hash_table_lookup(current_failed_apps, appname);
 }
 
 
@@ -496,53 +1240,340 @@ nhm_main_request_restart(NsmRestartReason_e restart_reason,
 
 
 /**
- * nhm_main_check_failed_app_restart:
+ * nhm_main_free_nsm_call:
+ * @nsm_call: Pointer to 'NhmNsmCall' object.
  *
- * The function is called from 'nhm_main_register_app_status_cb' whenever
- * an application failed. It determines the number of failed applications
- * in the current LC. If the number is higher than the configured value,
- * the function requests a node restart at the NSM.
+ * Frees the memory occupied by a 'NhmNsmCall' object.
+ * Used for finished calls and for calls that are still queued at shutdown.
  */
 static void
-nhm_main_check_failed_app_restart(void)
+nhm_main_free_nsm_call(gpointer nsm_call)
 {
-  guint failed_app_cnt = 0;
+  g_free(((NhmNsmCall*) nsm_call)->name);
+  g_slice_free(NhmNsmCall, nsm_call);
+}
 
-  /* If the failed app. observation is active */
-  if(max_failed_apps != 0)
-  {
-    /* Get the amount of currently failed apps. and compare to the max. value */
-    failed_app_cnt =   (current_failed_apps != NULL)
-                     ? g_slist_length(current_failed_apps) : 0;
 
-    if(failed_app_cnt >= max_failed_apps)
-    {
-      /* The amount of failed applications is too high. Request a node restart. */
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_INFO,
-              DLT_STRING("NHM: Amount of failed apps too high.");
-              DLT_STRING("FailCount:"); DLT_UINT(failed_app_cnt);
-              DLT_STRING("Limit:"    ); DLT_UINT(max_failed_apps));
+/**
+ * nhm_main_queue_nsm_call:
+ * @name:    Name of the app., whose status should be forwarded to the NSM.
+ * @running: %TRUE if the app. is running. %FALSE if it failed.
+ *
+ * The function is called from 'nhm_main_register_app_status' to forward an
+ * app. status to the NSM. Instead of blocking the main loop until the NSM
+ * answered, the status is queued and sent asynchronously, so that a burst of
+ * failing apps. is forwarded in parallel.
+ */
+static void
+nhm_main_queue_nsm_call(const gchar *name,
+                        gboolean     running)
+{
+  NhmNsmCall *nsm_call = NULL;
 
-      (void) nhm_main_request_restart(NsmRestartReason_ApplicationFailure,
-                                      NSM_SHUTDOWNTYPE_NORMAL);
-    }
+  /* The queue is created with the first call */
+  if(nsm_call_queue == NULL)
+  {
+    nsm_call_queue  = g_queue_new();
+    nsm_call_apps   = g_hash_table_new(&g_str_hash, &g_str_equal);
+    nsm_call_cancel = g_cancellable_new();
   }
+
+  nsm_call             = g_slice_new(NhmNsmCall);
+  nsm_call->name       = g_strdup(name);
+  nsm_call->running    = running;
+  nsm_call->queue_time = g_get_monotonic_time();
+  nsm_call->send_time  = 0;
+
+  g_queue_push_tail(nsm_call_queue, nsm_call);
+
+  nsm_call_stats.max_queued = MAX(nsm_call_stats.max_queued,
+                                  g_queue_get_length(nsm_call_queue));
+
+  nhm_main_send_nsm_calls();
 }
 
 
 /**
- * nhm_main_read_statistics_cb:
- * @object:     Pointer to NhmDbusInfo object
- * @invocation: Pointer to D-Bus invocation of this call
- * @app_name:   This will be the name of the application for which the calling
- *              application wants to know the failure count for. If this value
- *              is an empty string the NHM will return the failure statistics
- *              for the whole node.
- * @user_data:  Pointer to optional user data
- *
- * This function is called from dbus to read the failure count of either a
- * particular app. or of the node itself. Returns the following values on dbus:
+ * nhm_main_send_nsm_calls:
+ *
+ * Sends queued app. states to the NSM, until the configured amount of
+ * pending calls is reached. States of one app. are sent in the order in
+ * which they were registered. A state is only sent, if there is no pending
+ * call for the same app. States of other apps. can overtake it.
+ */
+static void
+nhm_main_send_nsm_calls(void)
+{
+  GList      *link     = NULL;
+  NhmNsmCall *nsm_call = NULL;
+  gboolean    sendable = TRUE;
+
+  while(   (sendable == TRUE) && (nsm_call_queue != NULL)
+        && ((max_nsm_calls == 0) || (nsm_calls_pending < max_nsm_calls)))
+  {
+    /* Search oldest state of an app. that has no pending call */
+    link = g_queue_peek_head_link(nsm_call_queue);
+
+    while(   (link != NULL)
+          && (g_hash_table_lookup(nsm_call_apps,
+                                  ((NhmNsmCall*) link->data)->name) != NULL))
+    {
+      link = g_list_next(link);
+    }
+
+    /* Stop if queue is empty or all queued apps. have a pending call */
+    sendable = (link != NULL);
+
+    if(sendable == TRUE)
+    {
+      nsm_call = (NhmNsmCall*) link->data;
+      g_queue_delete_link(nsm_call_queue, link);
+      g_hash_table_insert(nsm_call_apps, nsm_call->name, nsm_call);
+      nsm_calls_pending++;
+
+      nsm_call->send_time      = g_get_monotonic_time();
+      nsm_call_stats.sent     += 1;
+      nsm_call_stats.sum_wait += nsm_call->send_time - nsm_call->queue_time;
+
+      nsm_dbus_lc_control_call_set_app_health_status(dbus_lc_control_obj,
+                                                     nsm_call->name,
+                                                     nsm_call->running,
+                                                     nsm_call_cancel,
+                                                     &nhm_main_nsm_call_finished_cb,
+                                                     nsm_call);
+    }
+  }
+}
+
+
+/**
+ * nhm_main_nsm_call_finished_cb:
+ * @source_object: The 'NsmDbusLcControl' proxy, on which the call was made.
+ * @res:           Result of the asynchronous call.
+ * @user_data:     The 'NhmNsmCall', which has been finished.
+ *
+ * Called when the NSM answered a 'SetAppHealthStatus' call or the call failed.
+ * The accounting is updated and the next queued app. states are sent.
+ */
+static void
+nhm_main_nsm_call_finished_cb(GObject      *source_object,
+                              GAsyncResult *res,
+                              gpointer      user_data)
+{
+  NhmNsmCall       *nsm_call = (NhmNsmCall*) user_data;
+  GError           *error    = NULL;
+  NsmErrorStatus_e  nsm_rval = NsmErrorStatus_NotSet;
+  gint64            rtt      = 0;
+  guint             answered = 0;
+
+  (void) nsm_dbus_lc_control_call_set_app_health_status_finish((NsmDbusLcControl*) source_object,
+                                                                (gint*) &nsm_rval,
+                                                                res,
+                                                                &error);
+
+  if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE)
+  {
+    rtt = g_get_monotonic_time() - nsm_call->send_time;
+
+    if(error == NULL)
+    {
+      nsm_call_stats.sum_rtt += rtt;
+      nsm_call_stats.max_rtt  = MAX(nsm_call_stats.max_rtt, rtt);
+    }
+    else
+    {
+      if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT) == TRUE)
+      {
+        nsm_call_stats.timed_out++;
+      }
+      else
+      {
+        nsm_call_stats.failed++;
+      }
+
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_ERROR,
+              DLT_STRING("NHM: Failed to forward app. status to NSM.");
+              DLT_STRING("Error: D-Bus communication to NSM failed.");
+              DLT_STRING("AppName:"); DLT_STRING(nsm_call->name);
+              DLT_STRING("Time ms:"); DLT_UINT((guint) (rtt / 1000));
+              DLT_STRING("Reason:");  DLT_STRING(error->message));
+    }
+
+    /* Release the app., so that its next state can be sent */
+    g_hash_table_remove(nsm_call_apps, nsm_call->name);
+    nsm_calls_pending--;
+    nhm_main_send_nsm_calls();
+
+    /* Trace accounting, when all queued app. states have been forwarded */
+    if((nsm_calls_pending == 0) && (g_queue_is_empty(nsm_call_queue) == TRUE))
+    {
+      answered =   nsm_call_stats.sent
+                 - nsm_call_stats.failed
+                 - nsm_call_stats.timed_out;
+
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_INFO,
+              DLT_STRING("NHM: Forwarded queued app. states to NSM.");
+              DLT_STRING("Sent:");       DLT_UINT(nsm_call_stats.sent);
+              DLT_STRING("Failed:");     DLT_UINT(nsm_call_stats.failed);
+              DLT_STRING("Timed out:");  DLT_UINT(nsm_call_stats.timed_out);
+              DLT_STRING("Max queued:"); DLT_UINT(nsm_call_stats.max_queued);
+              DLT_STRING("Avg. wait ms:");
+              DLT_UINT((guint) (nsm_call_stats.sum_wait / nsm_call_stats.sent / 1000));
+              DLT_STRING("Avg. RTT ms:");
+              DLT_UINT((guint) (nsm_call_stats.sum_rtt / MAX(answered, 1) / 1000));
+              DLT_STRING("Max. RTT ms:");
+              DLT_UINT((guint) (nsm_call_stats.max_rtt / 1000)));
+    }
+
+    nhm_main_free_nsm_call(nsm_call);
+  }
+
+  /* A cancelled call already has been freed, when the NHM shut down */
+  if(error != NULL)
+  {
+    g_error_free(error);
+  }
+}
+
+
+/**
+ * nhm_main_check_failed_app_restart:
+ *
+ * The function is called from 'nhm_main_register_app_status_cb' whenever
+ * an application failed. It determines the number of failed applications
+ * in the current LC. If the number is higher than the configured value,
+ * the function requests a node restart at the NSM.
+ */
+static void
+nhm_main_check_failed_app_restart(void)
+{
+  guint failed_app_cnt = 0;
+
+  /* If the failed app. observation is active */
+  if(max_failed_apps != 0)
+  {
+    /* Get the amount of currently failed apps. and compare to the max. value */
+    failed_app_cnt = g_hash_table_size(current_failed_apps);
+
+    if(failed_app_cnt >= max_failed_apps)
+    {
+      /* The amount of failed applications is too high. Request a node restart. */
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_INFO,
+              DLT_STRING("NHM: Amount of failed apps too high.");
+              DLT_STRING("FailCount:"); DLT_UINT(failed_app_cnt);
+              DLT_STRING("Limit:"    ); DLT_UINT(max_failed_apps));
+
+      (void) nhm_main_request_restart(NsmRestartReason_ApplicationFailure,
+                                      NSM_SHUTDOWNTYPE_NORMAL);
+    }
+  }
+}
+
+
+/**
+ * nhm_main_update_lc_stats:
+ *
+ * The function calculates the statistics over the current LC and up to
+ * 'max_lc_count' previous LCs, if they are not calculated yet or the number
+ * of LCs in this window changed. Afterwards, the statistics are updated with
+ * every failure (see 'nhm_main_count_app_failure'). The previous LCs are
+ * decoded for the calculation.
+ */
+static void
+nhm_main_update_lc_stats(void)
+{
+  guint           lc_count  = MIN(nodeinfo->len, max_lc_count + 1);
+  guint           lc_idx    = 0;
+  NhmLcInfo      *lc_info   = NULL;
+  GHashTableIter  app_iter;
+  NhmFailedApp   *app_info  = NULL;
+  guint           app_total = 0;
+
+  if((lc_stats.app_totals == NULL) || (lc_stats.lc_count != lc_count))
+  {
+    nhm_main_reset_lc_stats();
+
+    lc_stats.app_totals = g_hash_table_new(&g_str_hash, &g_str_equal);
+    lc_stats.lc_count   = lc_count;
+
+    for(lc_idx = 0; lc_idx < lc_count; lc_idx++)
+    {
+      lc_info = (NhmLcInfo*) g_ptr_array_index(nodeinfo, lc_idx);
+
+      lc_stats.failed_shutdowns +=
+        (lc_info->start_state != NHM_NODESTATE_SHUTDOWN) ? 1 : 0;
+
+      g_hash_table_iter_init(&app_iter, nhm_main_get_failed_apps(lc_info));
+      while(g_hash_table_iter_next(&app_iter, NULL, (gpointer*) &app_info) == TRUE)
+      {
+        app_total = GPOINTER_TO_UINT(g_hash_table_lookup(lc_stats.app_totals,
+                                                         app_info->name));
+        g_hash_table_insert(lc_stats.app_totals,
+                            (gpointer) app_info->name,
+                            GUINT_TO_POINTER(app_total + app_info->failcount));
+      }
+    }
+  }
+}
+
+
+/**
+ * nhm_main_reset_lc_stats:
+ *
+ * The function drops the statistics. They will be calculated again, when
+ * they are requested the next time. Called when the window of LCs changed.
+ */
+static void
+nhm_main_reset_lc_stats(void)
+{
+  if(lc_stats.app_totals != NULL)
+  {
+    g_hash_table_unref(lc_stats.app_totals);
+  }
+
+  lc_stats.app_totals       = NULL;
+  lc_stats.lc_count         = 0;
+  lc_stats.failed_shutdowns = 0;
+}
+
+
+/**
+ * nhm_main_count_app_failure:
+ * @name: Name of the app. in the table of the current LC, whose fail count
+ *        has been increased.
+ *
+ * The function updates the statistics, when an app. failed in the current LC.
+ */
+static void
+nhm_main_count_app_failure(const gchar *name)
+{
+  guint app_total = 0;
+
+  if(lc_stats.app_totals != NULL)
+  {
+    app_total = GPOINTER_TO_UINT(g_hash_table_lookup(lc_stats.app_totals, name));
+    g_hash_table_insert(lc_stats.app_totals,
+                        (gpointer) name,
+                        GUINT_TO_POINTER(app_total + 1));
+  }
+}
+
+
+/**
+ * nhm_main_read_statistics_cb:
+ * @object:     Pointer to NhmDbusInfo object
+ * @invocation: Pointer to D-Bus invocation of this call
+ * @app_name:   This will be the name of the application for which the calling
+ *              application wants to know the failure count for. If this value
+ *              is an empty string the NHM will return the failure statistics
+ *              for the whole node.
+ * @user_data:  Pointer to optional user data
+ *
+ * This function is called from dbus to read the failure count of either a
+ * particular app. or of the node itself. Returns the following values on dbus:
  *
  * CurrentFailCount: If there is an app. name:
  *                   How many times the app has failed in the current lifecycle
@@ -564,25 +1595,19 @@ nhm_main_read_statistics_cb(NhmDbusInfo           *object,
                             const gchar           *app_name,
                             gpointer               user_data)
 {
-  guint         lc_idx           = 0;
   NhmLcInfo    *lc_info          = NULL;
   NhmFailedApp *app_info         = NULL;
   guint         current_fail_cnt = 0;
   guint         total_failures   = 0;
 
+  nhm_main_update_lc_stats();
+
   /* Check if the node statistics should be retrieved (empty AppName) */
   if(strlen(app_name) == 0)
   {
-    /* Node statistics requested. Store number of currently failed apps. */
-    current_fail_cnt =   (current_failed_apps != NULL)
-                       ? g_slist_length(current_failed_apps) : 0;
-
-    /* Loop through all life cycles and sum up failed shut downs */
-    for(lc_idx = 0; (lc_idx < nodeinfo->len) && (lc_idx <= max_lc_count); lc_idx++)
-    {
-      lc_info         = (NhmLcInfo*) g_ptr_array_index(nodeinfo, lc_idx);
-      total_failures += (lc_info->start_state != NHM_NODESTATE_SHUTDOWN) ? 1 : 0;
-    }
+    /* Node statistics requested. Number of currently failed apps. */
+    current_fail_cnt = g_hash_table_size(current_failed_apps);
+    total_failures   = lc_stats.failed_shutdowns;
   }
   else
   {
@@ -591,14 +1616,9 @@ nhm_main_read_statistics_cb(NhmDbusInfo           *object,
     app_info = nhm_main_find_failed_app(lc_info, app_name);
     current_fail_cnt = (app_info != NULL) ? app_info->failcount : 0;
 
-    /* Init. total fail cnt with current fail cnt. Add fail cnt of previous LCs */
-    total_failures = current_fail_cnt;
-    for(lc_idx = 1; (lc_idx < nodeinfo->len) && (lc_idx <= max_lc_count); lc_idx++)
-    {
-      lc_info  = (NhmLcInfo*) g_ptr_array_index(nodeinfo, lc_idx);
-      app_info = nhm_main_find_failed_app(lc_info, app_name);
-      total_failures += (app_info != NULL) ? app_info->failcount : 0;
-    }
+    /* Fail count of current and previous LCs */
+    total_failures =
+      GPOINTER_TO_UINT(g_hash_table_lookup(lc_stats.app_totals, app_name));
   }
 
   /* Complete D-Bus call. Send return to D-Bus caller. */
@@ -606,40 +1626,196 @@ nhm_main_read_statistics_cb(NhmDbusInfo           *object,
                                          invocation,
                                          current_fail_cnt,
                                          total_failures,
-                                         lc_idx,
+                                         lc_stats.lc_count,
                                          (gint) NhmErrorStatus_Ok);
 
   return TRUE;
 }
 
 
+/**
+ * nhm_main_read_all_statistics_cb:
+ * @object:     Pointer to NhmDbusInfo object
+ * @invocation: Pointer to D-Bus invocation of this call
+ * @prefix:     Only apps., whose name starts with the prefix are returned.
+ *              If this value is an empty string, all apps. are returned.
+ * @user_data:  Pointer to optional user data
+ *
+ * This function is called from dbus to read the failure counts of all apps.
+ * that failed in the LCs used for the statistics. For every app., the same
+ * values as for 'ReadStatistics' are returned in a dictionary ("a{s(uuu)}").
+ * The dictionary is built in one pass over the statistics.
+ *
+ * Return value: Always %TRUE. Method has been processed.
+ */
+static gboolean
+nhm_main_read_all_statistics_cb(NhmDbusInfo           *object,
+                                GDBusMethodInvocation *invocation,
+                                const gchar           *prefix,
+                                gpointer               user_data)
+{
+  GVariantBuilder  builder;
+  GHashTableIter   app_iter;
+  const gchar     *app_name  = NULL;
+  gpointer         app_total = NULL;
+  NhmLcInfo       *lc_info   = NULL;
+  NhmFailedApp    *app_info  = NULL;
+
+  nhm_main_update_lc_stats();
+
+  lc_info = (NhmLcInfo*) g_ptr_array_index(nodeinfo, 0);
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a{s(uuu)}"));
+
+  /* Every app. that failed in the LCs of the statistics has a total */
+  g_hash_table_iter_init(&app_iter, lc_stats.app_totals);
+  while(g_hash_table_iter_next(&app_iter, (gpointer*) &app_name, &app_total) == TRUE)
+  {
+    if(g_str_has_prefix(app_name, prefix) == TRUE)
+    {
+      app_info = nhm_main_find_failed_app(lc_info, app_name);
+
+      g_variant_builder_add(&builder,
+                            "{s(uuu)}",
+                            app_name,
+                            (app_info != NULL) ? app_info->failcount : 0,
+                            GPOINTER_TO_UINT(app_total),
+                            lc_stats.lc_count);
+    }
+  }
+
+  /* Complete D-Bus call. Send return to D-Bus caller. */
+  nhm_dbus_info_complete_read_all_statistics(object,
+                                             invocation,
+                                             g_variant_builder_end(&builder),
+                                             (gint) NhmErrorStatus_Ok);
+
+  return TRUE;
+}
+
 
 /**
- * nhm_main_register_app_status:
+ * nhm_main_get_health_report_cb:
+ * @object:     Pointer to NhmDbusInfo object
+ * @invocation: Pointer to D-Bus invocation of this call
+ * @user_data:  Pointer to optional user data
+ *
+ * This function is called from dbus to get a report of the health of the
+ * node. All userland checks are evaluated at once by a sweep in the check
+ * context (see 'nhm_main_build_health_report' for the format of the report).
+ * The call is completed, when the report has been posted to the main loop.
+ * Calls that arrive while a sweep is pending share its report. If the
+ * userland checks are disabled or the check worker has not been started yet,
+ * an empty report is returned immediately.
+ *
+ * Return value: Always %TRUE. Method will be processed asynchronously.
+ */
+static gboolean
+nhm_main_get_health_report_cb(NhmDbusInfo           *object,
+                              GDBusMethodInvocation *invocation,
+                              gpointer               user_data)
+{
+  /* Without running check worker, there are no checks to sweep */
+  if((ul_chk_interval != 0) && (check_context != NULL))
+  {
+    if(sweep_invocations == NULL)
+    {
+      sweep_invocations = g_queue_new();
+    }
+
+    g_queue_push_tail(sweep_invocations, invocation);
+
+    /* Only the first waiting call starts a sweep */
+    if(g_queue_get_length(sweep_invocations) == 1)
+    {
+      g_main_context_invoke(check_context, &nhm_main_start_sweep_cb, NULL);
+    }
+  }
+  else
+  {
+    nhm_dbus_info_complete_get_health_report(object,
+                                             invocation,
+                                             nhm_main_build_health_report());
+  }
+
+  return TRUE;
+}
+
+
+/**
+ * nhm_main_read_check_intervals_cb:
+ * @object:     Pointer to NhmDbusInfo object
+ * @invocation: Pointer to D-Bus invocation of this call
+ * @user_data:  Pointer to optional user data
+ *
+ * This function is called from dbus to read the effective intervals of the
+ * userland checks. The intervals grow while the node is healthy and fall
+ * back to the configured ones, when it degrades. They are returned in a
+ * dictionary ("a{su}") of check names and intervals in s.
+ *
+ * Return value: Always %TRUE. Method has been processed.
+ */
+static gboolean
+nhm_main_read_check_intervals_cb(NhmDbusInfo           *object,
+                                 GDBusMethodInvocation *invocation,
+                                 gpointer               user_data)
+{
+  GVariantBuilder  builder;
+  GHashTableIter   check_iter;
+  const gchar     *check_name     = NULL;
+  gpointer         check_interval = NULL;
+
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a{su}"));
+
+  if(check_intervals != NULL)
+  {
+    g_hash_table_iter_init(&check_iter, check_intervals);
+    while(g_hash_table_iter_next(&check_iter,
+                                 (gpointer*) &check_name,
+                                 &check_interval) == TRUE)
+    {
+      g_variant_builder_add(&builder,
+                            "{su}",
+                            check_name,
+                            GPOINTER_TO_UINT(check_interval));
+    }
+  }
+
+  /* Complete D-Bus call. Send return to D-Bus caller. */
+  nhm_dbus_info_complete_read_check_intervals(object,
+                                              invocation,
+                                              g_variant_builder_end(&builder));
+
+  return TRUE;
+}
+
+
+/**
+ * nhm_main_apply_app_status:
  * @name:    This is the unit name of the application that has failed
  * @status:  This can be used to specify the status of the application that has failed.
  *           It will be based upon the enum NHM_ApplicationStatus_e.
  *
- * The function is called via the dbus interface or from the systemd
- * observation when either a NHM client wants to register a failed app.
- * or the state of a systemd unit changed. The NHM will maintain an internal
- * list of the applications that are currently in a failed state.
- * Additionally it will maintain a count of the currently failed applications
- * that can be used to trigger a system restart if the value gets too high.
- * The NHM will also call the NSM method SetAppHealthStatus which will allow
- * the NSM to disable any sessions that might have been enabled by the failed
- * application and send out the signal 'AppHealthStatus'.
+ * The function applies a new app. status to the internal data of the NHM.
+ * The NHM will maintain an internal list of the applications that are
+ * currently in a failed state. Additionally it will maintain a count of the
+ * currently failed applications that can be used to trigger a system restart
+ * if the value gets too high. The NHM will also queue a call of the NSM method
+ * SetAppHealthStatus, which will allow the NSM to disable any sessions that
+ * might have been enabled by the failed application.
+ * The caller is responsible to emit the signal, to store the data and to
+ * check if the amount of failed apps. is too high.
+ *
+ * Return value: %TRUE if the app. newly failed and its fail count increased.
  */
-static void
-nhm_main_register_app_status(const gchar    *name,
-                             NhmAppStatus_e  status)
+static gboolean
+nhm_main_apply_app_status(const gchar    *name,
+                          NhmAppStatus_e  status)
 {
-  GError              *error          = NULL;
-  NsmErrorStatus_e     nsm_rval       = NsmErrorStatus_NotSet;
   NhmLcInfo           *lc_info        = NULL;
   NhmFailedApp        *app_info       = NULL;
-  NhmCurrentFailedApp *app_on_list    = NULL;
+  const gchar         *app_on_list    = NULL;
   gboolean             app_running    = FALSE;
+  gboolean             app_failed     = FALSE;
 
   DLT_LOG(nhm_helper_trace_ctx,
           DLT_LOG_INFO,
@@ -649,35 +1825,13 @@ nhm_main_register_app_status(const gchar    *name,
 
   /* Forward the call to the NSM who will process it for its own purposes. */
   app_running = (status == NhmAppStatus_Ok);
-  (void) nsm_dbus_lc_control_call_set_app_health_status_sync(dbus_lc_control_obj,
-                                                             name,
-                                                             app_running,
-                                                             (gint*) &nsm_rval,
-                                                             NULL,
-                                                             &error);
-  if(error != NULL) /* Check for D-Bus errors */
-  {
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_ERROR,
-            DLT_STRING("NHM: Failed to forward app. status to NSM.");
-            DLT_STRING("Error: D-Bus communication to NSM failed.");
-            DLT_STRING("Reason:"); DLT_STRING(error->message));
-    g_error_free(error);
-  }
-
-  /* Transparently emit 'AppStatus' signal */
-  nhm_dbus_info_emit_app_health_status(dbus_nhm_info_obj, name, status);
+  nhm_main_queue_nsm_call(name, app_running);
 
   /* Start internal processing. Check if app. is on current failed list. */
   app_on_list = nhm_main_find_current_failed_app(name);
 
   if((app_on_list == NULL) && (status == NhmAppStatus_Failed))
   {
-    /* App. not on list and the new status is failed. Add it to the list! */
-    app_on_list         = g_new(NhmCurrentFailedApp, 1);
-    app_on_list->name   = g_strdup(name);
-    current_failed_apps = g_slist_append(current_failed_apps, app_on_list);
-
     /* Try to get the app. in the list of failed apps. of the current LC */
     lc_info  = (NhmLcInfo*) g_ptr_array_index(nodeinfo, 0);
     app_info = nhm_main_find_failed_app(lc_info, name);
@@ -685,32 +1839,84 @@ nhm_main_register_app_status(const gchar    *name,
     if(app_info == NULL)
     {
       /* Failed app has not been on list. Init. error count with 1 and add it */
-      app_info             = g_new(NhmFailedApp, 1);
-      app_info->name       = g_strdup(name);
-      app_info->failcount  = 0;
-      lc_info->failed_apps = g_slist_append(lc_info->failed_apps, app_info);
+      app_info = nhm_main_add_failed_app(lc_info, name, 0);
     }
 
+    /* App. not on list and the new status is failed. Add it with LC's name. */
+    g_hash_table_insert(current_failed_apps, app_info->name, app_info->name);
+
     app_info->failcount++; /* increase fail count (either of old or new app.) */
+    app_failed = TRUE;
+
+    nhm_main_count_app_failure(app_info->name);
+
+    /* Remember the app., to store its new fail count */
+    if(lc_data_dirty_apps == NULL)
+    {
+      lc_data_dirty_apps = g_hash_table_new(&g_str_hash, &g_str_equal);
+    }
+
+    g_hash_table_insert(lc_data_dirty_apps,
+                        (gpointer) app_info->name,
+                        (gpointer) app_info->name);
 
     DLT_LOG(nhm_helper_trace_ctx,
             DLT_LOG_INFO,
             DLT_STRING("NHM: Updated error count for application.");
             DLT_STRING("AppName:");    DLT_STRING(app_info->name);
             DLT_STRING("Fail count:"); DLT_UINT(app_info->failcount));
-
-    nhm_main_write_data();
-    nhm_main_check_failed_app_restart();
   }
   else
   {
     /* The app is on the list, but not failed anymore. Remove it! */
     if((app_on_list != NULL) && (status != NhmAppStatus_Failed))
     {
-      nhm_main_free_current_failed_app(app_on_list);
-      current_failed_apps = g_slist_remove(current_failed_apps, app_on_list);
+      g_hash_table_remove(current_failed_apps, app_on_list);
     }
   }
+
+  /* Let the userland checks fall back to their fast cadence */
+  g_atomic_int_set(&check_apps_failed,
+                   (gint) g_hash_table_size(current_failed_apps));
+
+  if(app_failed == TRUE)
+  {
+    g_atomic_int_inc(&check_failures);
+  }
+
+  return app_failed;
+}
+
+
+/**
+ * nhm_main_register_app_status:
+ * @name:    This is the unit name of the application that has failed
+ * @status:  This can be used to specify the status of the application that
+ *           has failed. It will be based upon the enum NHM_ApplicationStatus_e.
+ *
+ * The function is called via the dbus interface or from the systemd
+ * observation when either a NHM client wants to register a failed app.
+ * or the state of a systemd unit changed. The status is applied (see
+ * 'nhm_main_apply_app_status') and the signal 'AppHealthStatus' is sent.
+ * If the app. failed, the data is marked to be stored and the amount of
+ * failed apps. is checked.
+ */
+static void
+nhm_main_register_app_status(const gchar    *name,
+                             NhmAppStatus_e  status)
+{
+  gboolean app_failed = FALSE;
+
+  app_failed = nhm_main_apply_app_status(name, status);
+
+  /* Transparently emit 'AppStatus' signal */
+  nhm_dbus_info_emit_app_health_status(dbus_nhm_info_obj, name, status);
+
+  if(app_failed == TRUE)
+  {
+    nhm_main_mark_data_dirty();
+    nhm_main_check_failed_app_restart();
+  }
 }
 
 
@@ -744,6 +1950,63 @@ nhm_main_register_app_status_cb(NhmDbusInfo           *object,
 }
 
 
+/**
+ * nhm_main_register_batch_cb:
+ * @object:          Pointer to NhmDbusInfo object
+ * @invocation:      Pointer to D-Bus invocation of this call
+ * @app_status_list: Array of app. names and their status ("a(si)").
+ * @user_data:       Pointer to optional user data
+ *
+ * This function is called from dbus when a NHM client wants to register
+ * the status of multiple applications at once. The entries are applied in
+ * the order of the list. The data is marked to be stored and the amount of
+ * failed apps. is checked once for the whole list. One 'AppHealthStatusBatch'
+ * signal is sent for the list.
+ *
+ * Return value: Always %TRUE. Method has been processed.
+ */
+static gboolean
+nhm_main_register_batch_cb(NhmDbusInfo           *object,
+                           GDBusMethodInvocation *invocation,
+                           GVariant              *app_status_list,
+                           gpointer               user_data)
+{
+  GVariantIter  iter;
+  const gchar  *app_name    = NULL;
+  gint          app_status  = 0;
+  guint         failed_apps = 0;
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_INFO,
+          DLT_STRING("NHM: Processing 'RegisterAppStatusBatch' call");
+          DLT_STRING("Entries:");
+          DLT_UINT((guint) g_variant_n_children(app_status_list)));
+
+  (void) g_variant_iter_init(&iter, app_status_list);
+
+  while(g_variant_iter_next(&iter, "(&si)", &app_name, &app_status) == TRUE)
+  {
+    failed_apps += (nhm_main_apply_app_status(app_name,
+                                              (NhmAppStatus_e) app_status)
+                    == TRUE) ? 1 : 0;
+  }
+
+  /* Transparently emit one signal for the whole batch */
+  nhm_dbus_info_emit_app_health_status_batch(dbus_nhm_info_obj,
+                                             app_status_list);
+
+  if(failed_apps != 0)
+  {
+    nhm_main_mark_data_dirty();
+    nhm_main_check_failed_app_restart();
+  }
+
+  nhm_dbus_info_complete_register_app_status_batch(object, invocation);
+
+  return TRUE;
+}
+
+
 /**
  * nhm_main_request_node_restart_cb:
  * @object:     Pointer to NhmDbusInfo object
@@ -815,193 +2078,300 @@ nhm_does_file_exist(gchar* file_name)
 
 
 /**
- * nhm_main_is_process_running:
- * @process: Full path to the executable of the process
- *
- * The function checks if a process is running (process info in '/proc').
+ * nhm_main_bitmap_get:
+ * @bitmap: Bitmap
+ * @idx:    Index of the bit
  *
- * Return value: %TRUE, if process is currently running,
- *               otherwise %FALSE;
+ * Return value: Value of the bit.
  */
 static gboolean
-nhm_main_is_process_running(gchar* prog)
+nhm_main_bitmap_get(const guint8 *bitmap,
+                    guint         idx)
 {
-  GDir        *root_dir   = NULL;
-  const gchar *proc_dir   = NULL;
-  gchar       *exe_link   = NULL;
-  gchar       *prog_name  = NULL;
-  gboolean     found_prog = FALSE;
-  GError      *error      = NULL;
+  return (bitmap[idx / 8] & (1 << (idx % 8))) != 0;
+}
 
-  /* Open 'proc' directory in rootfs */
-  root_dir = g_dir_open("/proc/", 0, &error);
 
-  if(error == NULL)
+/**
+ * nhm_main_bitmap_set:
+ * @bitmap: Bitmap
+ * @idx:    Index of the bit
+ * @value:  New value of the bit
+ */
+static void
+nhm_main_bitmap_set(guint8   *bitmap,
+                    guint     idx,
+                    gboolean  value)
+{
+  if(value == TRUE)
   {
-    /* Proc directory opened. Check every file/folder inside */
-    for(proc_dir = g_dir_read_name(root_dir);
-        (proc_dir != NULL) && (found_prog == FALSE);
-        proc_dir = g_dir_read_name(root_dir))
+    bitmap[idx / 8] |= (guint8) (1 << (idx % 8));
+  }
+  else
+  {
+    bitmap[idx / 8] &= (guint8) ~(1 << (idx % 8));
+  }
+}
+
+
+/**
+ * nhm_main_free_watched_dir:
+ * @watched_dir: Pointer to 'NhmWatchedDir' object.
+ *
+ * Stops watching the directory and frees the memory occupied by the object.
+ * It is used as 'value destroy func' for the table 'watched_dirs'.
+ */
+static void
+nhm_main_free_watched_dir(gpointer watched_dir)
+{
+  NhmWatchedDir *dir = (NhmWatchedDir*) watched_dir;
+
+  (void) g_file_monitor_cancel(dir->monitor);
+  g_object_unref(dir->monitor);
+  g_array_free(dir->files, TRUE);
+  g_slice_free(NhmWatchedDir, dir);
+}
+
+
+/**
+ * nhm_main_watch_files:
+ *
+ * The function watches the parent directories of the monitored files. The
+ * existence of the files is stored in a bitmap, which is kept up to date by
+ * 'nhm_main_file_changed_cb'. The userland check then only tests the bitmap.
+ * Files whose directory can not be watched are tested in every check.
+ */
+static void
+nhm_main_watch_files(void)
+{
+  guint          file_cnt = g_strv_length(monitored_files);
+  guint          file_idx = 0;
+  gchar         *dir_path = NULL;
+  GFile         *dir_file = NULL;
+  GFileMonitor  *monitor  = NULL;
+  NhmWatchedDir *dir      = NULL;
+  GError        *error    = NULL;
+
+  watched_dirs  = g_hash_table_new_full(&g_str_hash,
+                                        &g_str_equal,
+                                        &g_free,
+                                        &nhm_main_free_watched_dir);
+  files_watched = g_new0(guint8, (file_cnt + 7) / 8);
+  files_exist   = g_new0(guint8, (file_cnt + 7) / 8);
+
+  for(file_idx = 0; file_idx < file_cnt; file_idx++)
+  {
+    dir_path = g_path_get_dirname(monitored_files[file_idx]);
+    dir      = (NhmWatchedDir*) g_hash_table_lookup(watched_dirs, dir_path);
+
+    if(dir == NULL)
     {
-      /* For every file/folder in 'proc' create path to exe link */
-      exe_link = g_strconcat("/proc/", proc_dir, "/exe", NULL);
+      dir_file = g_file_new_for_path(dir_path);
+      monitor  = g_file_monitor_directory(dir_file,
+                                          G_FILE_MONITOR_NONE,
+                                          NULL,
+                                          &error);
+      g_object_unref(dir_file);
 
-      /* Check if 'exe' link points to searched executable */
-      prog_name = g_file_read_link(exe_link, NULL);
-      if(prog_name != NULL)
+      if(error == NULL)
+      {
+        dir          = g_slice_new(NhmWatchedDir);
+        dir->monitor = monitor;
+        dir->files   = g_array_new(FALSE, FALSE, sizeof(guint));
+        (void) g_signal_connect(monitor,
+                                "changed",
+                                G_CALLBACK(nhm_main_file_changed_cb),
+                                dir);
+        g_hash_table_insert(watched_dirs, dir_path, dir);
+        dir_path = NULL;
+      }
+      else
       {
-        found_prog = (g_strcmp0(prog_name, prog) == 0);
-        g_free(prog_name);
+        DLT_LOG(nhm_helper_trace_ctx,
+                DLT_LOG_WARN,
+                DLT_STRING("NHM: Failed to watch monitored file.");
+                DLT_STRING("File name:"); DLT_STRING(monitored_files[file_idx]);
+                DLT_STRING("Reason:");    DLT_STRING(error->message));
+        g_error_free(error);
+        error = NULL;
       }
+    }
 
-      g_free(exe_link);
+    /* The file is tested after its directory is watched to not miss changes */
+    if(dir != NULL)
+    {
+      g_array_append_val(dir->files, file_idx);
+      nhm_main_bitmap_set(files_watched, file_idx, TRUE);
     }
 
-    g_dir_close(root_dir);
+    nhm_main_bitmap_set(files_exist,
+                        file_idx,
+                        nhm_does_file_exist(monitored_files[file_idx]));
+    g_free(dir_path);
   }
-  else
+}
+
+
+/**
+ * nhm_main_file_changed_cb:
+ * @monitor:    Monitor of the parent directory of monitored files.
+ * @file:       File that changed.
+ * @other_file: Not used.
+ * @event_type: Type of the change.
+ * @user_data:  Pointer to the 'NhmWatchedDir' of the directory.
+ *
+ * The function is called when a file in a watched directory or the directory
+ * itself changed. If files have been created, deleted or moved, the existence
+ * of the monitored files in the directory is updated in the bitmap. A deleted
+ * monitored file is reported immediately like a failed userland check.
+ */
+static void
+nhm_main_file_changed_cb(GFileMonitor      *monitor,
+                         GFile             *file,
+                         GFile             *other_file,
+                         GFileMonitorEvent  event_type,
+                         gpointer           user_data)
+{
+  NhmWatchedDir *dir      = (NhmWatchedDir*) user_data;
+  guint          idx      = 0;
+  guint          file_idx = 0;
+  gboolean       exists   = FALSE;
+
+  if(   (event_type == G_FILE_MONITOR_EVENT_CREATED)
+     || (event_type == G_FILE_MONITOR_EVENT_DELETED)
+     || (event_type == G_FILE_MONITOR_EVENT_MOVED)
+     || (event_type == G_FILE_MONITOR_EVENT_UNMOUNTED))
   {
-    /* 'proc' directory could not be opened. Return an error. */
-    found_prog = FALSE;
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_ERROR,
-            DLT_STRING("NHM: Program check failed. Proc folder not readable.");
-            DLT_STRING("Error: Proc folder not readable.");
-            DLT_STRING("Reason:"); DLT_STRING(error->message));
-    g_error_free(error);
-  }
+    for(idx = 0; idx < dir->files->len; idx++)
+    {
+      file_idx = g_array_index(dir->files, guint, idx);
+      exists   = nhm_does_file_exist(monitored_files[file_idx]);
 
-  return found_prog;
+      if(   (exists == FALSE)
+         && (nhm_main_bitmap_get(files_exist, file_idx) == TRUE))
+      {
+        nhm_main_post_check_result(NHM_CHECK_FILE,
+                                   monitored_files[file_idx],
+                                   "Reason: Monitored file does not exist.");
+      }
+
+      nhm_main_bitmap_set(files_exist, file_idx, exists);
+    }
+  }
 }
 
 
 /**
- * nhm_main_is_process_ok:
- * @process: Full path to the executable of the process
+ * nhm_main_is_file_present:
+ * @file_idx: Index of the file in 'monitored_files'.
  *
- * The function checks if a user defined process returns valid (0).
+ * Tests if a monitored file exists. For watched files, only the existence
+ * bitmap is tested.
  *
- * Return value: %TRUE, if process is returned with 0, otherwise %FALSE;
+ * Return value: If the file exists %TRUE, otherwise %FALSE.
  */
 static gboolean
-nhm_main_is_process_ok(gchar *process)
-{
-  gchar    *argv[]      = {process, NULL};
-  GError   *error       = NULL;
-  gint      proc_retval = 0;
-  gboolean  proc_ok     = FALSE;
-
-  /* Start the process.*/
-  (void) g_spawn_sync(NULL,
-                     argv,
-                     NULL,
-                     G_SPAWN_STDOUT_TO_DEV_NULL|G_SPAWN_STDERR_TO_DEV_NULL,
-                     NULL,
-                     NULL,
-                     NULL,
-                     NULL,
-                     &proc_retval,
-                     &error);
-
-  /* Check for errors of prg execution. */
-  if(error == NULL)
+nhm_main_is_file_present(guint file_idx)
+{
+  gboolean present = FALSE;
+
+  if(   (files_watched != NULL)
+     && (nhm_main_bitmap_get(files_watched, file_idx) == TRUE))
   {
-    /* Prog. executed. Check that return value is '0' */
-    proc_ok = (proc_retval == 0);
+    present = nhm_main_bitmap_get(files_exist, file_idx);
   }
   else
   {
-    /* Prog. execution failed. */
-    proc_ok = FALSE;
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_ERROR,
-            DLT_STRING("NHM: Process check failed.");
-            DLT_STRING("Error: Monitored process not started.");
-            DLT_STRING("Reason:"); DLT_STRING(error->message));
-    g_error_free(error);
+    present = nhm_does_file_exist(monitored_files[file_idx]);
   }
 
-  return proc_ok;
+  return present;
 }
 
 
 /**
- * nhm_main_is_dbus_alive:
- * @checked_dbus: Observed bus, created at startup.
+ * nhm_main_read_start_time:
+ * @pid:        Process ID as string.
+ * @start_time: Return value for the start time of the process.
  *
- * The function checks if a user defined dbus exists (bus address valid)
- * and if there is response when calling "Ping" on org.freedesktop.DBus.
+ * The function reads the start time of a process from '/proc/<pid>/stat'
+ * into a stack buffer. The command name in the file can contain spaces and
+ * brackets. Therefore, the fields are counted from the last ')'.
  *
- * Return value: %TRUE, if checks succeed, otherwise %FALSE;
+ * Return value: %TRUE, if the start time could be read. Otherwise %FALSE.
  */
 static gboolean
-nhm_main_is_dbus_alive(NhmCheckedDbus *checked_dbus)
+nhm_main_read_start_time(const gchar *pid,
+                         guint64     *start_time)
 {
-  GError   *error       = NULL;
-  GVariant *dbus_return = NULL;
-  gboolean  retval      = FALSE;
-
-  /* Step 1: Check if connection already was opened. If not, open it */
-  if(checked_dbus->bus_conn == NULL)
+  gchar     stat_path[NHM_PROC_PATH_SIZE];
+  gchar     stat_buf[1024];
+  gssize    stat_len  = 0;
+  gint      stat_fd   = -1;
+  gchar    *field     = NULL;
+  guint     field_idx = 0;
+  gboolean  retval    = FALSE;
+
+  g_snprintf(stat_path, sizeof(stat_path), NHM_PROC_DIR"%s/stat", pid);
+  stat_fd = open(stat_path, O_RDONLY);
+
+  if(stat_fd >= 0)
   {
-    checked_dbus->bus_conn = g_dbus_connection_new_for_address_sync(checked_dbus->bus_addr,
-                                                                      G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT
-                                                                    | G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
-                                                                    NULL,
-                                                                    NULL,
-                                                                    &error);
-    if(error == NULL)
-    {
-      retval = TRUE;
-      g_dbus_connection_set_exit_on_close(checked_dbus->bus_conn, FALSE);
-    }
-    else
+    stat_len = read(stat_fd, stat_buf, sizeof(stat_buf) - 1);
+    close(stat_fd);
+
+    if(stat_len > 0)
     {
-      retval = FALSE;
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_ERROR,
-              DLT_STRING("NHM: D-Bus observation failed.");
-              DLT_STRING("Error: Failed to connect to observed bus.");
-              DLT_STRING("Bus address:"); DLT_STRING(checked_dbus->bus_addr);
-              DLT_STRING("Reason:");      DLT_STRING(error->message));
-      g_error_free(error);
+      stat_buf[stat_len] = '\0';
+      field = strrchr(stat_buf, ')');
+
+      /* Fields after the command name start with field 3 ('state') */
+      for(field_idx = 2; (field != NULL) && (field_idx < 22); field_idx++)
+      {
+        field = strchr(field + 1, ' ');
+      }
+
+      if(field != NULL)
+      {
+        *start_time = g_ascii_strtoull(field + 1, NULL, 10);
+        retval      = TRUE;
+      }
     }
   }
-  else
-  {
-    retval = TRUE;
-  }
 
-  /* Step 2: If there is an open conn., call method of default dbus object */
-  if(retval == TRUE)
+  return retval;
+}
+
+
+/**
+ * nhm_main_is_prog_pid:
+ * @prog:       Full path to the executable of a monitored program.
+ * @pid:        Process ID as string.
+ * @start_time: Return value for the start time of the process.
+ *
+ * The function checks if the process with the passed ID runs @prog. The
+ * 'exe' link is read into a stack buffer.
+ *
+ * Return value: %TRUE, if the process runs @prog. Otherwise %FALSE.
+ */
+static gboolean
+nhm_main_is_prog_pid(const gchar *prog,
+                     const gchar *pid,
+                     guint64     *start_time)
+{
+  gchar    exe_link[NHM_PROC_PATH_SIZE];
+  gchar    prog_name[PATH_MAX];
+  gssize   name_len = 0;
+  gboolean retval   = FALSE;
+
+  g_snprintf(exe_link, sizeof(exe_link), NHM_PROC_DIR"%s/exe", pid);
+  name_len = readlink(exe_link, prog_name, sizeof(prog_name) - 1);
+
+  if(name_len > 0)
   {
-    dbus_return = g_dbus_connection_call_sync(checked_dbus->bus_conn,
-                                              "org.freedesktop.DBus",
-                                              "/org/freedesktop/DBus",
-                                              "org.freedesktop.DBus",
-                                              "GetId",
-                                              NULL,
-                                              NULL,
-                                              G_DBUS_CALL_FLAGS_NONE,
-                                              -1,
-                                              NULL,
-                                              &error);
-    if(error == NULL)
-    {
-      retval = TRUE;
-      g_variant_unref(dbus_return);
-    }
-    else
-    {
-      retval = FALSE;
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_ERROR,
-              DLT_STRING("NHM: D-Bus observation failed.");
-              DLT_STRING("Error: Failed to call dbus method.");
-              DLT_STRING("Bus address:"); DLT_STRING(checked_dbus->bus_addr);
-              DLT_STRING("Reason:");      DLT_STRING(error->message));
-      g_error_free(error);
-    }
+    prog_name[name_len] = '\0';
+    retval =    (g_strcmp0(prog_name, prog) == 0)
+             && (nhm_main_read_start_time(pid, start_time) == TRUE);
   }
 
   return retval;
@@ -1009,441 +2379,3175 @@ nhm_main_is_dbus_alive(NhmCheckedDbus *checked_dbus)
 
 
 /**
- * nhm_main_start_wdog:
+ * nhm_main_free_prog_pid:
+ * @prog_pid: Pointer to 'NhmProgPid' object.
  *
- * The function reads the watchdog timeout value from the environment and starts
- * a cyclic timer if a timeout is configured.
+ * Frees the memory occupied by a 'NhmProgPid' object and stops watching the
+ * process. It is used as 'value destroy func' for the table 'monitored_pids'.
  */
 static void
-nhm_main_start_wdog(void)
+nhm_main_free_prog_pid(gpointer prog_pid)
 {
-  const gchar *wdog_str_us = NULL;
-  gchar       *endptr      = NULL;
-  guint64      wdog_us     = 0;
-  guint        wdog_ms     = 0;
-
-  wdog_str_us = g_getenv("WATCHDOG_USEC");
+  NhmProgPid *p = (NhmProgPid*) prog_pid;
 
-  if(wdog_str_us != NULL)
+  if(p->watch != 0)
   {
-    errno = 0;
-    wdog_us = g_ascii_strtoull(wdog_str_us, &endptr, 10);
+    nhm_main_remove_check_source(p->watch);
+  }
 
-    if(    (*endptr == '\0'       )   /* Parsed to end of string */
-        && (endptr  != wdog_str_us)   /* String was not empty    */
-        && (errno   == 0          ))  /* No error (overflow) set */
+  g_slice_free(NhmProgPid, p);
+}
+
+
+/**
+ * nhm_main_watch_indexed_prog:
+ * @prog: Interned name of the monitored program.
+ *
+ * The function searches a process of the program in the index of the proc
+ * connector and watches it. The process is cached only, if it is watched,
+ * so that its exit is reported by 'nhm_main_prog_exit_cb'.
+ */
+static void
+nhm_main_watch_indexed_prog(const gchar *prog)
+{
+  GHashTableIter  iter;
+  gpointer        pid        = NULL;
+  gpointer        pid_prog   = NULL;
+  gchar           pid_str[24];
+  guint64         start_time = 0;
+  gboolean        found      = FALSE;
+  NhmProgPid     *prog_pid   = NULL;
+
+  g_hash_table_iter_init(&iter, proc_events_pids);
+
+  while(   (found == FALSE)
+        && (g_hash_table_iter_next(&iter, &pid, &pid_prog) == TRUE))
+  {
+    if(pid_prog == prog)
     {
-      wdog_us /= 2000; /* convert us to ms and get half timeout */
-      wdog_ms = (wdog_us > G_MAXUINT) ? G_MAXUINT : (guint) wdog_us;
+      g_snprintf(pid_str, sizeof(pid_str), "%d", GPOINTER_TO_INT(pid));
+      found = nhm_main_read_start_time(pid_str, &start_time);
+    }
+  }
 
-      (void) g_timeout_add(wdog_ms, &nhm_main_timer_wdog_cb, NULL);
+  if(found == TRUE)
+  {
+    prog_pid             = g_slice_new(NhmProgPid);
+    prog_pid->pid        = GPOINTER_TO_INT(pid);
+    prog_pid->start_time = start_time;
+    prog_pid->watch      = nhm_main_watch_prog_pid(prog, prog_pid->pid);
 
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_INFO,
-              DLT_STRING("NHM: Started watchdog timer.");
-              DLT_STRING("Cycle:"); DLT_UINT(wdog_ms); DLT_STRING("ms"));
+    if(prog_pid->watch != 0)
+    {
+      g_hash_table_replace(monitored_pids, (gpointer) prog, prog_pid);
     }
     else
     {
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_ERROR,
-              DLT_STRING("NHM: Watchdog initialization failed.");
-              DLT_STRING("Error: Failed to parse WATCHDOG_USEC.");
-              DLT_STRING("Value:"); DLT_STRING(wdog_str_us));
+      g_slice_free(NhmProgPid, prog_pid);
     }
   }
-  else
-  {
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_WARN,
-            DLT_STRING("NHM: Watchdog timeout not configured."));
-  }
 }
 
 
 /**
- * nhm_main_timer_wdog_cb:
- * @user_data: Optional user data
+ * nhm_main_watch_prog_pid:
+ * @prog: Interned name of the monitored program.
+ * @pid:  Process ID of the program.
  *
- * The function is a timer callback, used to trigger the watchdog periodically.
+ * The function opens a pidfd for the process of a monitored program and adds
+ * a watch for it to the check context. The pidfd becomes readable when the
+ * process exits. If the kernel does not support pidfds, the process is not
+ * watched and its exit is detected by the periodic userland check.
  *
- * Return value: Always %TRUE to keep timer for callback alive.
+ * Return value: ID of the watch. 0, if the process could not be watched.
  */
-static gboolean
-nhm_main_timer_wdog_cb(gpointer user_data)
+static guint
+nhm_main_watch_prog_pid(const gchar *prog,
+                        glong        pid)
 {
-  (void) sd_notify(0, "WATCHDOG=1");
-  DLT_LOG(nhm_helper_trace_ctx,
-          DLT_LOG_INFO,
-          DLT_STRING("NHM: Triggered systemd WDOG."));
+  gint        pidfd   = -1;
+  GIOChannel *channel = NULL;
+  guint       watch   = 0;
 
-  return TRUE;
+  /* Kernel headers without pidfd support */
+  errno = ENOSYS;
+
+#ifdef SYS_pidfd_open
+  pidfd = (gint) syscall(SYS_pidfd_open, (pid_t) pid, 0);
+#endif
+
+  if(pidfd >= 0)
+  {
+    channel = g_io_channel_unix_new(pidfd);
+    g_io_channel_set_close_on_unref(channel, TRUE);
+    watch = nhm_main_add_check_source(g_io_create_watch(channel,
+                                                          G_IO_IN | G_IO_HUP | G_IO_ERR),
+                                      (GSourceFunc) &nhm_main_prog_exit_cb,
+                                      (gpointer) prog);
+    g_io_channel_unref(channel);
+  }
+  else
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: Failed to watch monitored program.");
+            DLT_STRING("Prog name:"); DLT_STRING(prog);
+            DLT_STRING("Reason:");    DLT_STRING(g_strerror(errno)));
+  }
+
+  return watch;
 }
 
 
 /**
- * nhm_main_timer_userland_check_cb:
- * @user_data: Optional user data
+ * nhm_main_prog_exit_cb:
+ * @channel:   Channel of the pidfd of the watched process.
+ * @condition: Condition that triggered the callback.
+ * @user_data: Interned name of the monitored program.
  *
- * The function is a timer callback, called periodically to perform 'userland'
- * checks. If a user land check fails, the function resets the system!
+ * The function is called when the watched process of a monitored program
+ * exited. The process is removed from the cache and the program is searched
+ * again, because other processes may still run it. The exit event of the
+ * proc connector may not have been received yet. Therefore, the process also
+ * is removed from its index. If another process is found, it is watched.
+ * Only if no process is left, the exit is reported immediately like a failed
+ * userland check.
  *
- * Return value: Always %TRUE to keep timer for callback alive.
+ * Return value: Always %FALSE to remove the watch.
  */
 static gboolean
-nhm_main_timer_userland_check_cb(gpointer user_data)
+nhm_main_prog_exit_cb(GIOChannel   *channel,
+                      GIOCondition  condition,
+                      gpointer      user_data)
 {
-  guint    check_idx = 0;
-  gboolean ul_ok     = TRUE;
+  gchar         *prog     = (gchar*) user_data;
+  gchar         *progs[2] = {NULL, NULL};
+  NhmProgPid    *prog_pid = NULL;
+  NhmCheckEntry *entry    = NULL;
+  const gchar   *reason   = "Reason: Monitored program not running.";
 
-  DLT_LOG(nhm_helper_trace_ctx,
-          DLT_LOG_INFO,
-          DLT_STRING("NHM: Userland check started."));
+  progs[0] = prog;
+  prog_pid = (NhmProgPid*) g_hash_table_lookup(monitored_pids, prog);
 
-  /* Check if monitored files exist */
-  if(monitored_files != NULL)
+  /* The watch is removed by returning FALSE */
+  if(prog_pid != NULL)
   {
-    for(check_idx = 0;
-        (check_idx < g_strv_length(monitored_files)) && (ul_ok == TRUE);
-        check_idx++)
+    if(proc_events_pids != NULL)
     {
-      ul_ok = nhm_does_file_exist(monitored_files[check_idx]);
+      nhm_main_proc_events_remove_pid(prog_pid->pid);
     }
 
-    if(ul_ok == FALSE)
-    {
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_INFO,
-              DLT_STRING("NHM: Userland check failed.");
-              DLT_STRING("Reason: Monitored file does not exist.");
-              DLT_STRING("File name:");
-              DLT_STRING(monitored_files[check_idx - 1]));
-    }
+    prog_pid->watch = 0;
+    g_hash_table_remove(monitored_pids, prog);
   }
 
-  /* Check if monitored programs re running */
-  if(ul_ok == TRUE)
+  if(nhm_main_find_missing_prog(progs, NULL) != NULL)
   {
-    if(monitored_progs != NULL)
-    {
-      for(check_idx = 0;
-          (check_idx < g_strv_length(monitored_progs)) && (ul_ok == TRUE);
-          check_idx++)
-      {
-        ul_ok = nhm_main_is_process_running(monitored_progs[check_idx]);
-      }
+    nhm_main_post_check_result(NHM_CHECK_PROG, prog, reason);
 
-      if(ul_ok == FALSE)
-      {
-        DLT_LOG(nhm_helper_trace_ctx,
-                DLT_LOG_INFO,
-                DLT_STRING("NHM: Userland check failed.");
-                DLT_STRING("Reason: Monitored program not running.");
-                DLT_STRING("Prog name:");
-                DLT_STRING(monitored_progs[check_idx - 1]));
-      }
-    }
-  }
+    entry = (check_entry_names != NULL)
+            ? (NhmCheckEntry*) g_hash_table_lookup(check_entry_names,
+                                                   NHM_PROG_CHECK_NAME)
+            : NULL;
 
-  /* Check if monitored processes return valid */
-  if(ul_ok == TRUE)
-  {
-    if(monitored_procs != NULL)
+    if(entry != NULL)
     {
-      for(check_idx = 0;
-          (check_idx < g_strv_length(monitored_procs)) && (ul_ok == TRUE);
-          check_idx++)
+      /* Add program to the ones found missing by the last check */
+      if(entry->failed == FALSE)
       {
-        ul_ok = nhm_main_is_process_ok(monitored_procs[check_idx]);
+        g_ptr_array_set_size(entry->missing, 0);
       }
 
-      if(ul_ok == FALSE)
-      {
-        DLT_LOG(nhm_helper_trace_ctx,
-                DLT_LOG_INFO,
-                DLT_STRING("NHM: Userland check failed.");
-                DLT_STRING("Reason: Monitored proc. returned invalid.");
-                DLT_STRING("Proc name:");
-                DLT_STRING(monitored_procs[check_idx - 1]));
-      }
+      g_ptr_array_add(entry->missing, prog);
+      nhm_main_finish_check(entry, reason);
     }
   }
 
-  /* Check if monitored dbusses are alive */
-  if(ul_ok == TRUE)
+  return FALSE;
+}
+
+
+/**
+ * nhm_main_proc_events_add_pid:
+ * @pid: ID of a process that has been started or executed a new program.
+ *
+ * The function reads the 'exe' link of the process into a stack buffer. If
+ * the process runs a monitored program, it is added to the process index.
+ * A process that executed another program is removed from the index first.
+ */
+static void
+nhm_main_proc_events_add_pid(glong pid)
+{
+  gchar     exe_link[NHM_PROC_PATH_SIZE];
+  gchar     prog_name[PATH_MAX];
+  gssize    name_len  = 0;
+  gpointer  prog      = NULL;
+
+  nhm_main_proc_events_remove_pid(pid);
+
+  g_snprintf(exe_link, sizeof(exe_link), NHM_PROC_DIR"%ld/exe", pid);
+  name_len = readlink(exe_link, prog_name, sizeof(prog_name) - 1);
+
+  if(name_len > 0)
   {
-    if(checked_dbusses != NULL)
+    prog_name[name_len] = '\0';
+
+    if(g_hash_table_lookup_extended(proc_events_progs,
+                                    prog_name,
+                                    &prog,
+                                    NULL) == TRUE)
     {
-      for(check_idx = 0;
-          (check_idx < checked_dbusses->len) && (ul_ok == TRUE);
-          check_idx++)
-      {
-        if(nhm_main_is_dbus_alive((NhmCheckedDbus*)
-            g_ptr_array_index(checked_dbusses, check_idx)) == FALSE)
-        {
-          ul_ok = FALSE;
-          DLT_LOG(nhm_helper_trace_ctx,
-                  DLT_LOG_INFO,
-                  DLT_STRING("NHM: Userland check failed.");
-                  DLT_STRING("Reason: Monitored dbus returned invalid.");
-                  DLT_STRING("Bus name:");
-                  DLT_STRING(((NhmCheckedDbus*)
-                     g_ptr_array_index(checked_dbusses, check_idx))->bus_addr));
-        }
-      }
+      nhm_main_proc_events_index_pid(pid, prog);
     }
   }
+}
+
+
+/**
+ * nhm_main_proc_events_index_pid:
+ * @pid:  ID of a process that runs a monitored program.
+ * @prog: Interned name of the program, which the process runs.
+ *
+ * The function adds the process to the process index and counts it for the
+ * program. The process must not be in the index yet.
+ */
+static void
+nhm_main_proc_events_index_pid(glong    pid,
+                               gpointer prog)
+{
+  guint count = GPOINTER_TO_UINT(g_hash_table_lookup(proc_events_progs, prog));
+
+  g_hash_table_insert(proc_events_pids, GINT_TO_POINTER(pid), prog);
+  g_hash_table_insert(proc_events_progs, prog, GUINT_TO_POINTER(count + 1));
+}
+
 
-  /* Print outcome of userland check */
-  if(ul_ok == TRUE)
+/**
+ * nhm_main_proc_events_remove_pid:
+ * @pid: ID of a process that exited.
+ *
+ * The function removes the process from the process index, if it ran a
+ * monitored program.
+ */
+static void
+nhm_main_proc_events_remove_pid(glong pid)
+{
+  gpointer prog  = NULL;
+  guint    count = 0;
+
+  prog = g_hash_table_lookup(proc_events_pids, GINT_TO_POINTER(pid));
+
+  if(prog != NULL)
   {
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_INFO,
-            DLT_STRING("NHM: Userland check successfully finished."));
+    g_hash_table_remove(proc_events_pids, GINT_TO_POINTER(pid));
+    count = GPOINTER_TO_UINT(g_hash_table_lookup(proc_events_progs, prog));
+    g_hash_table_insert(proc_events_progs,
+                        prog,
+                        GUINT_TO_POINTER((count > 0) ? count - 1 : 0));
   }
-  else
+}
+
+
+/**
+ * nhm_main_proc_events_scan:
+ *
+ * The function fills the process index with the processes that already run
+ * when the proc connector is subscribed, or when events have been lost.
+ */
+static void
+nhm_main_proc_events_scan(void)
+{
+  GDir           *root_dir = NULL;
+  const gchar    *proc_dir = NULL;
+  GHashTableIter  iter;
+  gpointer        prog     = NULL;
+
+  g_hash_table_remove_all(proc_events_pids);
+  g_hash_table_iter_init(&iter, proc_events_progs);
+
+  while(g_hash_table_iter_next(&iter, &prog, NULL) == TRUE)
   {
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_INFO,
-            DLT_STRING("NHM: Userland check failed. Restarting system."));
+    g_hash_table_iter_replace(&iter, GUINT_TO_POINTER(0));
   }
 
-  return TRUE;
+  root_dir = g_dir_open(NHM_PROC_DIR, 0, NULL);
+
+  if(root_dir != NULL)
+  {
+    for(proc_dir = g_dir_read_name(root_dir);
+        proc_dir != NULL;
+        proc_dir = g_dir_read_name(root_dir))
+    {
+      /* Only process folders have a numeric name */
+      if(g_ascii_isdigit(proc_dir[0]) == TRUE)
+      {
+        nhm_main_proc_events_add_pid(strtol(proc_dir, NULL, 10));
+      }
+    }
+
+    g_dir_close(root_dir);
+  }
 }
 
 
 /**
- * nhm_main_lc_request_cb:
- * @object:        NSM LifecycleConsumer object
- * @invocation:    Invocation object of dbus
- * @shutdown_type: Type of the shut down (NSM_SHUTDOWN_TYPE_*)
- * @request_id:    ID of shut down request. Used for async. completion call
- * @user_data:     Optionally user data
+ * nhm_main_proc_events_connect:
  *
- * The function is a dbus callback, called by the NSM to shut down the system.
- * Because NHM usually is the last 'shutdown client', write the shut down flag.
+ * The function subscribes to the fork, exec and exit events of the kernel proc
+ * connector and builds an index of the processes of the monitored programs.
+ * The index is then kept up to date by 'nhm_main_proc_events_cb', so that
+ * the userland check only has to look up the programs. Subscribing needs
+ * CAP_NET_ADMIN. Without it, the userland check scans '/proc'.
  *
- * Return value: Always %TRUE to inform dbus that call has been processed.
+ * Return value: %TRUE, if the proc connector is used. Otherwise %FALSE.
  */
 static gboolean
-nhm_main_lc_request_cb(NsmDbusLcConsumer     *object,
-                       GDBusMethodInvocation *invocation,
-                       const guint            shutdown_type,
-                       const guint            request_id,
-                       gpointer               user_data)
+nhm_main_proc_events_connect(void)
 {
-  NsmErrorStatus_e error = NsmErrorStatus_NotSet;
+  gint                     sock_fd   = -1;
+  struct sockaddr_nl       sock_addr;
+  enum proc_cn_mcast_op    op        = PROC_CN_MCAST_LISTEN;
+  struct cn_msg           *msg       = NULL;
+  GIOChannel              *channel   = NULL;
+  guint                    prog_idx  = 0;
+  union
+  {
+    struct nlmsghdr hdr;
+    gchar           buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(op))];
+  } req;
 
-  if(shutdown_type != NSM_SHUTDOWNTYPE_RUNUP)
+  sock_fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+
+  if(sock_fd >= 0)
   {
-    error =   (nhm_main_write_shutdown_flag(NHM_NODESTATE_SHUTDOWN) == TRUE)
-            ? NsmErrorStatus_Ok : NsmErrorStatus_Error;
+    memset(&sock_addr, 0, sizeof(sock_addr));
+    sock_addr.nl_family = AF_NETLINK;
+    sock_addr.nl_groups = CN_IDX_PROC;
+    sock_addr.nl_pid    = 0;
+
+    memset(&req, 0, sizeof(req));
+    req.hdr.nlmsg_len  = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    req.hdr.nlmsg_type = NLMSG_DONE;
+    msg                = (struct cn_msg*) NLMSG_DATA(&req.hdr);
+    msg->id.idx        = CN_IDX_PROC;
+    msg->id.val        = CN_VAL_PROC;
+    msg->len           = sizeof(op);
+    memcpy(msg->data, &op, sizeof(op));
+
+    if(   (bind(sock_fd, (struct sockaddr*) &sock_addr, sizeof(sock_addr)) != 0)
+       || (send(sock_fd, &req, req.hdr.nlmsg_len, 0) < 0))
+    {
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_WARN,
+              DLT_STRING("NHM: Failed to subscribe to proc connector.");
+              DLT_STRING("Using '/proc' scan for monitored programs.");
+              DLT_STRING("Reason:"); DLT_STRING(g_strerror(errno)));
+      close(sock_fd);
+      sock_fd = -1;
+    }
   }
   else
   {
-    error =   (nhm_main_write_shutdown_flag(NHM_NODESTATE_STARTED) == TRUE)
-            ? NsmErrorStatus_Ok : NsmErrorStatus_Error;
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: Failed to open proc connector.");
+            DLT_STRING("Using '/proc' scan for monitored programs.");
+            DLT_STRING("Reason:"); DLT_STRING(g_strerror(errno)));
   }
 
-  /* Inform NSM that shut down request was successfully processed */
-  nsm_dbus_lc_consumer_complete_lifecycle_request(object,
-                                                  invocation,
-                                                  (gint) error);
+  if(sock_fd >= 0)
+  {
+    proc_events_pids  = g_hash_table_new(&g_direct_hash, &g_direct_equal);
+    proc_events_progs = g_hash_table_new(&g_str_hash, &g_str_equal);
 
-  return TRUE;
+    for(prog_idx = 0; monitored_progs[prog_idx] != NULL; prog_idx++)
+    {
+      g_hash_table_insert(proc_events_progs,
+                          (gpointer) g_intern_string(monitored_progs[prog_idx]),
+                          GUINT_TO_POINTER(0));
+    }
+
+    channel = g_io_channel_unix_new(sock_fd);
+    g_io_channel_set_close_on_unref(channel, TRUE);
+    proc_events_watch =
+      nhm_main_add_check_source(g_io_create_watch(channel,
+                                                  G_IO_IN | G_IO_HUP | G_IO_ERR),
+                                (GSourceFunc) &nhm_main_proc_events_cb,
+                                NULL);
+    g_io_channel_unref(channel);
+
+    /* Events are already received. Add processes that run already. */
+    nhm_main_proc_events_scan();
+  }
+
+  return (sock_fd >= 0);
 }
 
 
 /**
- * nhm_main_bus_acquired_cb:
- * @connection: Connection, which was acquired
- * @bus_name:   Bus name
- * @user_data:  Optionally user data
+ * nhm_main_proc_events_disconnect:
  *
- * The function is called when a connection to the D-Bus could be established.
+ * The function unsubscribes from the proc connector and destroys the
+ * process index. Afterwards, the userland check scans '/proc' again.
  */
 static void
-nhm_main_bus_acquired_cb(GDBusConnection *connection,
-                         const gchar     *bus_name,
-                         gpointer         user_data)
+nhm_main_proc_events_disconnect(void)
 {
-  GError    *error   = NULL;
-  NhmLcInfo *lc_info = NULL;
-
-  /* "Protect" NHM from exit when conn. fails. Important to monitor dbus */
-  g_dbus_connection_set_exit_on_close(connection, FALSE);
-
-  /* The first array element always has to be the current LC. Create it! */
-  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
-  lc_info = g_new(NhmLcInfo, 1);
-
-  /* Load shutdown flag. Indicates if last LC was regular shut down */
-  lc_info->start_state = nhm_main_read_shutdown_flag();
-  lc_info->failed_apps = NULL;
-  g_ptr_array_add(nodeinfo, (gpointer) lc_info);
+  if(proc_events_watch != 0)
+  {
+    nhm_main_remove_check_source(proc_events_watch);
+    proc_events_watch = 0;
+  }
 
-  DLT_LOG(nhm_helper_trace_ctx,
-          DLT_LOG_INFO,
-          DLT_STRING("NHM: Previous shutdown was");
-          DLT_STRING(  (lc_info->start_state == NHM_NODESTATE_SHUTDOWN)
-                      ? "complete" : "incomplete"));
+  if(proc_events_pids != NULL)
+  {
+    g_hash_table_destroy(proc_events_pids);
+    proc_events_pids = NULL;
+  }
 
-  /* Read data of prev. LCs. They are added to 'nodeinfo' after current LC */
-  nhm_main_read_data();
+  if(proc_events_progs != NULL)
+  {
+    g_hash_table_destroy(proc_events_progs);
+    proc_events_progs = NULL;
+  }
+}
 
-  /* Create skeleton object, register signals and export interfaces */
-  dbus_nhm_info_obj = nhm_dbus_info_skeleton_new();
 
-  (void) g_signal_connect(dbus_nhm_info_obj,
-                          "handle-register-app-status",
-                          G_CALLBACK(nhm_main_register_app_status_cb),
-                          NULL);
+/**
+ * nhm_main_proc_events_cb:
+ * @channel:   Channel of the proc connector socket.
+ * @condition: Condition that triggered the callback.
+ * @user_data: Optional user data (not used).
+ *
+ * The function receives the events of the proc connector and updates the
+ * process index. Only forks and exits of whole processes (not threads) are
+ * handled. A process forked by a process of a monitored program is indexed
+ * for the same program, because it runs the same executable until it calls
+ * exec. If events have been lost, the index is rebuilt from '/proc'. If the
+ * socket fails, the proc connector is dropped and the userland check scans
+ * '/proc'.
+ *
+ * Return value: %TRUE to keep the watch. %FALSE if the socket failed.
+ */
+static gboolean
+nhm_main_proc_events_cb(GIOChannel   *channel,
+                        GIOCondition  condition,
+                        gpointer      user_data)
+{
+  gint               sock_fd  = g_io_channel_unix_get_fd(channel);
+  struct nlmsghdr   *hdr      = NULL;
+  struct cn_msg     *msg      = NULL;
+  struct proc_event *event    = NULL;
+  gpointer           prog     = NULL;
+  glong              pid      = 0;
+  gssize             recv_len = 0;
+  gboolean           retval   = TRUE;
+  union
+  {
+    struct nlmsghdr hdr;
+    gchar           buf[4096];
+  } resp;
 
-  (void) g_signal_connect(dbus_nhm_info_obj,
-                          "handle-read-statistics",
-                          G_CALLBACK(nhm_main_read_statistics_cb),
-                          NULL);
+  recv_len = ((condition & G_IO_IN) != 0)
+           ? recv(sock_fd, &resp, sizeof(resp), 0)
+           : -1;
 
-  (void) g_signal_connect(dbus_nhm_info_obj,
-                          "handle-request-node-restart",
-                          G_CALLBACK(nhm_main_request_node_restart_cb),
-                          NULL);
+  if(recv_len > 0)
+  {
+    for(hdr = &resp.hdr;
+        NLMSG_OK(hdr, recv_len);
+        hdr = NLMSG_NEXT(hdr, recv_len))
+    {
+      msg   = (struct cn_msg*) NLMSG_DATA(hdr);
+      event = (struct proc_event*) msg->data;
 
-  (void) g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(dbus_nhm_info_obj),
-                                          connection,
-                                          NHM_INFO_OBJECT,
-                                          &error);
-  if(error != NULL)
+      switch(event->what)
+      {
+        case PROC_EVENT_FORK:
+          if(   event->event_data.fork.child_pid
+             == event->event_data.fork.child_tgid)
+          {
+            pid  = event->event_data.fork.child_tgid;
+            prog = g_hash_table_lookup(proc_events_pids,
+                                       GINT_TO_POINTER(event->event_data.fork.parent_tgid));
+            nhm_main_proc_events_remove_pid(pid);
+
+            if(prog != NULL)
+            {
+              nhm_main_proc_events_index_pid(pid, prog);
+            }
+          }
+        break;
+
+        case PROC_EVENT_EXEC:
+          nhm_main_proc_events_add_pid(event->event_data.exec.process_tgid);
+        break;
+
+        case PROC_EVENT_EXIT:
+          if(   event->event_data.exit.process_pid
+             == event->event_data.exit.process_tgid)
+          {
+            nhm_main_proc_events_remove_pid(event->event_data.exit.process_pid);
+          }
+        break;
+
+        default:
+          /* Other events are not relevant for the index */
+        break;
+      }
+    }
+  }
+  else if((recv_len < 0) && (errno == ENOBUFS))
+  {
+    /* Socket buffer overrun. Events are lost. Rebuild index. */
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: Proc connector events lost. Rescanning '/proc'."));
+    nhm_main_proc_events_scan();
+  }
+  else if((recv_len < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+  {
+    /* Try again with next event */
+  }
+  else
   {
-    /* Critical error: The interface could not be exported. Stop the NHM. */
     DLT_LOG(nhm_helper_trace_ctx,
             DLT_LOG_ERROR,
-            DLT_STRING("NHM: Bus acquired actions failed.");
-            DLT_STRING("Error: Could not export D-Bus object.");
-            DLT_STRING("Reason:"); DLT_STRING(error->message));
-    g_error_free(error);
+            DLT_STRING("NHM: Proc connector failed.");
+            DLT_STRING("Using '/proc' scan for monitored programs."));
 
-    mainreturn = EXIT_FAILURE;
-    g_main_loop_quit(mainloop);
+    /* The watch is removed by returning FALSE */
+    proc_events_watch = 0;
+    nhm_main_proc_events_disconnect();
+    retval = FALSE;
   }
+
+  return retval;
 }
 
 
 /**
- * nhm_main_name_acquired_cb:
- * @connection: Connection over which the bus name was acquired
- * @app_name:   Acquired bus name
- * @user_data:  Optionally user data
+ * nhm_main_find_missing_prog:
+ * @progs:         %NULL terminated array with full paths to the executables of
+ *                 the monitored programs.
+ * @missing_progs: Array to which the interned names of all programs that are
+ *                 not running are added in the order of @progs. May be %NULL.
  *
- * The function is called when the "bus name" could be acquired on the D-Bus.
+ * The function checks if all passed programs are running (process info in
+ * '/proc'). The process found for a program is cached with its start time.
+ * In later checks only the cached process is verified. Watched processes are
+ * not verified at all, because their exit is reported by
+ * 'nhm_main_prog_exit_cb'. If the proc connector is used, the programs are
+ * only looked up in its process index. If processes are watched, a process of
+ * a running program is watched, if none is watched yet. Otherwise, '/proc' is
+ * scanned
+ * once for all programs whose cached process is gone. The 'exe' link of
+ * every process is read into a stack buffer and looked up in a set of the
+ * programs that have not been found yet. The scan stops as soon as every
+ * program has been found.
+ *
+ * Return value: The first program of @progs that is not running. %NULL, if
+ *               all programs are running.
  */
-static void
-nhm_main_name_acquired_cb(GDBusConnection *connection,
-                          const gchar     *app_name,
-                          gpointer         user_data)
+static const gchar*
+nhm_main_find_missing_prog(gchar     **progs,
+                           GPtrArray  *missing_progs)
 {
-  /* The NHM is now completely functional. Reset the shutdown flag */
-  (void) nhm_main_write_shutdown_flag(NHM_NODESTATE_STARTED);
-
-  /* Write initial state of current LC (no apps failed) and last prev. LCs*/
-  nhm_main_write_data();
-
-  /* If a user land check is configured, install the timer */
-  if(ul_chk_interval != 0)
+  GDir        *root_dir     = NULL;
+  const gchar *proc_dir     = NULL;
+  gchar        pid_str[24];
+  gchar        exe_link[NHM_PROC_PATH_SIZE];
+  gchar        prog_name[PATH_MAX];
+  gssize       name_len     = 0;
+  guint64      start_time   = 0;
+  GHashTable  *missing      = NULL;
+  const gchar *missing_prog = NULL;
+  const gchar *prog         = NULL;
+  NhmProgPid  *prog_pid     = NULL;
+  guint        prog_idx     = 0;
+  gboolean     running      = FALSE;
+  GError      *error        = NULL;
+
+  /* The cache is keyed by the interned program names */
+  if(monitored_pids == NULL)
   {
-    g_timeout_add_seconds(ul_chk_interval,
-                          &nhm_main_timer_userland_check_cb,
-                          NULL);
+    monitored_pids = g_hash_table_new_full(&g_str_hash,
+                                           &g_str_equal,
+                                           NULL,
+                                           &nhm_main_free_prog_pid);
   }
 
-  if(nhm_systemd_connect(&nhm_main_register_app_status) == FALSE)
+  /* Verify cached processes. Collect programs without a running process. */
+  missing = g_hash_table_new(&g_str_hash, &g_str_equal);
+
+  for(prog_idx = 0; progs[prog_idx] != NULL; prog_idx++)
   {
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_WARN,
-            DLT_STRING("NHM: Systemd observation could not be started."));
-  }
+    prog     = g_intern_string(progs[prog_idx]);
+    prog_pid = (NhmProgPid*) g_hash_table_lookup(monitored_pids, prog);
 
-  /* Inform systemd that we started up and start timer for systemd WDOG */
-  (void) sd_notify (0, "READY=1");
-  nhm_main_start_wdog();
+    if(proc_events_progs != NULL)
+    {
+      /* The proc connector keeps the index of running processes */
+      running =    g_hash_table_lookup(proc_events_progs, prog)
+                != GUINT_TO_POINTER(0);
 
-  DLT_LOG(nhm_helper_trace_ctx,
-          DLT_LOG_INFO,
-          DLT_STRING("NHM: Successfully obtained D-Bus name."));
-}
+      if((running == TRUE) && (prog_pid == NULL) && (watch_progs == TRUE))
+      {
+        nhm_main_watch_indexed_prog(prog);
+      }
+    }
+    else
+    {
+      if((prog_pid != NULL) && (prog_pid->watch == 0))
+      {
+        g_snprintf(pid_str, sizeof(pid_str), "%ld", prog_pid->pid);
+
+        if(   (nhm_main_is_prog_pid(prog, pid_str, &start_time) == FALSE)
+           || (start_time != prog_pid->start_time))
+        {
+          g_hash_table_remove(monitored_pids, prog);
+          prog_pid = NULL;
+        }
+      }
 
+      running = (prog_pid != NULL);
+    }
 
-/**
- * nhm_main_name_lost_cb:
- * @connection:      Connection. If it is NULL, no D-Bus connection could be
- *                   established. Otherwise the bus name was lost.
- * @param app_name:  Bus name
- * @param user_data: Optionally user data
+    if(running == FALSE)
+    {
+      g_hash_table_insert(missing, (gpointer) prog, (gpointer) prog);
+    }
+  }
+
+  /* Scan '/proc' only if a program has no verified process */
+  if((g_hash_table_size(missing) != 0) && (proc_events_progs == NULL))
+  {
+    root_dir = g_dir_open(NHM_PROC_DIR, 0, &error);
+
+    if(error == NULL)
+    {
+      /* Proc directory opened. Check every process folder inside */
+      for(proc_dir = g_dir_read_name(root_dir);
+          (proc_dir != NULL) && (g_hash_table_size(missing) != 0);
+          proc_dir = g_dir_read_name(root_dir))
+      {
+        /* Only process folders have a numeric name */
+        if(g_ascii_isdigit(proc_dir[0]) == TRUE)
+        {
+          g_snprintf(exe_link, sizeof(exe_link), NHM_PROC_DIR"%s/exe", proc_dir);
+          name_len = readlink(exe_link, prog_name, sizeof(prog_name) - 1);
+
+          if(name_len > 0)
+          {
+            prog_name[name_len] = '\0';
+            prog = (const gchar*) g_hash_table_lookup(missing, prog_name);
+          }
+          else
+          {
+            prog = NULL;
+          }
+
+          /* Remove program from set and cache process, if it runs it */
+          if(   (prog != NULL)
+             && (nhm_main_read_start_time(proc_dir, &start_time) == TRUE))
+          {
+            g_hash_table_remove(missing, prog);
+
+            prog_pid             = g_slice_new(NhmProgPid);
+            prog_pid->pid        = strtol(proc_dir, NULL, 10);
+            prog_pid->start_time = start_time;
+            prog_pid->watch      = 0;
+
+            if(watch_progs == TRUE)
+            {
+              prog_pid->watch = nhm_main_watch_prog_pid(prog, prog_pid->pid);
+            }
+
+            g_hash_table_replace(monitored_pids, (gpointer) prog, prog_pid);
+          }
+        }
+      }
+
+      g_dir_close(root_dir);
+    }
+    else
+    {
+      /* 'proc' directory could not be opened. All programs are missing. */
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_ERROR,
+              DLT_STRING("NHM: Program check failed. Proc folder not readable.");
+              DLT_STRING("Error: Proc folder not readable.");
+              DLT_STRING("Reason:"); DLT_STRING(error->message));
+      g_error_free(error);
+    }
+  }
+
+  /* Report the missing programs in the configured order */
+  for(prog_idx = 0; progs[prog_idx] != NULL; prog_idx++)
+  {
+    prog = (const gchar*) g_hash_table_lookup(missing, progs[prog_idx]);
+
+    if(prog != NULL)
+    {
+      missing_prog = (missing_prog == NULL) ? progs[prog_idx] : missing_prog;
+
+      if(missing_progs != NULL)
+      {
+        g_ptr_array_add(missing_progs, (gpointer) prog);
+      }
+    }
+  }
+
+  g_hash_table_destroy(missing);
+
+  return missing_prog;
+}
+
+
+/**
+ * nhm_main_free_proc_check:
+ * @proc_check: Pointer to 'NhmProcCheck' object.
+ *
+ * Frees the memory occupied by a 'NhmProcCheck' object. A running check is
+ * no longer watched, but not killed. It is used as 'value destroy func' for
+ * the table 'proc_checks'.
+ */
+static void
+nhm_main_free_proc_check(gpointer proc_check)
+{
+  NhmProcCheck *check = (NhmProcCheck*) proc_check;
+
+  if(check->child_watch != 0)
+  {
+    nhm_main_remove_check_source(check->child_watch);
+  }
+
+  if(check->timeout != 0)
+  {
+    nhm_main_remove_check_source(check->timeout);
+  }
+
+  if(check->pid != 0)
+  {
+    g_spawn_close_pid(check->pid);
+  }
+
+  g_slice_free(NhmProcCheck, check);
+}
+
+
+/**
+ * nhm_main_queue_proc_check:
+ * @proc: Full path to the executable of the monitored proc.
+ *
+ * The function is called by the timer wheel to queue the execution of a
+ * monitored proc. A proc. whose previous check is still queued or running is
+ * not queued again. The results are reported asynchronously by
+ * 'nhm_main_proc_check_exit_cb'. The name is interned, because procs. only
+ * come from the configuration, which is loaded once.
+ */
+static void
+nhm_main_queue_proc_check(const gchar *proc)
+{
+  const gchar  *name  = g_intern_string(proc);
+  NhmProcCheck *check = NULL;
+
+  /* The table and queue are created with the first check */
+  if(proc_checks == NULL)
+  {
+    proc_checks      = g_hash_table_new_full(&g_str_hash,
+                                             &g_str_equal,
+                                             NULL,
+                                             &nhm_main_free_proc_check);
+    proc_check_queue = g_queue_new();
+  }
+
+  check = (NhmProcCheck*) g_hash_table_lookup(proc_checks, name);
+
+  if(check == NULL)
+  {
+    check              = g_slice_new0(NhmProcCheck);
+    check->name        = name;
+    check->status      = -1;
+    g_hash_table_insert(proc_checks, (gpointer) name, check);
+  }
+
+  if((check->pid == 0) && (check->queued == FALSE))
+  {
+    check->queued = TRUE;
+    g_queue_push_tail(proc_check_queue, check);
+  }
+  else
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: Process check skipped.");
+            DLT_STRING("Reason: Previous check not finished.");
+            DLT_STRING("Proc name:"); DLT_STRING(name));
+  }
+
+  nhm_main_run_proc_checks();
+}
+
+
+/**
+ * nhm_main_run_proc_checks:
+ *
+ * Starts queued checks, until the configured amount of running checks is
+ * reached.
+ */
+static void
+nhm_main_run_proc_checks(void)
+{
+  while(   (proc_check_queue != NULL)
+        && (g_queue_is_empty(proc_check_queue) == FALSE)
+        && ((max_proc_checks == 0) || (proc_checks_running < max_proc_checks)))
+  {
+    nhm_main_start_proc_check((NhmProcCheck*) g_queue_pop_head(proc_check_queue));
+  }
+}
+
+
+/**
+ * nhm_main_start_proc_check:
+ * @check: Check that should be started.
+ *
+ * The function starts a monitored proc. without waiting for it. Its exit is
+ * watched in the check context. If a timeout is configured, the proc. is killed
+ * when it did not exit in time. A proc. that can not be started is reported
+ * as failed immediately.
+ */
+static void
+nhm_main_start_proc_check(NhmProcCheck *check)
+{
+  gchar  *argv[] = {(gchar*) check->name, NULL};
+  GError *error  = NULL;
+
+  check->queued     = FALSE;
+  check->timed_out  = FALSE;
+  check->start_time = g_get_monotonic_time();
+
+  (void) g_spawn_async(NULL,
+                       argv,
+                       NULL,
+                         G_SPAWN_DO_NOT_REAP_CHILD
+                       | G_SPAWN_STDOUT_TO_DEV_NULL
+                       | G_SPAWN_STDERR_TO_DEV_NULL,
+                       NULL,
+                       NULL,
+                       &check->pid,
+                       &error);
+
+  if(error == NULL)
+  {
+    proc_checks_running++;
+    check->child_watch =
+      nhm_main_add_check_source(g_child_watch_source_new(check->pid),
+                                (GSourceFunc) &nhm_main_proc_check_exit_cb,
+                                check);
+
+    if(proc_check_timeout != 0)
+    {
+      check->timeout =
+        nhm_main_add_check_source(g_timeout_source_new_seconds(proc_check_timeout),
+                                  &nhm_main_proc_check_timeout_cb,
+                                  check);
+    }
+  }
+  else
+  {
+    /* Prog. execution failed. */
+    check->pid      = 0;
+    check->duration = 0;
+    check->status   = -1;
+
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_ERROR,
+            DLT_STRING("NHM: Process check failed.");
+            DLT_STRING("Error: Monitored process not started.");
+            DLT_STRING("Reason:"); DLT_STRING(error->message));
+    nhm_main_post_check_result(NHM_CHECK_PROC,
+                               check->name,
+                               "Reason: Monitored proc. returned invalid.");
+    nhm_main_finish_check_by_name(check->name,
+                                  "Reason: Monitored proc. returned invalid.");
+    g_error_free(error);
+  }
+}
+
+
+/**
+ * nhm_main_proc_check_exit_cb:
+ * @pid:       Process ID of the check.
+ * @status:    Wait status of the check.
+ * @user_data: Pointer to the 'NhmProcCheck' of the check.
+ *
+ * The function is called in the check context, when a monitored proc. exited.
+ * Wall time and exit status are recorded. If the proc. did not return valid
+ * (0) or has been killed, because it took too long, the failure is reported.
+ * Afterwards, the next queued check is started.
+ */
+static void
+nhm_main_proc_check_exit_cb(GPid     pid,
+                            gint     status,
+                            gpointer user_data)
+{
+  NhmProcCheck *check  = (NhmProcCheck*) user_data;
+  const gchar  *reason = NULL;
+
+  g_spawn_close_pid(pid);
+
+  if(check->timeout != 0)
+  {
+    nhm_main_remove_check_source(check->timeout);
+    check->timeout = 0;
+  }
+
+  /* The child watch is removed after it was dispatched */
+  check->child_watch = 0;
+  check->pid         = 0;
+  check->duration    = g_get_monotonic_time() - check->start_time;
+  check->status      = status;
+  proc_checks_running--;
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_INFO,
+          DLT_STRING("NHM: Process check finished.");
+          DLT_STRING("Proc name:");     DLT_STRING(check->name);
+          DLT_STRING("Duration (ms):"); DLT_INT((gint) (check->duration / 1000));
+          DLT_STRING("Status:");        DLT_INT(status));
+
+  if((check->timed_out == TRUE) || (status != 0))
+  {
+    reason = (check->timed_out == TRUE)
+             ? "Reason: Monitored proc. timed out."
+             : "Reason: Monitored proc. returned invalid.";
+    nhm_main_post_check_result(NHM_CHECK_PROC, check->name, reason);
+  }
+
+  nhm_main_finish_check_by_name(check->name, reason);
+
+  nhm_main_run_proc_checks();
+}
+
+
+/**
+ * nhm_main_proc_check_timeout_cb:
+ * @user_data: Pointer to the 'NhmProcCheck' of the check.
+ *
+ * The function is called, when a monitored proc. did not exit within the
+ * configured timeout. The proc. is killed. The failure is reported, when
+ * its exit is noticed by 'nhm_main_proc_check_exit_cb'.
+ *
+ * Return value: Always %FALSE to remove the timeout.
+ */
+static gboolean
+nhm_main_proc_check_timeout_cb(gpointer user_data)
+{
+  NhmProcCheck *check = (NhmProcCheck*) user_data;
+
+  check->timeout   = 0;
+  check->timed_out = TRUE;
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_WARN,
+          DLT_STRING("NHM: Process check timed out. Killing process.");
+          DLT_STRING("Proc name:"); DLT_STRING(check->name));
+
+  (void) kill(check->pid, SIGKILL);
+
+  return FALSE;
+}
+
+
+/**
+ * nhm_main_probe_dbus:
+ * @checked_dbus: Observed bus, created at startup.
+ *
+ * The function starts a probe of a user defined dbus. If there is no
+ * connection to the bus yet, it is opened. Afterwards "GetId" is called on
+ * org.freedesktop.DBus. Nothing blocks, so that all busses are probed in
+ * parallel. If a probe of the bus is still pending, no further one is started.
+ */
+static void
+nhm_main_probe_dbus(NhmCheckedDbus *checked_dbus)
+{
+  guint timeout = (dbus_probe_timeout != 0) ? dbus_probe_timeout
+                                            : NHM_DBUS_PROBE_TIMEOUT_DEFAULT;
+
+  if(checked_dbus->probe == NULL)
+  {
+    checked_dbus->probe      = g_cancellable_new();
+    checked_dbus->start_time = g_get_monotonic_time();
+
+    /* The connect has no timeout of its own. The deadline always bounds it. */
+    checked_dbus->deadline =
+      nhm_main_add_check_source(g_timeout_source_new(timeout),
+                                &nhm_main_dbus_deadline_cb,
+                                checked_dbus);
+
+    if(checked_dbus->bus_conn == NULL)
+    {
+      g_dbus_connection_new_for_address(checked_dbus->bus_addr,
+                                          G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT
+                                        | G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                        NULL,
+                                        checked_dbus->probe,
+                                        &nhm_main_dbus_connected_cb,
+                                        checked_dbus);
+    }
+    else
+    {
+      nhm_main_dbus_call_get_id(checked_dbus);
+    }
+  }
+  else
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: D-Bus observation skipped.");
+            DLT_STRING("Reason: Previous probe not finished.");
+            DLT_STRING("Bus address:"); DLT_STRING(checked_dbus->bus_addr));
+  }
+}
+
+
+/**
+ * nhm_main_dbus_connected_cb:
+ * @source_object: Not used.
+ * @res:           Result of the asynchronous connect.
+ * @user_data:     The 'NhmCheckedDbus' to which the connection was opened.
+ *
+ * Called when the connection to an observed bus has been opened or failed.
+ * On success, the probe continues with the "GetId" call. If the connect has
+ * been cancelled (deadline missed or bus destroyed), the bus is not accessed.
+ */
+static void
+nhm_main_dbus_connected_cb(GObject      *source_object,
+                           GAsyncResult *res,
+                           gpointer      user_data)
+{
+  NhmCheckedDbus  *checked_dbus = (NhmCheckedDbus*) user_data;
+  GDBusConnection *bus_conn     = NULL;
+  GError          *error        = NULL;
+
+  bus_conn = g_dbus_connection_new_for_address_finish(res, &error);
+
+  if(error == NULL)
+  {
+    checked_dbus->bus_conn = bus_conn;
+    g_dbus_connection_set_exit_on_close(checked_dbus->bus_conn, FALSE);
+    nhm_main_dbus_call_get_id(checked_dbus);
+  }
+  else
+  {
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE)
+    {
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_ERROR,
+              DLT_STRING("NHM: D-Bus observation failed.");
+              DLT_STRING("Error: Failed to connect to observed bus.");
+              DLT_STRING("Bus address:"); DLT_STRING(checked_dbus->bus_addr);
+              DLT_STRING("Reason:");      DLT_STRING(error->message));
+
+      nhm_main_dbus_probe_finished(checked_dbus, error);
+    }
+
+    g_error_free(error);
+  }
+}
+
+
+/**
+ * nhm_main_dbus_call_get_id:
+ * @checked_dbus: Observed bus with an open connection.
+ *
+ * Asynchronously calls "GetId" on org.freedesktop.DBus of the observed bus.
+ * The configured probe timeout is used as timeout of the call.
+ */
+static void
+nhm_main_dbus_call_get_id(NhmCheckedDbus *checked_dbus)
+{
+  g_dbus_connection_call(checked_dbus->bus_conn,
+                         "org.freedesktop.DBus",
+                         "/org/freedesktop/DBus",
+                         "org.freedesktop.DBus",
+                         "GetId",
+                         NULL,
+                         NULL,
+                         G_DBUS_CALL_FLAGS_NONE,
+                         (dbus_probe_timeout != 0)
+                         ? (gint) dbus_probe_timeout : -1,
+                         checked_dbus->probe,
+                         &nhm_main_dbus_get_id_cb,
+                         checked_dbus);
+}
+
+
+/**
+ * nhm_main_dbus_get_id_cb:
+ * @source_object: Connection on which the "GetId" call has been made.
+ * @res:           Result of the asynchronous call.
+ * @user_data:     The 'NhmCheckedDbus' that has been probed.
+ *
+ * Called when the observed bus answered the "GetId" call or the call failed.
+ * If the call has been cancelled (deadline missed or bus destroyed), the bus
+ * is not accessed.
+ */
+static void
+nhm_main_dbus_get_id_cb(GObject      *source_object,
+                        GAsyncResult *res,
+                        gpointer      user_data)
+{
+  NhmCheckedDbus *checked_dbus = (NhmCheckedDbus*) user_data;
+  GVariant       *dbus_return  = NULL;
+  GError         *error        = NULL;
+
+  dbus_return = g_dbus_connection_call_finish((GDBusConnection*) source_object,
+                                              res,
+                                              &error);
+
+  if(error == NULL)
+  {
+    g_variant_unref(dbus_return);
+    nhm_main_dbus_probe_finished(checked_dbus, NULL);
+  }
+  else
+  {
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE)
+    {
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_ERROR,
+              DLT_STRING("NHM: D-Bus observation failed.");
+              DLT_STRING("Error: Failed to call dbus method.");
+              DLT_STRING("Bus address:"); DLT_STRING(checked_dbus->bus_addr);
+              DLT_STRING("Reason:");      DLT_STRING(error->message));
+
+      nhm_main_dbus_probe_finished(checked_dbus, error);
+    }
+
+    g_error_free(error);
+  }
+}
+
+
+/**
+ * nhm_main_dbus_probe_finished:
+ * @checked_dbus: Observed bus, whose probe has been finished.
+ * @error:        Error of the probe or %NULL, if the bus answered.
+ *
+ * The RTT of the probe is added to the histogram of the bus. The bus fails,
+ * if the probe failed or if its RTT exceeded the configured max. RTT.
+ */
+static void
+nhm_main_dbus_probe_finished(NhmCheckedDbus *checked_dbus,
+                             const GError   *error)
+{
+  gint64 rtt = nhm_main_dbus_count_rtt(checked_dbus);
+
+  if(checked_dbus->deadline != 0)
+  {
+    nhm_main_remove_check_source(checked_dbus->deadline);
+    checked_dbus->deadline = 0;
+  }
+
+  g_object_unref(checked_dbus->probe);
+  checked_dbus->probe = NULL;
+
+  if(error != NULL)
+  {
+    nhm_main_dbus_failed(checked_dbus,
+                         "Reason: Monitored dbus returned invalid.");
+  }
+  else if((dbus_max_rtt != 0) && (rtt > (gint64) dbus_max_rtt * 1000))
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_ERROR,
+            DLT_STRING("NHM: D-Bus observation failed.");
+            DLT_STRING("Error: Observed bus answered too late.");
+            DLT_STRING("Bus address:"); DLT_STRING(checked_dbus->bus_addr);
+            DLT_STRING("RTT ms:");      DLT_UINT((guint) (rtt / 1000)));
+
+    nhm_main_dbus_failed(checked_dbus,
+                         "Reason: Monitored dbus exceeded max. RTT.");
+  }
+  else
+  {
+    nhm_main_finish_check_by_name(checked_dbus->bus_addr, NULL);
+  }
+}
+
+
+/**
+ * nhm_main_dbus_count_rtt:
+ * @checked_dbus: Observed bus, whose pending probe ends.
+ *
+ * Adds the time since the start of the pending probe to the RTT histogram.
+ *
+ * Return value: RTT of the probe in us.
+ */
+static gint64
+nhm_main_dbus_count_rtt(NhmCheckedDbus *checked_dbus)
+{
+  gint64 rtt    = g_get_monotonic_time() - checked_dbus->start_time;
+  guint  bucket = 0;
+
+  /* Find bucket 'n' with RTT < 4^n ms. Longer RTTs go to the last bucket. */
+  while(   (bucket < NHM_DBUS_RTT_BUCKETS - 1)
+        && ((rtt / 1000) >= ((gint64) 1 << (2 * bucket))))
+  {
+    bucket++;
+  }
+
+  checked_dbus->rtt_hist[bucket]++;
+
+  return rtt;
+}
+
+
+/**
+ * nhm_main_dbus_deadline_cb:
+ * @user_data: The 'NhmCheckedDbus', whose probe is pending.
+ *
+ * Called when the probe of an observed bus did not finish within the
+ * configured probe timeout or, if none is configured, within the default
+ * timeout of D-Bus calls. This also covers a hanging connect, which has
+ * no timeout of its own. The bus fails immediately. The probe is cancelled
+ * and the connection is dropped, because it may be wedged. The next probe
+ * connects again and reports the bus again, if it still does not answer.
+ *
+ * Return value: Always %FALSE to remove the timeout.
+ */
+static gboolean
+nhm_main_dbus_deadline_cb(gpointer user_data)
+{
+  NhmCheckedDbus *checked_dbus = (NhmCheckedDbus*) user_data;
+
+  checked_dbus->deadline = 0;
+  (void) nhm_main_dbus_count_rtt(checked_dbus);
+
+  /* The callback of the cancelled probe will not access the bus any more */
+  g_cancellable_cancel(checked_dbus->probe);
+  g_object_unref(checked_dbus->probe);
+  checked_dbus->probe = NULL;
+
+  if(checked_dbus->bus_conn != NULL)
+  {
+    g_object_unref(checked_dbus->bus_conn);
+    checked_dbus->bus_conn = NULL;
+  }
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_ERROR,
+          DLT_STRING("NHM: D-Bus observation failed.");
+          DLT_STRING("Error: Observed bus did not answer in time.");
+          DLT_STRING("Bus address:"); DLT_STRING(checked_dbus->bus_addr));
+
+  nhm_main_dbus_failed(checked_dbus, "Reason: Monitored dbus timed out.");
+
+  return FALSE;
+}
+
+
+/**
+ * nhm_main_dbus_failed:
+ * @checked_dbus: Observed bus that failed.
+ * @reason:       Reason of the failure for the trace.
+ *
+ * Reports the failure of an observed bus and traces its RTT histogram.
+ */
+static void
+nhm_main_dbus_failed(NhmCheckedDbus *checked_dbus,
+                     const gchar    *reason)
+{
+  guint *hist = checked_dbus->rtt_hist;
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_INFO,
+          DLT_STRING("NHM: D-Bus RTT histogram.");
+          DLT_STRING("Bus address:");  DLT_STRING(checked_dbus->bus_addr);
+          DLT_STRING("< 1 ms:");       DLT_UINT(hist[0]);
+          DLT_STRING("< 4 ms:");       DLT_UINT(hist[1]);
+          DLT_STRING("< 16 ms:");      DLT_UINT(hist[2]);
+          DLT_STRING("< 64 ms:");      DLT_UINT(hist[3]);
+          DLT_STRING("< 256 ms:");     DLT_UINT(hist[4]);
+          DLT_STRING("< 1024 ms:");    DLT_UINT(hist[5]);
+          DLT_STRING("< 4096 ms:");    DLT_UINT(hist[6]);
+          DLT_STRING(">= 4096 ms:");   DLT_UINT(hist[7]));
+
+  nhm_main_post_check_result(NHM_CHECK_DBUS, checked_dbus->bus_addr, reason);
+  nhm_main_finish_check_by_name(checked_dbus->bus_addr, reason);
+}
+
+
+/**
+ * nhm_main_start_wdog:
+ *
+ * The function reads the watchdog timeout value from the environment and starts
+ * a cyclic timer if a timeout is configured.
+ */
+static void
+nhm_main_start_wdog(void)
+{
+  const gchar *wdog_str_us = NULL;
+  gchar       *endptr      = NULL;
+  guint64      wdog_us     = 0;
+  guint        wdog_ms     = 0;
+
+  wdog_str_us = g_getenv("WATCHDOG_USEC");
+
+  if(wdog_str_us != NULL)
+  {
+    errno = 0;
+    wdog_us = g_ascii_strtoull(wdog_str_us, &endptr, 10);
+
+    if(    (*endptr == '\0'       )   /* Parsed to end of string */
+        && (endptr  != wdog_str_us)   /* String was not empty    */
+        && (errno   == 0          ))  /* No error (overflow) set */
+    {
+      wdog_us /= 2000; /* convert us to ms and get half timeout */
+      wdog_ms = (wdog_us > G_MAXUINT) ? G_MAXUINT : (guint) wdog_us;
+
+      (void) g_timeout_add(wdog_ms, &nhm_main_timer_wdog_cb, NULL);
+
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_INFO,
+              DLT_STRING("NHM: Started watchdog timer.");
+              DLT_STRING("Cycle:"); DLT_UINT(wdog_ms); DLT_STRING("ms"));
+    }
+    else
+    {
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_ERROR,
+              DLT_STRING("NHM: Watchdog initialization failed.");
+              DLT_STRING("Error: Failed to parse WATCHDOG_USEC.");
+              DLT_STRING("Value:"); DLT_STRING(wdog_str_us));
+    }
+  }
+  else
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: Watchdog timeout not configured."));
+  }
+}
+
+
+/**
+ * nhm_main_timer_wdog_cb:
+ * @user_data: Optional user data
+ *
+ * The function is a timer callback, used to trigger the watchdog periodically.
+ *
+ * Return value: Always %TRUE to keep timer for callback alive.
+ */
+static gboolean
+nhm_main_timer_wdog_cb(gpointer user_data)
+{
+  (void) sd_notify(0, "WATCHDOG=1");
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_INFO,
+          DLT_STRING("NHM: Triggered systemd WDOG."));
+
+  return TRUE;
+}
+
+
+/**
+ * nhm_main_add_check_entry:
+ * @type:     Kind of the check.
+ * @idx:      Index of the checked object in its config list.
+ * @name:     Name under which the check is reported.
+ * @count:    Amount of checks of this kind.
+ * @interval: Period of the check in s. If 0, 'ul_chk_interval' is used.
+ *
+ * Creates the schedule of a check and inserts it into the timer wheel. The
+ * checks of one kind are spread over their interval, so that they do not
+ * run at the same time.
+ */
+static void
+nhm_main_add_check_entry(NhmCheckType  type,
+                         guint         idx,
+                         const gchar  *name,
+                         guint         count,
+                         guint         interval)
+{
+  NhmCheckEntry *entry = g_slice_new(NhmCheckEntry);
+
+  entry->type         = type;
+  entry->idx          = idx;
+  entry->name         = g_intern_string(name);
+  entry->interval     = (interval != 0) ? interval : MAX(ul_chk_interval, 1);
+  entry->cur_interval = entry->interval;
+  entry->failures     = check_wheel_failures;
+  entry->phase        = 1 + (guint) (((guint64) idx * entry->interval) / count);
+  entry->jitter       = ul_chk_jitter;
+  entry->due          = check_wheel_now + entry->phase;
+  entry->running      = FALSE;
+  entry->started      = 0;
+  entry->duration     = 0;
+  entry->failed       = FALSE;
+  entry->reason       = NULL;
+  entry->missing      = (type == NHM_CHECK_PROG) ? g_ptr_array_new() : NULL;
+  entry->changed      = 0;
+  entry->sweep        = FALSE;
+
+  g_ptr_array_add(check_entries, entry);
+  g_hash_table_insert(check_entry_names, (gpointer) entry->name, entry);
+  nhm_main_wheel_insert(entry);
+  nhm_main_post_check_interval(entry);
+}
+
+
+/**
+ * nhm_main_schedule_checks:
+ *
+ * Creates a schedule for every monitored file, proc. and bus. All monitored
+ * programs are checked together, because they are found by one scan. The
+ * timer wheel is driven by one source, which ticks every second.
+ */
+static void
+nhm_main_schedule_checks(void)
+{
+  guint idx   = 0;
+  guint count = 0;
+
+  check_entries        = g_ptr_array_new_with_free_func(&nhm_main_free_check_entry);
+  check_entry_names    = g_hash_table_new(&g_str_hash, &g_str_equal);
+  check_wheel_now      = 0;
+  check_wheel_start    = g_get_monotonic_time();
+  check_wheel_failures = g_atomic_int_get(&check_failures);
+
+  count = (monitored_files != NULL) ? g_strv_length(monitored_files) : 0;
+
+  for(idx = 0; idx < count; idx++)
+  {
+    nhm_main_add_check_entry(NHM_CHECK_FILE,
+                             idx,
+                             monitored_files[idx],
+                             count,
+                             file_chk_interval);
+  }
+
+  if(monitored_progs != NULL)
+  {
+    nhm_main_add_check_entry(NHM_CHECK_PROG,
+                             0,
+                             NHM_PROG_CHECK_NAME,
+                             1,
+                             prog_chk_interval);
+  }
+
+  count = (monitored_procs != NULL) ? g_strv_length(monitored_procs) : 0;
+
+  for(idx = 0; idx < count; idx++)
+  {
+    nhm_main_add_check_entry(NHM_CHECK_PROC,
+                             idx,
+                             monitored_procs[idx],
+                             count,
+                             proc_chk_interval);
+  }
+
+  count = (checked_dbusses != NULL) ? checked_dbusses->len : 0;
+
+  for(idx = 0; idx < count; idx++)
+  {
+    nhm_main_add_check_entry(NHM_CHECK_DBUS,
+                             idx,
+                             ((NhmCheckedDbus*) g_ptr_array_index(checked_dbusses, idx))->bus_addr,
+                             count,
+                             dbus_chk_interval);
+  }
+
+  check_wheel_timer =
+    nhm_main_add_check_source(g_timeout_source_new_seconds(1),
+                              &nhm_main_wheel_tick_cb,
+                              NULL);
+}
+
+
+/**
+ * nhm_main_wheel_insert:
+ * @entry: Schedule of a check, whose due tick is set.
+ *
+ * Inserts a check into the slot of the timer wheel, which covers its due
+ * tick. Checks that are due within 64 s are put to level 0. Later checks are
+ * put to a higher level and cascade down, when their slot is reached.
+ */
+static void
+nhm_main_wheel_insert(NhmCheckEntry *entry)
+{
+  guint64 delta = entry->due - check_wheel_now;
+  guint   level = 0;
+  guint   slot  = 0;
+
+  /* Checks due beyond the wheel are put to its last level */
+  if(delta >= ((guint64) 1 << (NHM_WHEEL_LEVELS * NHM_WHEEL_BITS)))
+  {
+    entry->due = check_wheel_now + ((guint64) 1 << (NHM_WHEEL_LEVELS * NHM_WHEEL_BITS)) - 1;
+    delta      = entry->due - check_wheel_now;
+  }
+
+  while(delta >= ((guint64) 1 << ((level + 1) * NHM_WHEEL_BITS)))
+  {
+    level++;
+  }
+
+  slot                     = (entry->due >> (level * NHM_WHEEL_BITS)) & NHM_WHEEL_MASK;
+  check_wheel[level][slot] = g_slist_prepend(check_wheel[level][slot], entry);
+  entry->level             = level;
+  entry->slot              = slot;
+}
+
+
+/**
+ * nhm_main_wheel_remove:
+ * @entry: Schedule of a check, which is in the timer wheel.
+ *
+ * Removes a check from the slot of the timer wheel that holds it.
+ */
+static void
+nhm_main_wheel_remove(NhmCheckEntry *entry)
+{
+  check_wheel[entry->level][entry->slot] =
+    g_slist_remove(check_wheel[entry->level][entry->slot], entry);
+}
+
+
+/**
+ * nhm_main_adapt_check_interval:
+ * @entry: Schedule of a check that has been executed.
+ *
+ * Adapts the cadence of a check to the health of the node. If nothing failed
+ * since the check has been scheduled last and no app. is failed, the interval
+ * of the check is doubled up to 'ul_chk_backoff_max'. Otherwise the check
+ * falls back to its configured interval. Changes are posted to the main loop.
+ */
+static void
+nhm_main_adapt_check_interval(NhmCheckEntry *entry)
+{
+  gint  failures     = g_atomic_int_get(&check_failures);
+  guint cur_interval = entry->interval;
+
+  if(   (failures                              == entry->failures)
+     && (g_atomic_int_get(&check_apps_failed)  == 0              ))
+  {
+    cur_interval = MAX(MIN(entry->cur_interval * 2, ul_chk_backoff_max),
+                       entry->interval);
+  }
+
+  entry->failures = failures;
+
+  if(cur_interval != entry->cur_interval)
+  {
+    entry->cur_interval = cur_interval;
+    nhm_main_post_check_interval(entry);
+  }
+}
+
+
+/**
+ * nhm_main_reset_check_intervals:
+ *
+ * Called, when the node degraded since the last tick. All checks that backed
+ * off fall back to their configured interval. If they are due later than
+ * their phase within this interval, they are pulled in, so that a failure is
+ * detected as fast as without backoff.
+ */
+static void
+nhm_main_reset_check_intervals(void)
+{
+  guint          idx   = 0;
+  NhmCheckEntry *entry = NULL;
+
+  for(idx = 0; idx < check_entries->len; idx++)
+  {
+    entry           = (NhmCheckEntry*) g_ptr_array_index(check_entries, idx);
+    entry->failures = check_wheel_failures;
+
+    if(entry->cur_interval != entry->interval)
+    {
+      entry->cur_interval = entry->interval;
+
+      if(entry->due > check_wheel_now + entry->phase)
+      {
+        nhm_main_wheel_remove(entry);
+        entry->due = check_wheel_now + entry->phase;
+        nhm_main_wheel_insert(entry);
+      }
+
+      nhm_main_post_check_interval(entry);
+    }
+  }
+}
+
+
+/**
+ * nhm_main_wheel_cascade:
+ * @level: Level of the wheel (> 0), whose current slot is reached.
+ *
+ * Moves the checks of the current slot of a level to the lower levels.
+ */
+static void
+nhm_main_wheel_cascade(guint level)
+{
+  guint   slot    = (check_wheel_now >> (level * NHM_WHEEL_BITS)) & NHM_WHEEL_MASK;
+  GSList *entries = check_wheel[level][slot];
+  GSList *link    = NULL;
+
+  check_wheel[level][slot] = NULL;
+
+  for(link = entries; link != NULL; link = g_slist_next(link))
+  {
+    nhm_main_wheel_insert((NhmCheckEntry*) link->data);
+  }
+
+  g_slist_free(entries);
+}
+
+
+/**
+ * nhm_main_wheel_advance:
+ *
+ * Advances the timer wheel by one tick. Higher levels are cascaded, when
+ * the lower level wraps. Afterwards, the checks that are due are executed
+ * and scheduled for their next period.
+ */
+static void
+nhm_main_wheel_advance(void)
+{
+  guint          level   = 0;
+  guint          slot    = 0;
+  GSList        *entries = NULL;
+  GSList        *link    = NULL;
+  NhmCheckEntry *entry   = NULL;
+
+  check_wheel_now++;
+
+  /* Cascade from the top, so that checks can fall through several levels */
+  for(level = NHM_WHEEL_LEVELS - 1; level > 0; level--)
+  {
+    if((check_wheel_now & (((guint64) 1 << (level * NHM_WHEEL_BITS)) - 1)) == 0)
+    {
+      nhm_main_wheel_cascade(level);
+    }
+  }
+
+  slot                 = check_wheel_now & NHM_WHEEL_MASK;
+  entries              = check_wheel[0][slot];
+  check_wheel[0][slot] = NULL;
+
+  for(link = entries; link != NULL; link = g_slist_next(link))
+  {
+    entry = (NhmCheckEntry*) link->data;
+
+    nhm_main_run_check(entry);
+    nhm_main_adapt_check_interval(entry);
+
+    entry->due =   check_wheel_now + entry->cur_interval
+                 + ((entry->jitter != 0)
+                    ? (guint) g_random_int_range(0, (gint32) entry->jitter + 1)
+                    : 0);
+
+    nhm_main_wheel_insert(entry);
+  }
+
+  g_slist_free(entries);
+}
+
+
+/**
+ * nhm_main_wheel_tick_cb:
+ * @user_data: Optional user data (not used).
+ *
+ * The only source of the userland checks. It is called every second and
+ * advances the wheel to the current time. Ticks that have been missed, e.g.
+ * because the source has been delayed, are caught up. If the node degraded
+ * since the last tick, the checks fall back to their configured interval.
+ *
+ * Return value: Always %TRUE to keep the source.
+ */
+static gboolean
+nhm_main_wheel_tick_cb(gpointer user_data)
+{
+  guint64 now      = (guint64) ((g_get_monotonic_time() - check_wheel_start) / G_USEC_PER_SEC);
+  gint    failures = g_atomic_int_get(&check_failures);
+
+  if(failures != check_wheel_failures)
+  {
+    check_wheel_failures = failures;
+    nhm_main_reset_check_intervals();
+  }
+
+  while(check_wheel_now < now)
+  {
+    nhm_main_wheel_advance();
+  }
+
+  return TRUE;
+}
+
+
+/**
+ * nhm_main_run_check:
+ * @entry: Schedule of the check that is due.
+ *
+ * Executes a userland check. Monitored files and programs are checked
+ * immediately. Procs. and busses are started and report asynchronously.
+ * Failures are posted to the main loop. If the check still runs, e.g. a
+ * proc. that did not exit yet, its start time is kept.
+ */
+static void
+nhm_main_run_check(NhmCheckEntry *entry)
+{
+  guint        prog_idx = 0;
+  const gchar *reason   = NULL;
+
+  if(entry->running == FALSE)
+  {
+    entry->running = TRUE;
+    entry->started = g_get_monotonic_time();
+  }
+
+  switch(entry->type)
+  {
+    case NHM_CHECK_FILE:
+      if(nhm_main_is_file_present(entry->idx) == FALSE)
+      {
+        reason = "Reason: Monitored file does not exist.";
+        nhm_main_post_check_result(NHM_CHECK_FILE,
+                                   monitored_files[entry->idx],
+                                   reason);
+      }
+
+      nhm_main_finish_check(entry, reason);
+    break;
+
+    case NHM_CHECK_PROG:
+      g_ptr_array_set_size(entry->missing, 0);
+
+      if(nhm_main_find_missing_prog(monitored_progs, entry->missing) != NULL)
+      {
+        reason = "Reason: Monitored program not running.";
+      }
+
+      for(prog_idx = 0; prog_idx < entry->missing->len; prog_idx++)
+      {
+        nhm_main_post_check_result(NHM_CHECK_PROG,
+                                   g_ptr_array_index(entry->missing, prog_idx),
+                                   reason);
+      }
+
+      nhm_main_finish_check(entry, reason);
+    break;
+
+    case NHM_CHECK_PROC:
+      nhm_main_queue_proc_check(monitored_procs[entry->idx]);
+    break;
+
+    default:
+      nhm_main_probe_dbus((NhmCheckedDbus*)
+                          g_ptr_array_index(checked_dbusses, entry->idx));
+    break;
+  }
+}
+
+
+/**
+ * nhm_main_finish_check:
+ * @entry:  Schedule of the check that finished.
+ * @reason: Static description of the failure. %NULL, if the check passed.
+ *
+ * Records the status and duration of a finished check. The time of the last
+ * change is only updated, if the status changed. If a sweep waits for the
+ * check and it was the last one, the sweep is finished.
+ */
+static void
+nhm_main_finish_check(NhmCheckEntry *entry,
+                      const gchar   *reason)
+{
+  gboolean failed = (reason != NULL);
+
+  if(entry->running == TRUE)
+  {
+    entry->running  = FALSE;
+    entry->duration = g_get_monotonic_time() - entry->started;
+  }
+
+  if((entry->changed == 0) || (entry->failed != failed))
+  {
+    entry->changed = g_get_real_time();
+  }
+
+  entry->failed = failed;
+  entry->reason = reason;
+
+  if(entry->sweep == TRUE)
+  {
+    entry->sweep = FALSE;
+    sweep_pending--;
+
+    if(sweep_pending == 0)
+    {
+      nhm_main_finish_sweep();
+    }
+  }
+}
+
+
+/**
+ * nhm_main_finish_check_by_name:
+ * @name:   Name of the checked proc. or bus.
+ * @reason: Static description of the failure. %NULL, if the check passed.
+ *
+ * Called by the asynchronous checks, when they finished. If the checked
+ * object is scheduled, the status of its check is recorded.
+ */
+static void
+nhm_main_finish_check_by_name(const gchar *name,
+                              const gchar *reason)
+{
+  NhmCheckEntry *entry = NULL;
+
+  if((check_entry_names != NULL) && (name != NULL))
+  {
+    entry = (NhmCheckEntry*) g_hash_table_lookup(check_entry_names, name);
+
+    if(entry != NULL)
+    {
+      nhm_main_finish_check(entry, reason);
+    }
+  }
+}
+
+
+/**
+ * nhm_main_start_sweep_cb:
+ * @user_data: Optional user data (not used).
+ *
+ * Invoked in the check context to evaluate all checks at once, without
+ * stopping at the first failure. The checks are started concurrently and
+ * their regular schedule is kept. The sweep finishes, when all checks
+ * finished or after NHM_SWEEP_TIMEOUT s. If a sweep is pending already, its
+ * report is used.
+ *
+ * Return value: Always %FALSE to remove the source.
+ */
+static gboolean
+nhm_main_start_sweep_cb(gpointer user_data)
+{
+  guint          idx   = 0;
+  NhmCheckEntry *entry = NULL;
+
+  if(sweep_pending == 0)
+  {
+    /* Mark all checks first, so that the sweep can not finish too early */
+    for(idx = 0; (check_entries != NULL) && (idx < check_entries->len); idx++)
+    {
+      entry        = (NhmCheckEntry*) g_ptr_array_index(check_entries, idx);
+      entry->sweep = TRUE;
+      sweep_pending++;
+    }
+
+    if(sweep_pending != 0)
+    {
+      sweep_timer = nhm_main_add_check_source(g_timeout_source_new_seconds(NHM_SWEEP_TIMEOUT),
+                                              &nhm_main_sweep_timeout_cb,
+                                              NULL);
+
+      for(idx = 0; idx < check_entries->len; idx++)
+      {
+        nhm_main_run_check((NhmCheckEntry*) g_ptr_array_index(check_entries, idx));
+      }
+    }
+    else
+    {
+      nhm_main_finish_sweep();
+    }
+  }
+
+  return FALSE;
+}
+
+
+/**
+ * nhm_main_sweep_timeout_cb:
+ * @user_data: Optional user data (not used).
+ *
+ * Called, when checks of a sweep did not finish in time. The sweep is
+ * finished. The pending checks are reported with the status of their last
+ * execution.
+ *
+ * Return value: Always %FALSE to remove the timeout.
+ */
+static gboolean
+nhm_main_sweep_timeout_cb(gpointer user_data)
+{
+  sweep_timer = 0;
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_WARN,
+          DLT_STRING("NHM: Sweep of userland checks timed out.");
+          DLT_STRING("Pending checks:"); DLT_UINT(sweep_pending));
+
+  nhm_main_finish_sweep();
+
+  return FALSE;
+}
+
+
+/**
+ * nhm_main_finish_sweep:
+ *
+ * Ends the pending sweep. The health report is built and posted to the main
+ * loop, which returns it to the waiting D-Bus callers.
+ */
+static void
+nhm_main_finish_sweep(void)
+{
+  guint           idx    = 0;
+  NhmCheckResult *result = g_slice_new(NhmCheckResult);
+
+  if(sweep_timer != 0)
+  {
+    nhm_main_remove_check_source(sweep_timer);
+    sweep_timer = 0;
+  }
+
+  for(idx = 0; (check_entries != NULL) && (idx < check_entries->len); idx++)
+  {
+    ((NhmCheckEntry*) g_ptr_array_index(check_entries, idx))->sweep = FALSE;
+  }
+
+  sweep_pending = 0;
+
+  result->event    = NHM_CHECK_EVENT_REPORT;
+  result->type     = NHM_CHECK_FILE;
+  result->name     = NULL;
+  result->reason   = NULL;
+  result->interval = 0;
+  result->report   = g_variant_ref_sink(nhm_main_build_health_report());
+
+  nhm_main_push_check_result(result);
+}
+
+
+/**
+ * nhm_main_build_health_report:
+ *
+ * Builds the health report from the status of all checks. The report is a
+ * dictionary ("a{sv}") with the entries:
+ * "Healthy" (b): %TRUE, if no check failed.
+ * "Failed" (u): Amount of failed checks.
+ * "Timestamp" (x): Real time in us, when the report was built.
+ * "Checks" (a{sa{sv}}): Status of every check by the name of the checked
+ * object ("monitored_progs" for the programs). Each check has the entries
+ * "Type" (s), "Status" (s: "ok", "failed", "running" or "unknown"),
+ * "Duration" (u: ms of the last execution), "LastChange" (x: real time in us
+ * of the last status change), "Interval" (u: effective interval in s) and,
+ * if the check failed, "Reason" (s). For the programs, "MissingPrograms"
+ * (as) names all programs that are not running.
+ *
+ * Return value: Floating reference to the report.
+ */
+static GVariant*
+nhm_main_build_health_report(void)
+{
+  GVariantBuilder  report;
+  GVariantBuilder  checks;
+  GVariantBuilder  check;
+  guint            idx    = 0;
+  guint            failed = 0;
+  const gchar     *type   = NULL;
+  const gchar     *status = NULL;
+  NhmCheckEntry   *entry  = NULL;
+
+  g_variant_builder_init(&checks, G_VARIANT_TYPE("a{sa{sv}}"));
+
+  for(idx = 0; (check_entries != NULL) && (idx < check_entries->len); idx++)
+  {
+    entry = (NhmCheckEntry*) g_ptr_array_index(check_entries, idx);
+
+    switch(entry->type)
+    {
+      case NHM_CHECK_FILE: type = "file"; break;
+      case NHM_CHECK_PROG: type = "prog"; break;
+      case NHM_CHECK_PROC: type = "proc"; break;
+      default:             type = "dbus"; break;
+    }
+
+    if(entry->changed == 0)
+    {
+      status = (entry->running == TRUE) ? "running" : "unknown";
+    }
+    else
+    {
+      status = (entry->failed == TRUE) ? "failed" : "ok";
+    }
+
+    g_variant_builder_init(&check, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&check, "{sv}", "Type",       g_variant_new_string(type));
+    g_variant_builder_add(&check, "{sv}", "Status",     g_variant_new_string(status));
+    g_variant_builder_add(&check, "{sv}", "Duration",   g_variant_new_uint32((guint32) (entry->duration / 1000)));
+    g_variant_builder_add(&check, "{sv}", "LastChange", g_variant_new_int64(entry->changed));
+    g_variant_builder_add(&check, "{sv}", "Interval",   g_variant_new_uint32(entry->cur_interval));
+
+    if(entry->failed == TRUE)
+    {
+      failed++;
+      g_variant_builder_add(&check, "{sv}", "Reason", g_variant_new_string(entry->reason));
+
+      if((entry->missing != NULL) && (entry->missing->len != 0))
+      {
+        g_variant_builder_add(&check,
+                              "{sv}",
+                              "MissingPrograms",
+                              g_variant_new_strv((const gchar* const*) entry->missing->pdata,
+                                                 (gssize) entry->missing->len));
+      }
+    }
+
+    g_variant_builder_add(&checks, "{s@a{sv}}", entry->name, g_variant_builder_end(&check));
+  }
+
+  g_variant_builder_init(&report, G_VARIANT_TYPE("a{sv}"));
+  g_variant_builder_add(&report, "{sv}", "Healthy",   g_variant_new_boolean(failed == 0));
+  g_variant_builder_add(&report, "{sv}", "Failed",    g_variant_new_uint32(failed));
+  g_variant_builder_add(&report, "{sv}", "Timestamp", g_variant_new_int64(g_get_real_time()));
+  g_variant_builder_add(&report, "{sv}", "Checks",    g_variant_builder_end(&checks));
+
+  return g_variant_builder_end(&report);
+}
+
+
+/**
+ * nhm_main_add_check_source:
+ * @source:    New source, e.g. a timeout or a watch.
+ * @func:      Callback of the source.
+ * @user_data: Data passed to the callback.
+ *
+ * Attaches a source of a check to the context of the check worker. If there
+ * is no worker, the source is attached to the default context.
+ *
+ * Return value: ID of the source in the check context.
+ */
+static guint
+nhm_main_add_check_source(GSource     *source,
+                          GSourceFunc  func,
+                          gpointer     user_data)
+{
+  guint source_id = 0;
+
+  g_source_set_callback(source, func, user_data, NULL);
+  source_id = g_source_attach(source, check_context);
+  g_source_unref(source);
+
+  return source_id;
+}
+
+
+/**
+ * nhm_main_remove_check_source:
+ * @source_id: ID of a source, added by 'nhm_main_add_check_source'.
+ *
+ * Removes a source of a check from the context of the check worker.
+ */
+static void
+nhm_main_remove_check_source(guint source_id)
+{
+  GSource *source = g_main_context_find_source_by_id(check_context, source_id);
+
+  if(source != NULL)
+  {
+    g_source_destroy(source);
+  }
+}
+
+
+/**
+ * nhm_main_post_check_result:
+ * @type:   Kind of the check that failed.
+ * @name:   Name of the checked file, program, proc. or bus.
+ * @reason: Static description of the failure.
+ *
+ * Called by the checks to report a failure. The failure is counted, so that
+ * the checks fall back to their fast cadence, and posted to the main loop.
+ * All checked names are configured. Interning them bounds the quark table by
+ * the configuration and spares a copy per result passed between the threads.
+ */
+static void
+nhm_main_post_check_result(NhmCheckType  type,
+                           const gchar  *name,
+                           const gchar  *reason)
+{
+  NhmCheckResult *result = g_slice_new(NhmCheckResult);
+
+  result->event    = NHM_CHECK_EVENT_FAILED;
+  result->type     = type;
+  result->name     = g_intern_string(name);
+  result->reason   = reason;
+  result->interval = 0;
+  result->report   = NULL;
+
+  g_atomic_int_inc(&check_failures);
+  nhm_main_push_check_result(result);
+}
+
+
+/**
+ * nhm_main_post_check_interval:
+ * @entry: Schedule of a check, whose effective interval changed.
+ *
+ * Posts the effective interval of a check to the main loop, which exports it.
+ */
+static void
+nhm_main_post_check_interval(NhmCheckEntry *entry)
+{
+  NhmCheckResult *result = g_slice_new(NhmCheckResult);
+
+  result->event    = NHM_CHECK_EVENT_INTERVAL;
+  result->type     = entry->type;
+  result->name     = entry->name;
+  result->reason   = NULL;
+  result->interval = entry->cur_interval;
+  result->report   = NULL;
+
+  nhm_main_push_check_result(result);
+}
+
+
+/**
+ * nhm_main_push_check_result:
+ * @result: Result to be processed by the main loop.
+ *
+ * The result is pushed to the lock-free list 'check_results'. If the list
+ * was empty, the main loop is told to process it. The checks never wait for
+ * the main loop.
+ */
+static void
+nhm_main_push_check_result(NhmCheckResult *result)
+{
+  do
+  {
+    result->next = (NhmCheckResult*) g_atomic_pointer_get(&check_results);
+  }
+  while(g_atomic_pointer_compare_and_exchange(&check_results,
+                                              result->next,
+                                              result) == FALSE);
+
+  /* Only the first result after the list was taken needs to wake up */
+  if(result->next == NULL)
+  {
+    (void) g_idle_add(&nhm_main_check_results_cb, NULL);
+  }
+}
+
+
+/**
+ * nhm_main_check_results_cb:
+ * @user_data: Optional user data (not used).
+ *
+ * Called in the main loop to take all results that have been posted by the
+ * checks. The failures are traced in the order in which they were posted.
+ * The effective intervals of the checks are stored in 'check_intervals'.
+ * A health report is returned to all D-Bus callers that wait for it.
+ *
+ * Return value: Always %FALSE to remove the idle source.
+ */
+static gboolean
+nhm_main_check_results_cb(gpointer user_data)
+{
+  NhmCheckResult *results = NULL;
+  NhmCheckResult *result  = NULL;
+  NhmCheckResult *ordered = NULL;
+  const gchar    *label   = NULL;
+
+  /* Take the whole list. The checks continue with an empty one. */
+  do
+  {
+    results = (NhmCheckResult*) g_atomic_pointer_get(&check_results);
+  }
+  while(g_atomic_pointer_compare_and_exchange(&check_results,
+                                              results,
+                                              NULL) == FALSE);
+
+  /* The newest result is first. Reverse list to process the oldest first. */
+  while(results != NULL)
+  {
+    result       = results;
+    results      = result->next;
+    result->next = ordered;
+    ordered      = result;
+  }
+
+  while(ordered != NULL)
+  {
+    result  = ordered;
+    ordered = result->next;
+
+    if(result->event == NHM_CHECK_EVENT_INTERVAL)
+    {
+      if(check_intervals == NULL)
+      {
+        check_intervals = g_hash_table_new(&g_str_hash, &g_str_equal);
+      }
+
+      g_hash_table_insert(check_intervals,
+                          (gpointer) result->name,
+                          GUINT_TO_POINTER(result->interval));
+
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_DEBUG,
+              DLT_STRING("NHM: Check interval changed.");
+              DLT_STRING("Check name:"); DLT_STRING(result->name);
+              DLT_STRING("Interval:");   DLT_UINT(result->interval));
+    }
+    else if(result->event == NHM_CHECK_EVENT_REPORT)
+    {
+      while(   (sweep_invocations                     != NULL )
+            && (g_queue_is_empty(sweep_invocations)   == FALSE))
+      {
+        nhm_dbus_info_complete_get_health_report(dbus_nhm_info_obj,
+                                                 (GDBusMethodInvocation*)
+                                                 g_queue_pop_head(sweep_invocations),
+                                                 result->report);
+      }
+
+      g_variant_unref(result->report);
+    }
+    else
+    {
+      switch(result->type)
+      {
+        case NHM_CHECK_FILE: label = "File name:"; break;
+        case NHM_CHECK_PROG: label = "Prog name:"; break;
+        case NHM_CHECK_PROC: label = "Proc name:"; break;
+        default:             label = "Bus name:";  break;
+      }
+
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_INFO,
+              DLT_STRING("NHM: Userland check failed.");
+              DLT_STRING(result->reason);
+              DLT_STRING(label); DLT_STRING(result->name));
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_INFO,
+              DLT_STRING("NHM: Userland check failed. Restarting system."));
+    }
+
+    g_slice_free(NhmCheckResult, result);
+  }
+
+  return FALSE;
+}
+
+
+/**
+ * nhm_main_install_checks:
+ *
+ * Prepares the checks and schedules them in the timer wheel of the check
+ * context.
+ */
+static void
+nhm_main_install_checks(void)
+{
+  nhm_main_prepare_checks();
+  nhm_main_schedule_checks();
+}
+
+
+/**
+ * nhm_main_check_worker:
+ * @user_data: Optional user data (not used).
+ *
+ * Thread function of the check worker. The check context is made the default
+ * of the thread, so that file monitors and asynchronous D-Bus calls of the
+ * checks also are dispatched in it. All objects of the checks are created
+ * and destroyed by this thread.
+ *
+ * Return value: Always %NULL.
+ */
+static gpointer
+nhm_main_check_worker(gpointer user_data)
+{
+  g_main_context_push_thread_default(check_context);
+
+  nhm_main_install_checks();
+  g_main_loop_run(check_loop);
+  nhm_main_free_check_objects();
+
+  g_main_context_pop_thread_default(check_context);
+
+  return NULL;
+}
+
+
+/**
+ * nhm_main_quit_check_worker_cb:
+ * @user_data: Optional user data (not used).
+ *
+ * Invoked in the check context to quit the loop of the check worker. Because
+ * the callback is dispatched by the loop, a quit that has been requested
+ * while the worker still installed the checks is not lost.
+ *
+ * Return value: Always %FALSE to remove the source.
+ */
+static gboolean
+nhm_main_quit_check_worker_cb(gpointer user_data)
+{
+  g_main_loop_quit(check_loop);
+
+  return FALSE;
+}
+
+
+/**
+ * nhm_main_start_check_worker:
+ *
+ * Starts the thread that runs the userland checks in its own main context,
+ * so that they never delay the D-Bus handling and the watchdog of the main
+ * loop. If the thread can not be started, the checks run in the main loop.
+ */
+static void
+nhm_main_start_check_worker(void)
+{
+  check_context = g_main_context_new();
+  check_loop    = g_main_loop_new(check_context, FALSE);
+
+#if GLIB_CHECK_VERSION(2,32,0)
+  check_thread = g_thread_new("nhm-checks", &nhm_main_check_worker, NULL);
+#else
+  /* Threads already have been initialized by 'g_type_init' */
+  check_thread = g_thread_create(&nhm_main_check_worker, NULL, TRUE, NULL);
+#endif
+
+  if(check_thread == NULL)
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: Failed to start check worker."));
+
+    g_main_loop_unref(check_loop);
+    check_loop = NULL;
+    g_main_context_unref(check_context);
+    check_context = NULL;
+
+    nhm_main_install_checks();
+  }
+}
+
+
+/**
+ * nhm_main_stop_check_worker:
+ *
+ * Stops the thread of the userland checks and waits until it destroyed the
+ * objects of the checks. Failures that have not been processed yet by the
+ * main loop are traced now.
+ */
+static void
+nhm_main_stop_check_worker(void)
+{
+  if(check_thread != NULL)
+  {
+    g_main_context_invoke(check_context, &nhm_main_quit_check_worker_cb, NULL);
+    (void) g_thread_join(check_thread);
+    check_thread = NULL;
+
+    g_main_loop_unref(check_loop);
+    check_loop = NULL;
+    g_main_context_unref(check_context);
+    check_context = NULL;
+  }
+
+  (void) nhm_main_check_results_cb(NULL);
+}
+
+
+/**
+ * nhm_main_lc_request_cb:
+ * @object:        NSM LifecycleConsumer object
+ * @invocation:    Invocation object of dbus
+ * @shutdown_type: Type of the shut down (NSM_SHUTDOWN_TYPE_*)
+ * @request_id:    ID of shut down request. Used for async. completion call
+ * @user_data:     Optionally user data
+ *
+ * The function is a dbus callback, called by the NSM to shut down the system.
+ * Because NHM usually is the last 'shutdown client', write the shut down flag.
+ * Changes of the LC data, whose writing has been delayed, are written now.
+ *
+ * Return value: Always %TRUE to inform dbus that call has been processed.
+ */
+static gboolean
+nhm_main_lc_request_cb(NsmDbusLcConsumer     *object,
+                       GDBusMethodInvocation *invocation,
+                       const guint            shutdown_type,
+                       const guint            request_id,
+                       gpointer               user_data)
+{
+  NsmErrorStatus_e error = NsmErrorStatus_NotSet;
+
+  if(shutdown_type != NSM_SHUTDOWNTYPE_RUNUP)
+  {
+    nhm_main_flush_data();
+
+    error =   (nhm_main_write_shutdown_flag(NHM_NODESTATE_SHUTDOWN) == TRUE)
+            ? NsmErrorStatus_Ok : NsmErrorStatus_Error;
+  }
+  else
+  {
+    error =   (nhm_main_write_shutdown_flag(NHM_NODESTATE_STARTED) == TRUE)
+            ? NsmErrorStatus_Ok : NsmErrorStatus_Error;
+  }
+
+  /* Inform NSM that shut down request was successfully processed */
+  nsm_dbus_lc_consumer_complete_lifecycle_request(object,
+                                                  invocation,
+                                                  (gint) error);
+
+  return TRUE;
+}
+
+
+/**
+ * nhm_main_bus_acquired_cb:
+ * @connection: Connection, which was acquired
+ * @bus_name:   Bus name
+ * @user_data:  Optionally user data
+ *
+ * The function is called when a connection to the D-Bus could be established.
+ */
+static void
+nhm_main_bus_acquired_cb(GDBusConnection *connection,
+                         const gchar     *bus_name,
+                         gpointer         user_data)
+{
+  GError    *error   = NULL;
+  NhmLcInfo *lc_info = NULL;
+
+  /* "Protect" NHM from exit when conn. fails. Important to monitor dbus */
+  g_dbus_connection_set_exit_on_close(connection, FALSE);
+
+  /* The first array element always has to be the current LC. Create it! */
+  nodeinfo            = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  current_failed_apps = g_hash_table_new(&g_str_hash, &g_str_equal);
+
+  /* Load shutdown flag. Indicates if last LC was regular shut down */
+  lc_info = nhm_main_new_lc_info(nhm_main_read_shutdown_flag());
+  g_ptr_array_add(nodeinfo, (gpointer) lc_info);
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_INFO,
+          DLT_STRING("NHM: Previous shutdown was");
+          DLT_STRING(  (lc_info->start_state == NHM_NODESTATE_SHUTDOWN)
+                      ? "complete" : "incomplete"));
+
+  /* Read data of prev. LCs. They are added to 'nodeinfo' after current LC */
+  nhm_main_read_data();
+
+  /* The window of LCs changed. Statistics are calculated on next request. */
+  nhm_main_reset_lc_stats();
+
+  /* Create skeleton object, register signals and export interfaces */
+  dbus_nhm_info_obj = nhm_dbus_info_skeleton_new();
+
+  (void) g_signal_connect(dbus_nhm_info_obj,
+                          "handle-register-app-status",
+                          G_CALLBACK(nhm_main_register_app_status_cb),
+                          NULL);
+
+  (void) g_signal_connect(dbus_nhm_info_obj,
+                          "handle-register-app-status-batch",
+                          G_CALLBACK(nhm_main_register_batch_cb),
+                          NULL);
+
+  (void) g_signal_connect(dbus_nhm_info_obj,
+                          "handle-read-statistics",
+                          G_CALLBACK(nhm_main_read_statistics_cb),
+                          NULL);
+
+  (void) g_signal_connect(dbus_nhm_info_obj,
+                          "handle-read-all-statistics",
+                          G_CALLBACK(nhm_main_read_all_statistics_cb),
+                          NULL);
+
+  (void) g_signal_connect(dbus_nhm_info_obj,
+                          "handle-get-health-report",
+                          G_CALLBACK(nhm_main_get_health_report_cb),
+                          NULL);
+
+  (void) g_signal_connect(dbus_nhm_info_obj,
+                          "handle-read-check-intervals",
+                          G_CALLBACK(nhm_main_read_check_intervals_cb),
+                          NULL);
+
+  (void) g_signal_connect(dbus_nhm_info_obj,
+                          "handle-request-node-restart",
+                          G_CALLBACK(nhm_main_request_node_restart_cb),
+                          NULL);
+
+  (void) g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(dbus_nhm_info_obj),
+                                          connection,
+                                          NHM_INFO_OBJECT,
+                                          &error);
+  if(error != NULL)
+  {
+    /* Critical error: The interface could not be exported. Stop the NHM. */
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_ERROR,
+            DLT_STRING("NHM: Bus acquired actions failed.");
+            DLT_STRING("Error: Could not export D-Bus object.");
+            DLT_STRING("Reason:"); DLT_STRING(error->message));
+    g_error_free(error);
+
+    mainreturn = EXIT_FAILURE;
+    g_main_loop_quit(mainloop);
+  }
+}
+
+
+/**
+ * nhm_main_name_acquired_cb:
+ * @connection: Connection over which the bus name was acquired
+ * @app_name:   Acquired bus name
+ * @user_data:  Optionally user data
+ *
+ * The function is called when the "bus name" could be acquired on the D-Bus.
+ */
+static void
+nhm_main_name_acquired_cb(GDBusConnection *connection,
+                          const gchar     *app_name,
+                          gpointer         user_data)
+{
+  /* The NHM is now completely functional. Reset the shutdown flag */
+  (void) nhm_main_write_shutdown_flag(NHM_NODESTATE_STARTED);
+
+  /* If a user land check is configured, start the check worker */
+  if(ul_chk_interval != 0)
+  {
+    nhm_main_start_check_worker();
+  }
+
+  /* Inform systemd that we started up and start timer for systemd WDOG */
+  (void) sd_notify (0, "READY=1");
+  nhm_main_start_wdog();
+
+  /* Write initial state of current LC and last prev. LCs (after READY) */
+  nhm_main_write_data();
+
+  /* Start systemd observation. Initial unit states arrive asynchronously */
+  if(nhm_systemd_connect(&nhm_main_register_app_status) == FALSE)
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: Systemd observation could not be started."));
+  }
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_INFO,
+          DLT_STRING("NHM: Successfully obtained D-Bus name."));
+}
+
+
+/**
+ * nhm_main_name_lost_cb:
+ * @connection:      Connection. If it is NULL, no D-Bus connection could be
+ *                   established. Otherwise the bus name was lost.
+ * @param app_name:  Bus name
+ * @param user_data: Optionally user data
+ *
+ * The function is called if either no connection to D-Bus could be established
+ * or the bus name could not be acquired.
+ */
+static void
+nhm_main_name_lost_cb(GDBusConnection *connection,
+                      const gchar     *app_name,
+                      gpointer         user_data)
+{
+  /* If the connection pointer is NULL connection has been lost */
+  if(connection == NULL)
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_ERROR,
+            DLT_STRING("NHM: D-Bus connection failed."));
+  }
+  else
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_ERROR,
+            DLT_STRING("NHM: D-Bus name not obtained or lost."));
+  }
+
+  mainreturn = EXIT_FAILURE;
+  g_main_loop_quit(mainloop); /* Cancel loop in all cases */
+}
+
+
+/**
+ * nhm_main_convert_version_string:
+ * @version_string: String containing the package version. The @version_string
+ *                  can consist of up to four positive numbers <= 255, seperated
+ *                  by dots (e.g. "1.21.3.4").
+ *
+ * The function will convert a version string (four positive numbers <= 255,
+ * seperated by dots) to a 32 Bit value.
+ *
+ * Return value: Numeric value representing the version number.
+ */
+static guint32
+nhm_main_convert_version_string(const gchar *version_string)
+{
+  gchar** version_split = NULL;
+  guint   version_idx   = 0;
+  guint32 version       = 0;
+
+ version_split = g_strsplit(version_string, ".", 4);
+
+ for(version_idx = 0; version_idx < g_strv_length(version_split); version_idx++)
+ {
+   version |= (strtol(version_split[version_idx], NULL, 10)
+               << (24 -(8 * version_idx)));
+ }
+
+ g_strfreev(version_split);
+
+ return version;
+}
+
+
+/**
+ * nhm_main_write_data:
+ *
+ * The function writes the information about the life cycles to a file in a
+ * binary format. The content of the file is structured as follows:
+ *
+ * Header ('NhmLcDataHeader'):
+ * Magic  | Format | Ver.   | # of LCs | Generation
+ * 4 Byte | 4 Byte | 4 Byte | 4 Byte   | 4 Byte
+ *
+ * Index ('NhmLcDataIndex'), one entry per LC:
+ * state  | # of apps | block offset | block size
+ * 4 Byte | 4 Byte    | 4 Byte       | 4 Byte
+ *
+ * Blocks, one per LC:
+ * Entries ('NhmLcDataApp'), one per app. | String table
+ * name offset | app fails               | app name\0 app name\0 ...
+ * 4 Byte      | 4 Byte                  |
+ *
+ * The header and the index allow to read the file without decoding the apps.
+ * The blocks are self contained (name offsets are relative to the block).
+ * Therefore, blocks of LCs that have not been decoded since the file was read
+ * are copied unchanged.
+ *
+ * The file is a snapshot of the LC data. It is replaced atomically and a new,
+ * empty journal is started for it (see 'nhm_main_write_journal'). All changes
+ * are contained in the snapshot. Pending delayed writes are cancelled.
+ */
+static void
+nhm_main_write_data(void)
+{
+  GByteArray      *data         = NULL;
+  GByteArray      *strings      = NULL;
+  GError          *error        = NULL;
+  guint            lc_idx       = 0;
+  NhmLcInfo       *lc_info      = NULL;
+  GHashTableIter   app_iter;
+  NhmFailedApp    *app_info     = NULL;
+  NhmLcDataHeader  header;
+  NhmLcDataIndex   index;
+  NhmLcDataApp     app_entry;
+  gint64           start_time   = 0;
+
+  /* The file will be up to date. Cancel a delayed write */
+  if(lc_data_timer != 0)
+  {
+    g_source_remove(lc_data_timer);
+    lc_data_timer = 0;
+  }
+
+  if(lc_data_dirty_apps != NULL)
+  {
+    g_hash_table_remove_all(lc_data_dirty_apps);
+  }
+
+  lc_data_stats.coalesced += (lc_data_changes > 1) ? (lc_data_changes - 1) : 0;
+  lc_data_changes          = 0;
+
+  start_time = g_get_monotonic_time();
+  data       = g_byte_array_new();
+  strings    = g_byte_array_new();
+
+  /* Store header (# of LCs required by config. or at least what we have) */
+  header.magic       = NHM_LC_DATA_MAGIC;
+  header.format      = NHM_LC_DATA_FORMAT;
+  header.nhm_version = nhm_main_convert_version_string(VERSION);
+  header.lc_count    = MIN(nodeinfo->len, max_lc_count);
+  header.generation  = MAX(lc_data_generation + 1, 1);
+  g_byte_array_append(data, (guint8*) &header, sizeof(header));
+
+  /* Reserve the index. It is filled, when the blocks have been written. */
+  g_byte_array_set_size(data, sizeof(header) + (header.lc_count * sizeof(index)));
+
+  for(lc_idx = 0; lc_idx < header.lc_count; lc_idx++)
+  {
+    lc_info = (NhmLcInfo*) g_ptr_array_index(nodeinfo, lc_idx);
+
+    index.start_state  = lc_info->start_state;
+    index.block_offset = data->len;
+
+    if(lc_info->failed_apps == NULL)
+    {
+      /* LC has not been decoded. Copy its block from the old file. */
+      index.app_count = lc_info->app_count;
+      g_byte_array_append(data, (guint8*) lc_info->block, lc_info->block_size);
+    }
+    else
+    {
+      /* Store an entry for every app. Names are stored behind the entries */
+      index.app_count = g_hash_table_size(lc_info->failed_apps);
+      g_byte_array_set_size(strings, 0);
+
+      g_hash_table_iter_init(&app_iter, lc_info->failed_apps);
+      while(g_hash_table_iter_next(&app_iter, NULL, (gpointer*) &app_info) == TRUE)
+      {
+        app_entry.name_offset = (index.app_count * sizeof(app_entry)) + strings->len;
+        app_entry.failcount   = app_info->failcount;
+        g_byte_array_append(data, (guint8*) &app_entry, sizeof(app_entry));
+        g_byte_array_append(strings,
+                            (guint8*) app_info->name,
+                            strlen(app_info->name) + 1);
+      }
+
+      g_byte_array_append(data, strings->data, strings->len);
+    }
+
+    index.block_size = data->len - index.block_offset;
+    memcpy(data->data + sizeof(header) + (lc_idx * sizeof(index)),
+           &index,
+           sizeof(index));
+  }
+
+  g_byte_array_unref(strings);
+
+  /* Replace file atomically. Old file and journal survive a failed write. */
+  if(g_file_set_contents(NHM_LC_DATA_FILE,
+                         (const gchar*) data->data,
+                         (gssize) data->len,
+                         &error) == TRUE)
+  {
+    lc_data_generation = header.generation;
+    nhm_main_open_journal();
+
+    lc_data_stats.snapshots++;
+    nhm_main_update_data_stats(data->len, start_time);
+  }
+  else
+  {
+    /* Journal belongs to the old file. Changes will create a new file. */
+    nhm_main_close_journal();
+
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_ERROR,
+            DLT_STRING("NHM: Write LcData failed.");
+            DLT_STRING("Error: Failed to write file.");
+            DLT_STRING("File:");   DLT_STRING(NHM_LC_DATA_FILE);
+            DLT_STRING("Reason:"); DLT_STRING(error->message));
+    g_error_free(error);
+  }
+
+  g_byte_array_unref(data);
+}
+
+
+/**
+ * nhm_main_write_journal:
+ *
+ * The function stores the changed fail counts of the current LC. For every
+ * app., whose fail count increased since the last write, one fixed size
+ * record is appended to the journal:
+ *
+ * Magic  | fail count | app name                        | CRC-32
+ * 4 Byte | 4 Byte     | 'NHM_JOURNAL_NAME_SIZE' Byte    | 4 Byte
+ *
+ * The journal starts with a header ('NhmJournalHeader'), which binds it to
+ * the generation of the current LC data file. A torn write only damages the
+ * last record. If there is no journal, or a record can not be written, the
+ * whole LC data is written instead (see 'nhm_main_write_data').
+ */
+static void
+nhm_main_write_journal(void)
+{
+  GHashTableIter    app_iter;
+  const gchar      *app_name   = NULL;
+  NhmLcInfo        *lc_info    = NULL;
+  NhmFailedApp     *app_info   = NULL;
+  NhmJournalRecord  record;
+  gboolean          write_all  = FALSE;
+  guint             bytes      = 0;
+  gint64            start_time = 0;
+
+  /* The journal will be up to date. Cancel a delayed write */
+  if(lc_data_timer != 0)
+  {
+    g_source_remove(lc_data_timer);
+    lc_data_timer = 0;
+  }
+
+  start_time = g_get_monotonic_time();
+  lc_info    = (NhmLcInfo*) g_ptr_array_index(nodeinfo, 0);
+  write_all  = (lc_journal == NULL);
+
+  /* The current LC only is stored if at least one LC is stored */
+  if((max_lc_count != 0) && (lc_data_dirty_apps != NULL))
+  {
+    g_hash_table_iter_init(&app_iter, lc_data_dirty_apps);
+
+    while(   (write_all == FALSE)
+          && (g_hash_table_iter_next(&app_iter, (gpointer*) &app_name, NULL) == TRUE))
+    {
+      app_info = nhm_main_find_failed_app(lc_info, app_name);
+
+      if((app_info != NULL) && (strlen(app_name) < NHM_JOURNAL_NAME_SIZE))
+      {
+        memset(&record, 0, sizeof(record));
+        record.magic     = NHM_JOURNAL_RECORD_MAGIC;
+        record.failcount = app_info->failcount;
+        strcpy(record.name, app_name);
+        record.crc       = nhm_helper_crc32(&record,
+                                            sizeof(record) - sizeof(record.crc));
+
+        if(fwrite((void*) &record, sizeof(record), 1, lc_journal) == 1)
+        {
+          lc_data_stats.records++;
+          bytes += sizeof(record);
+        }
+        else
+        {
+          write_all = TRUE;
+        }
+      }
+      else
+      {
+        /* App. can not be journaled (name too long). Write all data. */
+        write_all = (app_info != NULL);
+      }
+    }
+
+    write_all = (write_all == TRUE) || (fflush(lc_journal) != 0);
+  }
+
+  if(write_all == FALSE)
+  {
+    if(lc_data_dirty_apps != NULL)
+    {
+      g_hash_table_remove_all(lc_data_dirty_apps);
+    }
+
+    lc_data_stats.coalesced += (lc_data_changes > 1) ? (lc_data_changes - 1) : 0;
+    lc_data_changes          = 0;
+
+    nhm_main_update_data_stats(bytes, start_time);
+  }
+  else
+  {
+    nhm_main_write_data();
+  }
+}
+
+
+/**
+ * nhm_main_open_journal:
+ *
+ * The function starts a new journal for the LC data file that just has been
+ * written ('lc_data_generation'). If the journal can not be created, the
+ * changes will be stored by writing the whole LC data.
+ */
+static void
+nhm_main_open_journal(void)
+{
+  NhmJournalHeader header;
+
+  nhm_main_close_journal();
+
+  header.magic      = NHM_JOURNAL_HEADER_MAGIC;
+  header.generation = lc_data_generation;
+  header.crc        = nhm_helper_crc32(&header,
+                                       sizeof(header) - sizeof(header.crc));
+
+  lc_journal = fopen(NHM_LC_JOURNAL_FILE, "w");
+
+  if(lc_journal != NULL)
+  {
+    if(   (fwrite((void*) &header, sizeof(header), 1, lc_journal) != 1)
+       || (fflush(lc_journal)                                     != 0))
+    {
+      nhm_main_close_journal();
+    }
+  }
+
+  if(lc_journal == NULL)
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: Failed to create LcData journal.");
+            DLT_STRING("File:"); DLT_STRING(NHM_LC_JOURNAL_FILE));
+  }
+}
+
+
+/**
+ * nhm_main_close_journal:
+ *
+ * The function closes the journal, if it is open.
+ */
+static void
+nhm_main_close_journal(void)
+{
+  if(lc_journal != NULL)
+  {
+    fclose(lc_journal);
+    lc_journal = NULL;
+  }
+}
+
+
+/**
+ * nhm_main_update_data_stats:
+ * @bytes:      Amount of bytes that have been written.
+ * @start_time: Monotonic time (in us) when the write started.
+ *
+ * The function updates and traces the accounting for writing the LC data.
+ */
+static void
+nhm_main_update_data_stats(guint  bytes,
+                           gint64 start_time)
+{
+  gint64 write_time = g_get_monotonic_time() - start_time;
+
+  lc_data_stats.flushes++;
+  lc_data_stats.bytes    += bytes;
+  lc_data_stats.max_time  = MAX(lc_data_stats.max_time, write_time);
+
+  DLT_LOG(nhm_helper_trace_ctx,
+          DLT_LOG_DEBUG,
+          DLT_STRING("NHM: Wrote LcData.");
+          DLT_STRING("Bytes:");         DLT_UINT(bytes);
+          DLT_STRING("Time (us):");     DLT_UINT((guint) write_time);
+          DLT_STRING("Writes:");        DLT_UINT(lc_data_stats.flushes);
+          DLT_STRING("Coalesced:");     DLT_UINT(lc_data_stats.coalesced);
+          DLT_STRING("Snapshots:");     DLT_UINT(lc_data_stats.snapshots);
+          DLT_STRING("Records:");       DLT_UINT(lc_data_stats.records);
+          DLT_STRING("Total bytes:");   DLT_UINT(lc_data_stats.bytes);
+          DLT_STRING("Max time (us):"); DLT_UINT((guint) lc_data_stats.max_time));
+}
+
+
+/**
+ * nhm_main_mark_data_dirty:
+ *
+ * The function is called when the LC data changed. If no write delay is
+ * configured, the changes are written immediately. Otherwise, a timer is
+ * started (if not already running) and all changes until it elapses are
+ * written at once, to reduce the number of writes to the flash in case of
+ * failure storms.
+ */
+static void
+nhm_main_mark_data_dirty(void)
+{
+  lc_data_changes++;
+
+  if(lc_data_write_delay == 0)
+  {
+    nhm_main_write_journal();
+  }
+  else if(lc_data_timer == 0)
+  {
+    lc_data_timer = g_timeout_add(lc_data_write_delay,
+                                  &nhm_main_timer_write_data_cb,
+                                  NULL);
+  }
+  else
+  {
+    /* Timer already running. Change will be written when it elapses. */
+  }
+}
+
+
+/**
+ * nhm_main_flush_data:
+ *
+ * The function writes the changes of the LC data, if there are changes that
+ * have not been written yet. Used on shut down, to not loose delayed changes.
+ */
+static void
+nhm_main_flush_data(void)
+{
+  if(lc_data_changes != 0)
+  {
+    nhm_main_write_journal();
+  }
+}
+
+
+/**
+ * nhm_main_timer_write_data_cb:
+ * @user_data: Optional user data (not used)
+ *
+ * Called when the write delay elapsed. Writes the changes of the LC data.
+ *
+ * Return value: Always %FALSE. The timer is restarted on the next change.
+ */
+static gboolean
+nhm_main_timer_write_data_cb(gpointer user_data)
+{
+  lc_data_timer = 0;
+  nhm_main_flush_data();
+
+  return FALSE;
+}
+
+
+/**
+ * nhm_main_read_data:
  *
- * The function is called if either no connection to D-Bus could be established
- * or the bus name could not be acquired.
+ * The function reads the information about the previous life cycles from the
+ * LC data file. For the structure of the file see 'nhm_main_write_data'. The
+ * file is mapped and only its index is read (see 'nhm_main_read_data_v2').
+ * Files of the former format are read completely ('nhm_main_read_data_v1').
+ * Afterwards, the journal is applied to the first read LC (see
+ * 'nhm_main_read_journal').
  */
 static void
-nhm_main_name_lost_cb(GDBusConnection *connection,
-                      const gchar     *app_name,
-                      gpointer         user_data)
+nhm_main_read_data(void)
 {
-  /* If the connection pointer is NULL connection has been lost */
-  if(connection == NULL)
+  GMappedFile     *map        = NULL;
+  GError          *error      = NULL;
+  const gchar     *data       = NULL;
+  gsize            data_len   = 0;
+  NhmLcDataHeader  header;
+  NhmLcInfo       *journal_lc = NULL;
+
+  map = g_mapped_file_new(NHM_LC_DATA_FILE, FALSE, &error);
+
+  if(map != NULL)
   {
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_ERROR,
-            DLT_STRING("NHM: D-Bus connection failed."));
+    data     = g_mapped_file_get_contents(map);
+    data_len = g_mapped_file_get_length(map);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(&header, data, MIN(data_len, sizeof(header)));
+
+    if(   (header.magic  == NHM_LC_DATA_MAGIC )
+       && (header.format == NHM_LC_DATA_FORMAT))
+    {
+      journal_lc         = nhm_main_read_data_v2(map);
+      lc_data_generation = header.generation;
+    }
+    else
+    {
+      /* Files of the former format have no generation and no journal */
+      journal_lc         = nhm_main_read_data_v1(data, data_len);
+      lc_data_generation = 0;
+    }
+
+    if((journal_lc != NULL) && (lc_data_generation != 0))
+    {
+      nhm_main_read_journal(journal_lc, lc_data_generation);
+    }
+
+    /* LCs that are not decoded yet keep their own reference */
+    g_mapped_file_unref(map);
   }
   else
   {
     DLT_LOG(nhm_helper_trace_ctx,
             DLT_LOG_ERROR,
-            DLT_STRING("NHM: D-Bus name not obtained or lost."));
+            DLT_STRING("NHM: Read LcData failed.");
+            DLT_STRING("Error: Failed to open file.");
+            DLT_STRING("File:");   DLT_STRING(NHM_LC_DATA_FILE);
+            DLT_STRING("Reason:"); DLT_STRING(error->message));
+    g_error_free(error);
   }
-
-  mainreturn = EXIT_FAILURE;
-  g_main_loop_quit(mainloop); /* Cancel loop in all cases */
 }
 
 
 /**
- * nhm_main_convert_version_string:
- * @version_string: String containing the package version. The @version_string
- *                  can consist of up to four positive numbers <= 255, seperated
- *                  by dots (e.g. "1.21.3.4").
+ * nhm_main_read_data_v2:
+ * @map: Mapped LC data file.
  *
- * The function will convert a version string (four positive numbers <= 255,
- * seperated by dots) to a 32 Bit value.
+ * The function reads the index of the LC data file and adds a LC to 'nodeinfo'
+ * for every valid index entry. The apps. of the LCs are not decoded. The LCs
+ * reference their blocks in @map. Reading stops at the first invalid entry.
  *
- * Return value: Numeric value representing the version number.
+ * Return value: First read LC or %NULL, if no LC has been read.
  */
-static guint32
-nhm_main_convert_version_string(const gchar *version_string)
+static NhmLcInfo*
+nhm_main_read_data_v2(GMappedFile *map)
 {
-  gchar** version_split = NULL;
-  guint   version_idx   = 0;
-  guint32 version       = 0;
+  const gchar     *data         = g_mapped_file_get_contents(map);
+  gsize            data_len     = g_mapped_file_get_length(map);
+  NhmLcDataHeader  header;
+  NhmLcDataIndex   index;
+  NhmLcInfo       *lc_info      = NULL;
+  NhmLcInfo       *first_lc     = NULL;
+  guint            lc_idx       = 0;
+  guint            lc_list_size = 0;
+  gboolean         valid        = FALSE;
+
+  memcpy(&header, data, sizeof(header));
+
+  /* Load configured amount or at least the stored ones */
+  lc_list_size = MIN(header.lc_count, max_lc_count);
+  valid        = TRUE;
+
+  for(lc_idx = 0; (lc_idx < lc_list_size) && (valid == TRUE); lc_idx++)
+  {
+    /* The index entry has to be in the file */
+    valid = ((sizeof(header) + ((lc_idx + 1) * sizeof(index))) <= data_len);
 
- version_split = g_strsplit(version_string, ".", 4);
+    if(valid == TRUE)
+    {
+      memcpy(&index,
+             data + sizeof(header) + (lc_idx * sizeof(index)),
+             sizeof(index));
+
+      /* The block has to be in the file and has to hold the app. entries */
+      valid =    (index.block_offset <= data_len)
+              && (index.block_size   <= (data_len - index.block_offset))
+              && (index.app_count    <= (index.block_size / sizeof(NhmLcDataApp)));
+    }
 
- for(version_idx = 0; version_idx < g_strv_length(version_split); version_idx++)
- {
-   version |= (strtol(version_split[version_idx], NULL, 10)
-               << (24 -(8 * version_idx)));
- }
+    if(valid == TRUE)
+    {
+      lc_info = nhm_main_new_mapped_lc_info((NhmNodeState) index.start_state,
+                                            map,
+                                            &index);
+      g_ptr_array_add(nodeinfo, lc_info);
 
- g_strfreev(version_split);
+      first_lc = (first_lc == NULL) ? lc_info : first_lc;
+    }
+  }
 
- return version;
+  if(valid == FALSE)
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: LcData index invalid. Stopped reading.");
+            DLT_STRING("File:"); DLT_STRING(NHM_LC_DATA_FILE);
+            DLT_STRING("LC:");   DLT_UINT(lc_idx));
+  }
+
+  return first_lc;
 }
 
 
 /**
- * nhm_main_write_data:
+ * nhm_main_read_data_v1:
+ * @data:     Content of the LC data file.
+ * @data_len: Length of @data in bytes.
  *
- * The function writes the information about the previous life cycles to a
- * file in a binary format. The content of the file is structured as follows:
+ * The function reads LC data files, which have been written by former versions
+ * of the NHM. The content of these files is structured as follows:
  *
  * Ver.   | # of Lc | state  | # of apps | # app chars | app name    | app fails
  * 4 Byte | 4 Byte  | 4 Byte | 4 Byte    | 4 Byte      | # app chars | 4 Byte
@@ -1452,152 +5556,186 @@ nhm_main_convert_version_string(const gchar *version_string)
  *                                                                  ...
  *                  | state  | # of apps | # app chars | app name    | app fails
  *                  | 4 Byte | 4 Byte    | 4 Byte      | # app chars | 4 Byte
- *                                       | # app chars | app name    | app fails
- *                                       | 4 Byte      | # app chars | 4 Byte
  *                                                                  ...
  *
- * At the start of the file, the version of the NHM is stored. The version is
- * followed by the number of stored life cycles. For each life cycle, the first
- * information is the shutdown state. After that, the number of failed apps. in
- * the life cycle is stored. For each failed app., the app. name is stored
- * (str. length and string) and the fail count.
+ * All LCs are decoded and added to 'nodeinfo'. Reading stops at the first
+ * incomplete entry. The file is written in the current format, when the NHM
+ * stores its LC data the next time.
+ *
+ * Return value: First read LC or %NULL, if no LC has been read.
  */
-static void
-nhm_main_write_data(void)
+static NhmLcInfo*
+nhm_main_read_data_v1(const gchar *data,
+                      gsize        data_len)
 {
-  FILE         *file          = NULL;
+  gsize         offset        = 0;
+  gboolean      valid         = FALSE;
   guint         lc_idx        = 0;
-  NhmLcInfo    *lc_info       = NULL;
-  GSList       *app_list      = NULL;
-  NhmFailedApp *app_info      = NULL;
+  NhmLcInfo    *lc_Info       = NULL;
+  NhmLcInfo    *first_lc      = NULL;
+  gchar        *app_name      = NULL;
+  guint         app_failcount = 0;
   guint         lc_list_size  = 0;
+  guint         lc_state      = 0;
+  guint         app_idx       = 0;
   guint         app_list_size = 0;
   guint         app_name_len  = 0;
   guint         nhm_version   = 0;
 
-  file = fopen(NHM_LC_DATA_FILE, "w"); /* Open file to store data */
+  /* Read NHM version and # of LCs. Load configured or stored amount */
+  valid =    (nhm_main_read_uint(data, data_len, &offset, &nhm_version)  == TRUE)
+          && (nhm_main_read_uint(data, data_len, &offset, &lc_list_size) == TRUE);
 
-  if(file != NULL)
-  {
-    /* Store the NHM version */
-    nhm_version = nhm_main_convert_version_string(VERSION);
-    fwrite((void*) &nhm_version, sizeof(nhm_version), 1, file);
+  lc_list_size = MIN(lc_list_size, max_lc_count);
 
-    /* Store # of LCs (amount required by config. or at least what we have) */
-    lc_list_size = MIN(nodeinfo->len, max_lc_count);
-    fwrite((void*) &lc_list_size, sizeof(lc_list_size), 1, file);
+  for(lc_idx = 0; (lc_idx < lc_list_size) && (valid == TRUE); lc_idx++)
+  {
+    /* Read the LCs 'shutdown' flag and the number of stored apps. */
+    valid =    (nhm_main_read_uint(data, data_len, &offset, &lc_state)      == TRUE)
+            && (nhm_main_read_uint(data, data_len, &offset, &app_list_size) == TRUE);
 
-    for(lc_idx = 0; lc_idx < lc_list_size; lc_idx++)
+    if(valid == TRUE)
     {
-      /* For every LC, store it's info. Start with the 'shutdown state'. */
-      lc_info = (NhmLcInfo*) g_ptr_array_index(nodeinfo, lc_idx);
-      fwrite((void*) &(lc_info->start_state), sizeof(lc_info->start_state), 1, file);
+      /* Create a new LC and store it in the array. */
+      lc_Info = nhm_main_new_lc_info((NhmNodeState) lc_state);
+      g_ptr_array_add(nodeinfo, lc_Info);
 
-      /* Store the number of failed apps. that occured in this life cycle */
-      app_list      = lc_info->failed_apps;
-      app_list_size = (app_list != NULL) ? g_slist_length(app_list) : 0;
-      fwrite((void*) &app_list_size, sizeof(app_list_size), 1, file);
+      first_lc = (first_lc == NULL) ? lc_Info : first_lc;
+    }
+
+    for(app_idx = 0; (app_idx < app_list_size) && (valid == TRUE); app_idx++)
+    {
+      /* Read the app. name (length and string) and the apps. fail count */
+      valid =    (nhm_main_read_uint(data, data_len, &offset, &app_name_len) == TRUE)
+              && (app_name_len <= (data_len - offset));
 
-      for(app_list = lc_info->failed_apps; app_list != NULL; app_list = g_slist_next(app_list))
+      if(valid == TRUE)
       {
-        /* For every app store app. name (length and string) and fail count */
-        app_info     = (NhmFailedApp*) app_list->data;
-        app_name_len = strlen((char*) app_info->name) + 1;
-        fwrite((void*) &app_name_len, sizeof(app_name_len), 1, file);
-        fwrite((void*) app_info->name, app_name_len, 1, file);
-        fwrite((void*) &(app_info->failcount), sizeof(app_info->failcount), 1, file);
+        app_name = g_strndup(data + offset, app_name_len);
+        offset  += app_name_len;
+
+        valid = nhm_main_read_uint(data, data_len, &offset, &app_failcount);
+
+        if(valid == TRUE)
+        {
+          /* Add the app. to the table of the LC. It copies the name. */
+          (void) nhm_main_add_failed_app(lc_Info, app_name, app_failcount);
+        }
+
+        g_free(app_name);
       }
     }
+  }
+
+  if(valid == FALSE)
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_WARN,
+            DLT_STRING("NHM: LcData incomplete. Stopped reading.");
+            DLT_STRING("File:");   DLT_STRING(NHM_LC_DATA_FILE);
+            DLT_STRING("Offset:"); DLT_UINT((guint) offset));
+  }
+
+  return first_lc;
+}
+
+
+/**
+ * nhm_main_read_uint:
+ * @data:     Buffer to read from
+ * @data_len: Length of @data in bytes
+ * @offset:   Read position. Is advanced, if the value could be read.
+ * @value:    Returns the read value
+ *
+ * The function reads an unsigned value from the LC data buffer.
+ *
+ * Return value: %TRUE:  The value has been read.
+ *               %FALSE: Not enough data left in the buffer.
+ */
+static gboolean
+nhm_main_read_uint(const gchar *data,
+                   gsize        data_len,
+                   gsize       *offset,
+                   guint       *value)
+{
+  gboolean retval = FALSE;
 
-    fclose(file); /* close the file */
+  if((data_len - *offset) >= sizeof(*value))
+  {
+    memcpy(value, data + *offset, sizeof(*value));
+    *offset += sizeof(*value);
+    retval   = TRUE;
   }
   else
   {
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_ERROR,
-            DLT_STRING("NHM: Write LcData failed.");
-            DLT_STRING("Error: Failed to open file.");
-            DLT_STRING("File:"); DLT_STRING(NHM_LC_DATA_FILE));
+    retval = FALSE;
   }
+
+  return retval;
 }
 
 
 /**
- * nhm_main_read_data:
+ * nhm_main_read_journal:
+ * @lc_info:    LC to which the journal is applied.
+ * @generation: Generation of the LC data file that has been read.
  *
- * The function reads the information about the previous life cycles from a
- * binary file. For the structure of the file see 'nhm_main_write_data'.
- * For each LC a 'NhmLcInfo' structure is allocated. For every app. in each
- * life cycle, a 'NHM__tstAppInfo' structure and storage to store the app.
- * name are allocated. Remember to free this memory!
+ * The function applies the records of the journal to the LC that was the
+ * current LC, when the LC data file was written. The journal is ignored if it
+ * belongs to another generation of the LC data file. Reading stops at the
+ * first incomplete or corrupt record. For the structure of the journal see
+ * 'nhm_main_write_journal'.
  */
 static void
-nhm_main_read_data(void)
+nhm_main_read_journal(NhmLcInfo *lc_info,
+                      guint32    generation)
 {
-  FILE         *file          = NULL;
-  guint         lc_idx        = 0;
-  NhmLcInfo    *lc_Info       = NULL;
-  GSList       *app_list      = NULL;
-  NhmFailedApp *app_info      = NULL;
-  guint         lc_list_size  = 0;
-  guint         app_idx       = 0;
-  guint         app_list_size = 0;
-  guint         app_name_len  = 0;
-  guint         nhm_version   = 0;
+  FILE             *file    = NULL;
+  NhmJournalHeader  header;
+  NhmJournalRecord  record;
+  gboolean          valid   = FALSE;
+  guint             records = 0;
 
-  file = fopen(NHM_LC_DATA_FILE, "r"); /* Open file to read data */
+  file = fopen(NHM_LC_JOURNAL_FILE, "r");
 
   if(file != NULL)
   {
-    /* Read NHM version */
-    fread(&nhm_version, 4, 1, file);
-
-    /* Read # of LCs. Load configured amount or at least the stored ones */
-    fread((void*) &lc_list_size, sizeof(lc_list_size), 1, file);
-    lc_list_size = MIN(lc_list_size, max_lc_count);
-
-    for(lc_idx = 0; lc_idx < lc_list_size; lc_idx++)
+    /* Check that the journal belongs to the LC data file */
+    valid =    (fread((void*) &header, sizeof(header), 1, file) == 1)
+            && (header.magic      == NHM_JOURNAL_HEADER_MAGIC)
+            && (header.crc        == nhm_helper_crc32(&header,
+                                                      sizeof(header) - sizeof(header.crc)))
+            && (header.generation == generation);
+
+    if(valid == FALSE)
     {
-      /* Create a new LC. Read its 'shutdown' flag */
-      lc_Info = g_new(NhmLcInfo, 1);
-      fread((void*) &(lc_Info->start_state), sizeof(lc_Info->start_state), 1, file);
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_WARN,
+              DLT_STRING("NHM: LcData journal does not match LcData. Ignored.");
+              DLT_STRING("File:"); DLT_STRING(NHM_LC_JOURNAL_FILE));
+    }
 
-      /* Create a new app. list for the LC. Read number of stored apps. */
-      app_list = NULL;
-      fread((void*) &app_list_size, sizeof(app_list_size), 1, file);
+    while(   (valid == TRUE)
+          && (fread((void*) &record, sizeof(record), 1, file) == 1))
+    {
+      valid =    (record.magic == NHM_JOURNAL_RECORD_MAGIC)
+              && (record.crc   == nhm_helper_crc32(&record,
+                                                   sizeof(record) - sizeof(record.crc)));
 
-      for(app_idx = 0; app_idx < app_list_size; app_idx++)
+      if(valid == TRUE)
       {
-        /* For each stored app. Create a new app. info */
-        app_info = g_new(NhmFailedApp, 1);
-
-        /* Read the app. name length, allocate storage for string and read it */
-        fread((void*) &app_name_len, sizeof(app_name_len), 1, file);
-
-        app_info->name = g_new(gchar, app_name_len);
-        fread((void*) app_info->name, app_name_len, 1, file);
-
-        /* Read the apps. fail count */
-        fread((void*) &(app_info->failcount), sizeof(app_info->failcount), 1, file);
-
-        /* Append the new app. info to the app. list */
-        app_list = g_slist_append(app_list, app_info);
+        record.name[NHM_JOURNAL_NAME_SIZE - 1] = '\0';
+        (void) nhm_main_add_failed_app(lc_info, record.name, record.failcount);
+        records++;
       }
-
-      /* Assign the recently read app. list to LC and store new LC in array. */
-      lc_Info->failed_apps = app_list;
-      g_ptr_array_add(nodeinfo, lc_Info);
     }
 
-    fclose(file); /* Close the file */
-  }
-  else
-  {
+    fclose(file);
+
     DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_ERROR,
-            DLT_STRING("NHM: Read LcData failed.");
-            DLT_STRING("Error: Failed to open file.");
-            DLT_STRING("File:"); DLT_STRING(NHM_LC_DATA_FILE));
+            DLT_LOG_INFO,
+            DLT_STRING("NHM: Applied LcData journal.");
+            DLT_STRING("Records:"); DLT_UINT(records));
   }
 }
 
@@ -1835,6 +5973,9 @@ nhm_main_load_config(void)
   gchar *def_monitored_progs[] = {"", NULL};
   gchar *def_monitored_procs[] = {"", NULL};
   gchar *def_monitored_dbus[]  = {"", NULL};
+  gchar *def_include_units[]   = {"", NULL};
+  gchar *def_exclude_units[]   = {"", NULL};
+  gchar *def_unit_types[]      = {"service", NULL};
 
   /* Open the key file */
   file = g_key_file_new();
@@ -1856,10 +5997,79 @@ nhm_main_load_config(void)
                                                         "node",
                                                         "no_restart_apps",
                                                         def_no_restart_apps);
+    max_nsm_calls   = nhm_main_config_load_uint        (file,
+                                                        "node",
+                                                        "max_nsm_calls",
+                                                        NHM_NSM_CALLS_DEFAULT);
+    nsm_call_timeout =
+                      nhm_main_config_load_uint        (file,
+                                                        "node",
+                                                        "nsm_call_timeout",
+                                                        0);
+    lc_data_write_delay =
+                      nhm_main_config_load_uint        (file,
+                                                        "node",
+                                                        "lc_data_write_delay",
+                                                        0);
     ul_chk_interval = nhm_main_config_load_uint        (file,
                                                         "userland",
                                                         "ul_chk_interval",
                                                         0);
+    ul_chk_jitter   = nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "ul_chk_jitter",
+                                                        0);
+    ul_chk_backoff_max =
+                      nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "ul_chk_backoff_max",
+                                                        0);
+    file_chk_interval =
+                      nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "file_chk_interval",
+                                                        0);
+    prog_chk_interval =
+                      nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "prog_chk_interval",
+                                                        0);
+    proc_chk_interval =
+                      nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "proc_chk_interval",
+                                                        0);
+    dbus_chk_interval =
+                      nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "dbus_chk_interval",
+                                                        0);
+    max_proc_checks = nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "max_proc_checks",
+                                                        NHM_PROC_CHECKS_DEFAULT);
+    proc_check_timeout =
+                      nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "proc_check_timeout",
+                                                        NHM_PROC_CHECK_TIMEOUT_DEFAULT);
+    dbus_probe_timeout =
+                      nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "dbus_probe_timeout",
+                                                        0);
+    dbus_max_rtt    = nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "dbus_max_rtt",
+                                                        0);
+    watch_progs     = nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "watch_progs",
+                                                        0) != 0;
+    proc_events     = nhm_main_config_load_uint        (file,
+                                                        "userland",
+                                                        "proc_events",
+                                                        0) != 0;
     monitored_files = nhm_main_config_load_string_array(file,
                                                         "userland",
                                                         "monitored_files",
@@ -1876,17 +6086,47 @@ nhm_main_load_config(void)
                                                         "userland",
                                                         "monitored_dbus",
                                                         def_monitored_dbus);
+    include_units   = nhm_main_config_load_string_array(file,
+                                                        "systemd",
+                                                        "include_units",
+                                                        def_include_units);
+    exclude_units   = nhm_main_config_load_string_array(file,
+                                                        "systemd",
+                                                        "exclude_units",
+                                                        def_exclude_units);
+    unit_types      = nhm_main_config_load_string_array(file,
+                                                        "systemd",
+                                                        "unit_types",
+                                                        def_unit_types);
   }
   else
   {
     /* Error. Key file could not be opened. Use default values for settings. */
-    max_lc_count    = 0;
-    max_failed_apps = 0;
-    no_restart_apps = NULL;
-    ul_chk_interval = 0;
-    monitored_files = NULL;
-    monitored_progs = NULL;
-    monitored_procs = NULL;
+    max_lc_count        = 0;
+    max_failed_apps     = 0;
+    no_restart_apps     = NULL;
+    max_nsm_calls       = NHM_NSM_CALLS_DEFAULT;
+    nsm_call_timeout    = 0;
+    lc_data_write_delay = 0;
+    ul_chk_interval     = 0;
+    ul_chk_jitter       = 0;
+    ul_chk_backoff_max  = 0;
+    file_chk_interval   = 0;
+    prog_chk_interval   = 0;
+    proc_chk_interval   = 0;
+    dbus_chk_interval   = 0;
+    max_proc_checks     = NHM_PROC_CHECKS_DEFAULT;
+    proc_check_timeout  = NHM_PROC_CHECK_TIMEOUT_DEFAULT;
+    dbus_probe_timeout  = 0;
+    dbus_max_rtt        = 0;
+    watch_progs         = FALSE;
+    proc_events         = FALSE;
+    monitored_files     = NULL;
+    monitored_progs     = NULL;
+    monitored_procs     = NULL;
+    include_units       = NULL;
+    exclude_units       = NULL;
+    unit_types          = NULL;
 
     DLT_LOG(nhm_helper_trace_ctx,
             DLT_LOG_ERROR,
@@ -1920,13 +6160,24 @@ nhm_main_prepare_checks(void)
 
     for(bus_idx = 0; bus_idx < g_strv_length(monitored_dbus); bus_idx++)
     {
-      checked_dbus = g_new(NhmCheckedDbus, 1);
+      checked_dbus = g_new0(NhmCheckedDbus, 1);
       checked_dbus->bus_addr = g_strdup(monitored_dbus[bus_idx]);
-      checked_dbus->bus_conn = NULL;
 
       g_ptr_array_add(checked_dbusses, (gpointer) checked_dbus);
     }
   }
+
+  /* Watch the monitored files, to notice their deletion immediately */
+  if(monitored_files != NULL)
+  {
+    nhm_main_watch_files();
+  }
+
+  /* Keep an index of the processes of the monitored programs, if enabled */
+  if((proc_events == TRUE) && (monitored_progs != NULL))
+  {
+    (void) nhm_main_proc_events_connect();
+  }
 }
 
 /**
@@ -1987,6 +6238,11 @@ nhm_main_connect_to_nsm(void)
     if(error == NULL)
     {
       retval = TRUE;
+
+      /* Configured timeout for calls to NSM. Use D-Bus default for 0. */
+      g_dbus_proxy_set_default_timeout(G_DBUS_PROXY(dbus_lc_control_obj),
+                                       (nsm_call_timeout != 0)
+                                       ? (gint) nsm_call_timeout : -1);
     }
     else
     {
@@ -2115,6 +6371,59 @@ nhm_main_connect_to_nsm(void)
 static void
 nhm_main_free_nhm_objects(void)
 {
+  GHashTableIter  iter;
+  NhmNsmCall     *nsm_call = NULL;
+
+  /* Cancel pending calls to NSM. The main loop stopped and won't finish them */
+  if(nsm_call_cancel != NULL)
+  {
+    g_cancellable_cancel(nsm_call_cancel);
+    g_object_unref(nsm_call_cancel);
+    nsm_call_cancel = NULL;
+  }
+
+  /* Free the app. states that have not been sent to the NSM */
+  if(nsm_call_queue != NULL)
+  {
+    while((nsm_call = (NhmNsmCall*) g_queue_pop_head(nsm_call_queue)) != NULL)
+    {
+      nhm_main_free_nsm_call(nsm_call);
+    }
+
+    g_queue_free(nsm_call_queue);
+    nsm_call_queue = NULL;
+  }
+
+  /* Free the app. states that are pending at the NSM */
+  if(nsm_call_apps != NULL)
+  {
+    g_hash_table_iter_init(&iter, nsm_call_apps);
+    while(g_hash_table_iter_next(&iter, NULL, (gpointer*) &nsm_call) == TRUE)
+    {
+      nhm_main_free_nsm_call(nsm_call);
+    }
+
+    g_hash_table_destroy(nsm_call_apps);
+    nsm_call_apps = NULL;
+  }
+
+  nsm_calls_pending = 0;
+
+  /* Stop delayed writing of LC data */
+  if(lc_data_timer != 0)
+  {
+    g_source_remove(lc_data_timer);
+    lc_data_timer = 0;
+  }
+
+  if(lc_data_dirty_apps != NULL)
+  {
+    g_hash_table_unref(lc_data_dirty_apps);
+    lc_data_dirty_apps = NULL;
+  }
+
+  nhm_main_close_journal();
+
   /* Free the skeleton object (if there was one) */
   if(dbus_nhm_info_obj != NULL)
   {
@@ -2122,11 +6431,31 @@ nhm_main_free_nhm_objects(void)
     dbus_nhm_info_obj = NULL;
   }
 
-  /* Free the list of currently failed apps */
-  g_slist_free_full(current_failed_apps, &nhm_main_free_current_failed_app);
-  current_failed_apps = NULL;
+  /* Free the set of currently failed apps */
+  if(current_failed_apps != NULL)
+  {
+    g_hash_table_unref(current_failed_apps);
+    current_failed_apps = NULL;
+  }
+
+  /* Calls still waiting for a health report are dropped */
+  if(sweep_invocations != NULL)
+  {
+    g_queue_foreach(sweep_invocations, (GFunc) &g_object_unref, NULL);
+    g_queue_free(sweep_invocations);
+    sweep_invocations = NULL;
+  }
+
+  /* Free the effective intervals of the userland checks */
+  if(check_intervals != NULL)
+  {
+    g_hash_table_unref(check_intervals);
+    check_intervals = NULL;
+  }
+
+  /* Free the statistics and the array of life cycle info */
+  nhm_main_reset_lc_stats();
 
-  /* Free the array of life cycle info */
   if(nodeinfo != NULL)
   {
     g_ptr_array_unref(nodeinfo);
@@ -2197,6 +6526,36 @@ nhm_main_free_config_objects(void)
 
   g_strfreev(monitored_dbus);
   monitored_dbus = NULL;
+
+  g_strfreev(include_units);
+  include_units = NULL;
+
+  g_strfreev(exclude_units);
+  exclude_units = NULL;
+
+  g_strfreev(unit_types);
+  unit_types = NULL;
+}
+
+
+/**
+ * nhm_main_free_check_entry:
+ * @entry: Pointer to 'NhmCheckEntry' object.
+ *
+ * Frees the memory occupied by a 'NhmCheckEntry' object. It is used as
+ * 'free func' for the array 'check_entries'.
+ */
+static void
+nhm_main_free_check_entry(gpointer entry)
+{
+  NhmCheckEntry *check_entry = (NhmCheckEntry*) entry;
+
+  if(check_entry->missing != NULL)
+  {
+    g_ptr_array_unref(check_entry->missing);
+  }
+
+  g_slice_free(NhmCheckEntry, check_entry);
 }
 
 
@@ -2208,10 +6567,80 @@ nhm_main_free_config_objects(void)
 static void
 nhm_main_free_check_objects(void)
 {
+  guint level = 0;
+  guint slot  = 0;
+
+  if(check_wheel_timer != 0)
+  {
+    nhm_main_remove_check_source(check_wheel_timer);
+    check_wheel_timer = 0;
+  }
+
+  for(level = 0; level < NHM_WHEEL_LEVELS; level++)
+  {
+    for(slot = 0; slot < NHM_WHEEL_SLOTS; slot++)
+    {
+      g_slist_free(check_wheel[level][slot]);
+      check_wheel[level][slot] = NULL;
+    }
+  }
+
+  if(sweep_timer != 0)
+  {
+    nhm_main_remove_check_source(sweep_timer);
+    sweep_timer = 0;
+  }
+
+  sweep_pending = 0;
+
+  if(check_entry_names != NULL)
+  {
+    g_hash_table_destroy(check_entry_names);
+    check_entry_names = NULL;
+  }
+
+  if(check_entries != NULL)
+  {
+    g_ptr_array_unref(check_entries);
+    check_entries = NULL;
+  }
+
+  check_wheel_now = 0;
+
   if(checked_dbusses != NULL)
   {
     g_ptr_array_unref(checked_dbusses);
+    checked_dbusses = NULL;
+  }
+
+  if(monitored_pids != NULL)
+  {
+    g_hash_table_destroy(monitored_pids);
+    monitored_pids = NULL;
   }
+
+  nhm_main_proc_events_disconnect();
+
+  if(proc_checks != NULL)
+  {
+    g_queue_free(proc_check_queue);
+    proc_check_queue = NULL;
+    g_hash_table_destroy(proc_checks);
+    proc_checks         = NULL;
+    proc_checks_running = 0;
+  }
+
+  if(watched_dirs != NULL)
+  {
+    g_hash_table_destroy(watched_dirs);
+    watched_dirs = NULL;
+  }
+
+  g_free(files_watched);
+  files_watched = NULL;
+
+  g_free(files_exist);
+  files_exist = NULL;
 }
 
 
@@ -2239,12 +6668,58 @@ nhm_main_init(void)
   current_failed_apps  = NULL;
   checked_dbusses      = NULL;
 
+  /* check worker */
+  check_context        = NULL;
+  check_loop           = NULL;
+  check_thread         = NULL;
+  check_results        = NULL;
+  check_failures       = 0;
+  check_apps_failed    = 0;
+  check_intervals      = NULL;
+  check_entry_names    = NULL;
+  sweep_pending        = 0;
+  sweep_timer          = 0;
+  sweep_invocations    = NULL;
+
+  /* forwarding of app. states to NSM */
+  nsm_call_queue       = NULL;
+  nsm_call_apps        = NULL;
+  nsm_call_cancel      = NULL;
+  nsm_calls_pending    = 0;
+  memset(&nsm_call_stats, 0, sizeof(nsm_call_stats));
+
+  /* rolling statistics */
+  memset(&lc_stats, 0, sizeof(lc_stats));
+
+  /* delayed writing of LC data */
+  lc_data_changes      = 0;
+  lc_data_timer        = 0;
+  lc_data_dirty_apps   = NULL;
+  lc_journal           = NULL;
+  lc_data_generation   = 0;
+  memset(&lc_data_stats, 0, sizeof(lc_data_stats));
+
   /* config stuff */
   max_lc_count         = 0;
   max_failed_apps      = 0;
   no_restart_apps      = NULL;
+  max_nsm_calls        = NHM_NSM_CALLS_DEFAULT;
+  nsm_call_timeout     = 0;
+  lc_data_write_delay  = 0;
 
   ul_chk_interval      = 0;
+  ul_chk_jitter        = 0;
+  ul_chk_backoff_max   = 0;
+  file_chk_interval    = 0;
+  prog_chk_interval    = 0;
+  proc_chk_interval    = 0;
+  dbus_chk_interval    = 0;
+  max_proc_checks      = NHM_PROC_CHECKS_DEFAULT;
+  proc_check_timeout   = NHM_PROC_CHECK_TIMEOUT_DEFAULT;
+  dbus_probe_timeout   = 0;
+  dbus_max_rtt         = 0;
+  watch_progs          = FALSE;
+  proc_events          = FALSE;
   monitored_files      = NULL;
   monitored_procs      = NULL;
   monitored_procs      = NULL;
@@ -2322,9 +6797,11 @@ main(void)
             DLT_STRING("Return:"); DLT_INT(pcl_ret));
   }
 
-  /* Load config and prepare checks. Default config used in case of errors */
+  /* Load config. Default config used in case of errors */
   nhm_main_load_config();
-  nhm_main_prepare_checks();
+
+  /* Compile the filter for the units observed via systemd (on main loop) */
+  nhm_systemd_set_unit_filter(include_units, exclude_units, unit_types);
 
   /* Connect to NSM, before offering services. Don't start if it doesn't work */
   if(nhm_main_connect_to_nsm() == TRUE)
@@ -2346,8 +6823,18 @@ main(void)
     /* Blocking function, returns in case of an error or if app. shuts down */
     g_main_loop_run(mainloop);
 
-    /* Disconnect from systemd observation */
+    /* Stop the userland checks. The worker destroys the check objects. */
+    nhm_main_stop_check_worker();
+
+    /* Write changes of LC data, whose writing still is delayed */
+    if(nodeinfo != NULL)
+    {
+      nhm_main_flush_data();
+    }
+
+    /* Disconnect from systemd observation and free the unit filter */
     nhm_systemd_disconnect();
+    nhm_systemd_free_unit_filter();
 
     /* Free objects created during main loop run */
     nhm_main_free_nhm_objects();
@@ -81,16 +81,18 @@ typedef enum
  * @name:         Name of the unit
  * @path:         Path to find unit on dbus
  * @active_state: Active state of the unit
- * @sig_sub_id:   Subscription ID for PropertiesChanged signal
+ * @refresh:      Cancellable of a pending 'GetAll' call for the unit. %NULL,
+ *                if no refresh of the unit's properties is in progress.
  *
- * The structure is used to create a list of observed units.
+ * The structure is used to create a list of observed units. Unit items are
+ * allocated from the slice allocator and own their name and path.
  */
 typedef struct
 {
   gchar          *name;
   gchar          *path;
   NhmActiveState  active_state;
-  guint           sig_sub_id;
+  GCancellable   *refresh;
 } NhmSystemdUnit;
 
 
@@ -187,16 +189,23 @@ nhm_systemd_active_state_map[NHM_ACTIVE_STATE_LAST][NHM_ACTIVE_STATE_LAST] =
 
 /* Helper functions */
 static NhmActiveState nhm_systemd_active_state_string_to_enum  (const gchar          *string);
+static gboolean       nhm_systemd_unit_is_observed             (const gchar          *name);
+static GPtrArray     *nhm_systemd_compile_patterns             (gchar               **patterns);
 static void           nhm_systemd_unit_active_state_changed    (NhmSystemdUnit       *unit,
                                                                 NhmActiveState        new_state);
-static gint           nhm_systemd_find_unit_by_name            (gconstpointer         u1,
-                                                                gconstpointer         u2);
+static NhmSystemdUnit *nhm_systemd_add_unit                    (const gchar          *name,
+                                                                const gchar          *path);
 static void           nhm_systemd_free_unit                    (gpointer              unit);
 
-static NhmActiveState nhm_systemd_unit_get_active_state        (NhmSystemdUnit       *unit);
+static void           nhm_systemd_unit_set_active_state        (NhmSystemdUnit       *unit,
+                                                                const gchar          *state);
+static void           nhm_systemd_unit_refresh                 (NhmSystemdUnit       *unit);
+static void           nhm_systemd_unit_refresh_cb              (GObject              *source,
+                                                                GAsyncResult         *result,
+                                                                gpointer              user_data);
 
 /* Signal registration functions */
-static guint          nhm_systemd_subscribe_properties_changed (const NhmSystemdUnit *unit);
+static guint          nhm_systemd_subscribe_properties_changed (void);
 
 /* Signal handler functions */
 static void           nhm_systemd_unit_active_state_changed    (NhmSystemdUnit       *unit,
@@ -230,6 +239,20 @@ static void           nhm_systemd_unit_properties_changed      (GDBusConnection
                                                                 GVariant             *parameters,
                                                                 gpointer              user_data);
 
+/* Startup functions */
+static void           nhm_systemd_startup_failed               (GError               *error,
+                                                                const gchar          *reason);
+static void           nhm_systemd_bus_get_cb                   (GObject              *source,
+                                                                GAsyncResult         *result,
+                                                                gpointer              user_data);
+static void           nhm_systemd_subscribe_cb                 (GObject              *source,
+                                                                GAsyncResult         *result,
+                                                                gpointer              user_data);
+static void           nhm_systemd_list_units                   (gboolean              by_patterns);
+static void           nhm_systemd_list_units_cb                (GObject              *source,
+                                                                GAsyncResult         *result,
+                                                                gpointer              user_data);
+
 
 /*******************************************************************************
 *
@@ -241,12 +264,25 @@ static void           nhm_systemd_unit_properties_changed      (GDBusConnection
 static NhmSystemdAppStatusCb  nhm_systemd_app_status_cb   = NULL;
 static GDBusConnection       *nhm_systemd_conn            = NULL;
 
-/* List of units known by us (based on NhmSystemdUnit) */
-static GSList                *nhm_systemd_observed_units  = NULL;
+/* Cancels the asynchronous startup, if observation is stopped before */
+static GCancellable          *nhm_systemd_startup         = NULL;
+
+/* Filter for observed units, compiled from the configuration */
+static GPtrArray             *nhm_systemd_include_units   = NULL;
+static GPtrArray             *nhm_systemd_exclude_units   = NULL;
+static gchar                **nhm_systemd_unit_suffixes   = NULL;
+static gchar                **nhm_systemd_list_patterns   = NULL;
+
+/* Units known by us (NhmSystemdUnit), hashed by their name */
+static GHashTable            *nhm_systemd_observed_units  = NULL;
+
+/* Units known by us, hashed by their object path for signal dispatch */
+static GHashTable            *nhm_systemd_units_by_path   = NULL;
 
 /* Signals registered at systemd */
 static guint                  nhm_systemd_unit_add_sig_id   = 0;
 static guint                  nhm_systemd_unit_rem_sig_id   = 0;
+static guint                  nhm_systemd_prop_sig_id       = 0;
 static gboolean               nhm_systemd_events_subscribed = FALSE;
 
 
@@ -309,15 +345,92 @@ nhm_systemd_active_state_string_to_enum(const gchar *string)
 }
 
 
+/**
+ * nhm_systemd_unit_is_observed:
+ * @name:   Name of a systemd unit
+ * @return: %TRUE, if the unit passes the configured filter.
+ *
+ * The function checks if a unit should be observed. The unit has to be of one
+ * of the configured types. If include patterns are configured, one of them has
+ * to match. Units that match an exclude pattern are never observed.
+ */
+static gboolean
+nhm_systemd_unit_is_observed(const gchar *name)
+{
+  gboolean retval = FALSE;
+  guint    idx    = 0;
+
+  for(idx = 0;
+      (nhm_systemd_unit_suffixes[idx] != NULL) && (retval == FALSE);
+      idx++)
+  {
+    retval = g_str_has_suffix(name, nhm_systemd_unit_suffixes[idx]);
+  }
+
+  if((retval == TRUE) && (nhm_systemd_include_units->len != 0))
+  {
+    retval = FALSE;
+
+    for(idx = 0;
+        (idx < nhm_systemd_include_units->len) && (retval == FALSE);
+        idx++)
+    {
+      retval =
+          g_pattern_match_string(g_ptr_array_index(nhm_systemd_include_units,
+                                                   idx),
+                                 name);
+    }
+  }
+
+  for(idx = 0;
+      (idx < nhm_systemd_exclude_units->len) && (retval == TRUE);
+      idx++)
+  {
+    retval =
+        (g_pattern_match_string(g_ptr_array_index(nhm_systemd_exclude_units,
+                                                  idx),
+                                name) == FALSE);
+  }
+
+  return retval;
+}
+
+
+/**
+ * nhm_systemd_compile_patterns:
+ * @patterns: NULL terminated array of glob patterns. May be %NULL.
+ * @return:   Array with a GPatternSpec for each pattern.
+ *
+ * The function compiles the passed glob patterns, so that they can be matched
+ * against unit names without parsing them again.
+ */
+static GPtrArray*
+nhm_systemd_compile_patterns(gchar **patterns)
+{
+  GPtrArray *retval = NULL;
+  guint      idx    = 0;
+
+  retval = g_ptr_array_new_with_free_func((GDestroyNotify) &g_pattern_spec_free);
+
+  for(idx = 0; (patterns != NULL) && (patterns[idx] != NULL); idx++)
+  {
+    g_ptr_array_add(retval, g_pattern_spec_new(patterns[idx]));
+  }
+
+  return retval;
+}
+
+
 /**
  * nhm_systemd_subscribe_properties_changed:
- * @unit:   Unit for which properties changed should be processed
  * @return: Subscription ID. Necessary to unsubscribe.
  *
- * The function registers for the PropertiesChanged signal of the passed unit.
+ * The function registers for the PropertiesChanged signal of all objects of
+ * systemd. A single match rule is used, independent of the number of units.
+ * The signals are dispatched to the units based on their object path.
  */
 static guint
-nhm_systemd_subscribe_properties_changed(const NhmSystemdUnit *unit)
+nhm_systemd_subscribe_properties_changed(void)
 {
   guint rval = 0;
 
@@ -326,29 +439,41 @@ nhm_systemd_subscribe_properties_changed(const NhmSystemdUnit *unit)
                                          NHM_SYSTEMD_BUS_NAME,
                                          NHM_SYSTEMD_PROP_IF,
                                          "PropertiesChanged",
-                                         unit->path,
+                                         NULL,
                                          NULL,
                                          G_DBUS_SIGNAL_FLAGS_NONE,
                                          &nhm_systemd_unit_properties_changed,
-                                         (gpointer) unit,
+                                         NULL,
                                          NULL);
   return rval;
 }
 
 
 /**
- * nhm_systemd_find_unit_by_name:
- * @u1:     Pointer to unit item from list.
- * @u2:     Pointer to searched unit item.
- * @return: 0, if unit names equal.
+ * nhm_systemd_add_unit:
+ * @name:   Name of the unit
+ * @path:   Path to find unit on dbus
+ * @return: Pointer to the new unit item. Its 'ActiveState' is unknown.
  *
- * The function is used by 'custom finds' to find a unit based on it name.
+ * The function creates a unit item and adds it to the table of observed units
+ * and to the signal dispatch table. An already observed unit with the same
+ * name is replaced.
  */
-static gint
-nhm_systemd_find_unit_by_name(gconstpointer u1, gconstpointer u2)
+static NhmSystemdUnit*
+nhm_systemd_add_unit(const gchar *name,
+                     const gchar *path)
 {
-  return g_strcmp0(((NhmSystemdUnit*) u1)->name,
-                   ((NhmSystemdUnit*) u2)->name);
+  NhmSystemdUnit *unit = g_slice_new(NhmSystemdUnit);
+
+  unit->name         = g_strdup(name);
+  unit->path         = g_strdup(path);
+  unit->active_state = NHM_ACTIVE_STATE_UNKNOWN;
+  unit->refresh      = NULL;
+
+  g_hash_table_replace(nhm_systemd_observed_units, unit->name, unit);
+  g_hash_table_replace(nhm_systemd_units_by_path, unit->path, unit);
+
+  return unit;
 }
 
 
@@ -357,19 +482,29 @@ nhm_systemd_find_unit_by_name(gconstpointer u1, gconstpointer u2)
  * @unit: Pointer to unit item.
  *
  * The function frees the memory occupied by a unit object and its members.
- * It also unregisters for the PropertiesChnaged signal of the unit.
+ * It also removes the unit from the signal dispatch table and cancels a
+ * pending refresh of the unit's properties.
  */
 static void
 nhm_systemd_free_unit(gpointer unit)
 {
   NhmSystemdUnit *u = (NhmSystemdUnit*) unit;
 
+  if(nhm_systemd_units_by_path != NULL)
+  {
+    g_hash_table_remove(nhm_systemd_units_by_path, u->path);
+  }
+
   g_free(u->name);
   g_free(u->path);
 
-  g_dbus_connection_signal_unsubscribe(nhm_systemd_conn, u->sig_sub_id);
+  if(u->refresh != NULL)
+  {
+    g_cancellable_cancel(u->refresh);
+    g_object_unref(u->refresh);
+  }
 
-  g_free(u);
+  g_slice_free(NhmSystemdUnit, u);
 }
 
 
@@ -398,54 +533,127 @@ nhm_systemd_unit_active_state_changed(NhmSystemdUnit *unit,
 
 
 /**
- * nhm_systemd_unit_get_active_state:
- * @unit:   Pointer to unit item, whose 'ActiveState' property should be read.
- * @return: ActiveState read from unit properties and converted to the
- *          equivalent enumeration.
+ * nhm_systemd_unit_set_active_state:
+ * @unit:  Pointer to unit item, whose 'ActiveState' has been reported.
+ * @state: 'ActiveState' string reported by systemd.
  *
- * The function is called to retrieve value of the 'ActiveState' property of a
- * unit.
+ * The function converts the reported 'ActiveState' and processes the
+ * transition, if the state of the unit changed.
  */
-static NhmActiveState
-nhm_systemd_unit_get_active_state(NhmSystemdUnit *unit)
+static void
+nhm_systemd_unit_set_active_state(NhmSystemdUnit *unit,
+                                  const gchar    *state)
+{
+  NhmActiveState active_state = NHM_ACTIVE_STATE_UNKNOWN;
+
+  active_state = nhm_systemd_active_state_string_to_enum(state);
+
+  if(active_state != unit->active_state)
+  {
+    nhm_systemd_unit_active_state_changed(unit, active_state);
+  }
+}
+
+
+/**
+ * nhm_systemd_unit_refresh:
+ * @unit: Pointer to unit item, whose properties should be read.
+ *
+ * The function is called to read the initial state of an added unit or, if
+ * systemd invalidated the 'ActiveState' of a unit without sending the new
+ * value. All properties of the unit are requested asynchronously with one
+ * 'GetAll' call. If a refresh for the unit already is
+ * in progress, no further call is made, because its reply will deliver the
+ * latest state.
+ */
+static void
+nhm_systemd_unit_refresh(NhmSystemdUnit *unit)
+{
+  if(unit->refresh == NULL)
+  {
+    unit->refresh = g_cancellable_new();
+
+    g_dbus_connection_call(nhm_systemd_conn,
+                           NHM_SYSTEMD_BUS_NAME,
+                           unit->path,
+                           NHM_SYSTEMD_PROP_IF,
+                           "GetAll",
+                           g_variant_new("(s)", NHM_SYSTEMD_UNIT_IF),
+                           (GVariantType*) "(a{sv})",
+                           G_DBUS_CALL_FLAGS_NONE,
+                           -1,
+                           unit->refresh,
+                           &nhm_systemd_unit_refresh_cb,
+                           unit);
+  }
+}
+
+
+/**
+ * nhm_systemd_unit_refresh_cb:
+ * @source:    Connection on which the 'GetAll' call has been made.
+ * @result:    Result of the asynchronous call.
+ * @user_data: Pointer to unit item, whose properties have been read.
+ *
+ * The function is called when the reply of the 'GetAll' call for a unit
+ * arrives. If the state of the unit still is unknown, the unit just has been
+ * added and the reported state is taken over without a transition, like for
+ * the units listed at startup. If the call has been cancelled, the unit
+ * already was destroyed and must not be accessed.
+ */
+static void
+nhm_systemd_unit_refresh_cb(GObject      *source,
+                            GAsyncResult *result,
+                            gpointer      user_data)
 {
+  NhmSystemdUnit *unit    = (NhmSystemdUnit*) user_data;
   GError         *error   = NULL;
   GVariant       *propval = NULL;
+  GVariant       *props   = NULL;
   const gchar    *state   = NULL;
-  NhmActiveState  retval  = NHM_ACTIVE_STATE_UNKNOWN;
-
-  propval = g_dbus_connection_call_sync(nhm_systemd_conn,
-                                        NHM_SYSTEMD_BUS_NAME,
-                                        unit->path,
-                                        NHM_SYSTEMD_PROP_IF,
-                                        "Get",
-                                        g_variant_new("(ss)",
-                                                      NHM_SYSTEMD_UNIT_IF,
-                                                      "ActiveState"),
-                                        (GVariantType*) "(v)",
-                                        G_DBUS_CALL_FLAGS_NONE,
-                                        -1,
-                                        NULL,
-                                        &error);
+
+  propval = g_dbus_connection_call_finish((GDBusConnection*) source,
+                                          result,
+                                          &error);
 
   if(error == NULL)
   {
-    g_variant_get_child(propval, 0, "&s", &state);
-    retval = nhm_systemd_active_state_string_to_enum(state);
+    g_object_unref(unit->refresh);
+    unit->refresh = NULL;
+
+    props = g_variant_get_child_value(propval, 0);
+
+    if(g_variant_lookup(props, "ActiveState", "&s", &state) == TRUE)
+    {
+      if(unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)
+      {
+        unit->active_state = nhm_systemd_active_state_string_to_enum(state);
+      }
+      else
+      {
+        nhm_systemd_unit_set_active_state(unit, state);
+      }
+    }
+
+    g_variant_unref(props);
     g_variant_unref(propval);
   }
   else
   {
-    retval = NHM_ACTIVE_STATE_UNKNOWN;
-    DLT_LOG(nhm_helper_trace_ctx,
-            DLT_LOG_ERROR,
-            DLT_STRING("NHM: Failed to get unit property 'ActiveState'.");
-            DLT_STRING("Error: D-Bus communication failed.");
-            DLT_STRING("Reason:"); DLT_STRING(error->message));
+    if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE)
+    {
+      g_object_unref(unit->refresh);
+      unit->refresh = NULL;
+
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_ERROR,
+              DLT_STRING("NHM: Failed to get unit property 'ActiveState'.");
+              DLT_STRING("Error: D-Bus communication failed.");
+              DLT_STRING("Reason:"); DLT_STRING(error->message));
+    }
+
     g_error_free(error);
   }
-
-  return retval;
 }
 
 
@@ -460,8 +668,8 @@ nhm_systemd_unit_get_active_state(NhmSystemdUnit *unit)
  * @user_data:      Optional user data (not used)
  *
  * Called when the "UnitAdded" signal from org.freedesktop.systemd1
- * arrives. The new unit will be added to the internal unit list and
- * its initial state will be retrieved.
+ * arrives. The new unit will be added to the internal unit table and
+ * its initial state will be requested asynchronously.
  */
 static void
 nhm_systemd_unit_added(GDBusConnection *connection,
@@ -474,32 +682,23 @@ nhm_systemd_unit_added(GDBusConnection *connection,
 {
   NhmSystemdUnit *unit       = NULL;
   const gchar    *param_type = NULL;
-  NhmSystemdUnit  search_unit;
-  GSList         *list_item  = NULL;
+  const gchar    *unit_name  = NULL;
+  const gchar    *unit_path  = NULL;
 
   param_type = g_variant_get_type_string(parameters);
 
   if(g_strcmp0(param_type, "(so)") == 0)
   {
-    g_variant_get_child(parameters, 0, "&s", &search_unit.name);
+    g_variant_get_child(parameters, 0, "&s", &unit_name);
 
-    if(g_str_has_suffix(search_unit.name, ".service") == TRUE)
+    if(nhm_systemd_unit_is_observed(unit_name) == TRUE)
     {
-      list_item = g_slist_find_custom(nhm_systemd_observed_units,
-                                      &search_unit,
-                                      &nhm_systemd_find_unit_by_name);
-      if(list_item == NULL)
+      if(g_hash_table_lookup(nhm_systemd_observed_units, unit_name) == NULL)
       {
-        unit = g_new(NhmSystemdUnit, 1);
-        unit->name = g_strdup(search_unit.name);
-
-        g_variant_get_child(parameters, 1, "s", &unit->path);
+        g_variant_get_child(parameters, 1, "&o", &unit_path);
 
-        unit->active_state = nhm_systemd_unit_get_active_state(unit);
-        unit->sig_sub_id   = nhm_systemd_subscribe_properties_changed(unit);
-
-        nhm_systemd_observed_units = g_slist_prepend(nhm_systemd_observed_units,
-                                                     unit);
+        unit = nhm_systemd_add_unit(unit_name, unit_path);
+        nhm_systemd_unit_refresh(unit);
 
         DLT_LOG(nhm_helper_trace_ctx,
                 DLT_LOG_INFO,
@@ -530,7 +729,7 @@ nhm_systemd_unit_added(GDBusConnection *connection,
  * @user_data:      Optional user data (not used)
  *
  * Called when the "UnitRemoved" signal from org.freedesktop.systemd1
- * arrives. The unit will be removed from the internal unit list.
+ * arrives. The unit will be removed from the internal unit table.
  */
 static void
 nhm_systemd_unit_removed(GDBusConnection *connection,
@@ -541,32 +740,24 @@ nhm_systemd_unit_removed(GDBusConnection *connection,
                          GVariant        *parameters,
                          gpointer         user_data)
 {
-  GSList         *list_item  = NULL;
-  const gchar    *param_type = NULL;
-  NhmSystemdUnit  search_unit;
+  const gchar *param_type = NULL;
+  const gchar *unit_name  = NULL;
 
   param_type = g_variant_get_type_string(parameters);
 
   if(g_strcmp0(param_type, "(so)") == 0)
   {
-    g_variant_get_child(parameters, 0, "&s", &search_unit.name);
+    g_variant_get_child(parameters, 0, "&s", &unit_name);
 
-    if(g_str_has_suffix(search_unit.name, ".service") == TRUE)
+    /* Only observed units are in the table. No need to filter again. */
+    if(g_hash_table_lookup(nhm_systemd_observed_units, unit_name) != NULL)
     {
-      list_item = g_slist_find_custom(nhm_systemd_observed_units,
-                                      &search_unit,
-                                      &nhm_systemd_find_unit_by_name);
-      if(list_item != NULL)
-      {
-        DLT_LOG(nhm_helper_trace_ctx,
-                DLT_LOG_INFO,
-                DLT_STRING("NHM: Systemd unit removed.");
-                DLT_STRING("Name:");   DLT_STRING(search_unit.name));
+      DLT_LOG(nhm_helper_trace_ctx,
+              DLT_LOG_INFO,
+              DLT_STRING("NHM: Systemd unit removed.");
+              DLT_STRING("Name:");   DLT_STRING(unit_name));
 
-        nhm_systemd_free_unit(list_item->data);
-        nhm_systemd_observed_units = g_slist_remove(nhm_systemd_observed_units,
-                                                    list_item->data);
-      }
+      g_hash_table_remove(nhm_systemd_observed_units, unit_name);
     }
   }
   else
@@ -588,12 +779,13 @@ nhm_systemd_unit_removed(GDBusConnection *connection,
  * @interface_name: Interface from where signal comes from.
  * @signal_name:    Name of the signal.
  * @parameters:     Parameters of dbus signal.
- * @user_data:      User data. Pointer to unit for which properties changed
- *                  signal had been registered.
+ * @user_data:      Optional user data (not used)
  *
  * Called when the "PropertiesChanged" signal from the "Properties" interface
- * of a systemd unit arrives. Depending on the changed property, the change
- * will be processed further in the related sub functions.
+ * of a systemd object arrives. Signals of objects, which are no observed
+ * units, are ignored. If the signal carries the new 'ActiveState', it
+ * is processed directly. If the 'ActiveState' only has been invalidated, the
+ * properties of the unit are refreshed asynchronously.
  */
 static void
 nhm_systemd_unit_properties_changed(GDBusConnection *connection,
@@ -604,27 +796,34 @@ nhm_systemd_unit_properties_changed(GDBusConnection *connection,
                                     GVariant        *parameters,
                                     gpointer         user_data)
 {
-  NhmSystemdUnit  *unit         = (NhmSystemdUnit*) user_data;
+  NhmSystemdUnit  *unit         = NULL;
+  GVariant        *chg_props    = NULL;
   const gchar    **inv_props    = NULL;
-  NhmActiveState   active_state = NHM_ACTIVE_STATE_UNKNOWN;
+  const gchar     *active_state = NULL;
   const gchar     *param_type   = NULL;
 
+  unit       = g_hash_table_lookup(nhm_systemd_units_by_path, object_path);
   param_type = g_variant_get_type_string(parameters);
 
-  if(g_strcmp0(param_type, "(sa{sv}as)") == 0)
+  if(unit == NULL)
+  {
+    /* Signal is not for an observed unit. Nothing to do. */
+  }
+  else if(g_strcmp0(param_type, "(sa{sv}as)") == 0)
   {
+    chg_props = g_variant_get_child_value(parameters, 1);
     g_variant_get_child(parameters, 2, "^a&s", &inv_props);
 
-    if(nhm_helper_str_in_strv("ActiveState", (gchar**) inv_props) == TRUE)
+    if(g_variant_lookup(chg_props, "ActiveState", "&s", &active_state) == TRUE)
     {
-      active_state = nhm_systemd_unit_get_active_state(unit);
-
-      if(active_state != unit->active_state)
-      {
-        nhm_systemd_unit_active_state_changed(unit, active_state);
-      }
+      nhm_systemd_unit_set_active_state(unit, active_state);
+    }
+    else if(nhm_helper_str_in_strv("ActiveState", (gchar**) inv_props) == TRUE)
+    {
+      nhm_systemd_unit_refresh(unit);
     }
 
+    g_variant_unref(chg_props);
     g_free(inv_props);
   }
   else
@@ -638,79 +837,59 @@ nhm_systemd_unit_properties_changed(GDBusConnection *connection,
 }
 
 
-/*******************************************************************************
-*
-* Interfaces. Exported functions. See Header for detailed description.
-*
-*******************************************************************************/
-
 /**
- * nhm_systemd_connect:
- * @app_status_cb: Callback that should be called, if the "ActiveState" of
- *                 a systemd Service changes between valid and invalid states.
+ * nhm_systemd_startup_failed:
+ * @error:  Error returned by an asynchronous step of the startup.
+ * @reason: Description of the step, which failed.
  *
- * The NHM main process can start the systemd observation whith this function.
+ * The function is called, if a step of the asynchronous startup failed. If
+ * the step has been cancelled, the observation already has been stopped and
+ * nothing else is done. Otherwise, the error is traced and everything created
+ * so far is destroyed.
  */
-gboolean
-nhm_systemd_connect(NhmSystemdAppStatusCb app_status_cb)
+static void
+nhm_systemd_startup_failed(GError      *error,
+                           const gchar *reason)
 {
-  GVariantIter    iter;
-  GError         *error          = NULL;
-  GVariant       *manager_return = NULL;
-  GVariant       *unit_array     = NULL;
-  GVariant       *unit           = NULL;
-  gboolean        retval         = FALSE;
-  gchar          *unit_name      = NULL;
-  const gchar    *active_state   = NULL;
-  NhmSystemdUnit *new_unit       = NULL;
-
-  /* Initialize local variables */
-  nhm_systemd_app_status_cb     = NULL;
-  nhm_systemd_conn              = NULL;
-  nhm_systemd_observed_units    = NULL;
-  nhm_systemd_events_subscribed = FALSE;
-  nhm_systemd_unit_add_sig_id   = 0;
-  nhm_systemd_unit_rem_sig_id   = 0;
-
-  /* Step 1: Save function to call if app status changes. */
-  if(app_status_cb != NULL)
-  {
-    retval = TRUE;
-    nhm_systemd_app_status_cb = app_status_cb;
-  }
-  else
+  if(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE)
   {
-    retval = FALSE;
     DLT_LOG(nhm_helper_trace_ctx,
             DLT_LOG_ERROR,
-            DLT_STRING("NHM: Failed to connect to systemd dbus.");
-            DLT_STRING("Error: Invalid callback passed."));
+            DLT_STRING(reason);
+            DLT_STRING("Error: D-Bus communication failed.");
+            DLT_STRING("Reason:"); DLT_STRING(error->message));
+
+    nhm_systemd_disconnect();
   }
 
-  /* Step 2: Connect to the system bus */
-  if(retval == TRUE)
-  {
-    nhm_systemd_conn = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &error);
+  g_error_free(error);
+}
 
-    if(error == NULL)
-    {
-      retval = TRUE;
-    }
-    else
-    {
-      retval = FALSE;
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_ERROR,
-              DLT_STRING("NHM: Failed to connect to systemd dbus.");
-              DLT_STRING("Error: D-Bus connection failed.");
-              DLT_STRING("Reason:"); DLT_STRING(error->message));
-      g_error_free(error);
-    }
-  }
 
-  /* Step 3: Register for signals, if units are removed/added */
-  if(retval == TRUE)
+/**
+ * nhm_systemd_bus_get_cb:
+ * @source:    Not used.
+ * @result:    Result of the asynchronous bus connection.
+ * @user_data: Optional user data (not used)
+ *
+ * Called when the connection to the system bus has been established. The
+ * signals for added and removed units and changed properties are registered
+ * before systemd is asked to send them, so that no change is missed.
+ */
+static void
+nhm_systemd_bus_get_cb(GObject      *source,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  GError          *error = NULL;
+  GDBusConnection *conn  = NULL;
+
+  conn = g_bus_get_finish(result, &error);
+
+  if(error == NULL)
   {
+    nhm_systemd_conn = conn;
+
     nhm_systemd_unit_add_sig_id =
         g_dbus_connection_signal_subscribe(nhm_systemd_conn,
                                            NHM_SYSTEMD_BUS_NAME,
@@ -734,110 +913,266 @@ nhm_systemd_connect(NhmSystemdAppStatusCb app_status_cb)
                                            &nhm_systemd_unit_removed,
                                            NULL,
                                            NULL);
-  }
 
-  /* Step 4: Subscribe. Without, PropertiesChanged isn't send */
-  if(retval == TRUE)
+    nhm_systemd_prop_sig_id = nhm_systemd_subscribe_properties_changed();
+
+    /* Subscribe. Without, PropertiesChanged isn't send */
+    g_dbus_connection_call(nhm_systemd_conn,
+                           NHM_SYSTEMD_BUS_NAME,
+                           NHM_SYSTEMD_OBJ_PATH,
+                           NHM_SYSTEMD_MNGR_IF,
+                           "Subscribe",
+                           NULL,
+                           NULL,
+                           G_DBUS_CALL_FLAGS_NONE,
+                           -1,
+                           nhm_systemd_startup,
+                           &nhm_systemd_subscribe_cb,
+                           NULL);
+  }
+  else
   {
-    manager_return = g_dbus_connection_call_sync(nhm_systemd_conn,
-                                                 NHM_SYSTEMD_BUS_NAME,
-                                                 NHM_SYSTEMD_OBJ_PATH,
-                                                 NHM_SYSTEMD_MNGR_IF,
-                                                 "Subscribe",
-                                                 NULL,
-                                                 NULL,
-                                                 G_DBUS_CALL_FLAGS_NONE,
-                                                 -1,
-                                                 NULL,
+    nhm_systemd_startup_failed(error, "NHM: Failed to connect to systemd dbus.");
+  }
+}
+
+
+/**
+ * nhm_systemd_subscribe_cb:
+ * @source:    Connection on which the 'Subscribe' call has been made.
+ * @result:    Result of the asynchronous call.
+ * @user_data: Optional user data (not used)
+ *
+ * Called when systemd confirmed the subscription for its signals. The
+ * currently known units are requested afterwards. Because the reply of
+ * 'ListUnits' is sent after all signals that systemd emitted before, it
+ * always carries the latest state of the units.
+ */
+static void
+nhm_systemd_subscribe_cb(GObject      *source,
+                         GAsyncResult *result,
+                         gpointer      user_data)
+{
+  GError   *error          = NULL;
+  GVariant *manager_return = NULL;
+
+  manager_return = g_dbus_connection_call_finish((GDBusConnection*) source,
+                                                 result,
                                                  &error);
-    if(error == NULL)
-    {
-      retval = TRUE;
-      nhm_systemd_events_subscribed = TRUE;
-      g_variant_unref(manager_return);
-    }
-    else
-    {
-      retval = FALSE;
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_ERROR,
-              DLT_STRING("NHM: Failed to subscribe to systemd signals.");
-              DLT_STRING("Error: D-Bus connection failed.");
-              DLT_STRING("Reason:"); DLT_STRING(error->message));
-      g_error_free(error);
-    }
+  if(error == NULL)
+  {
+    nhm_systemd_events_subscribed = TRUE;
+    g_variant_unref(manager_return);
+
+    nhm_systemd_list_units(TRUE);
+  }
+  else
+  {
+    nhm_systemd_startup_failed(error,
+                               "NHM: Failed to subscribe to systemd signals.");
   }
+}
 
-  /* Step 5: Retrieve all currently known service units from systemd. */
-  if(retval == TRUE)
+
+/**
+ * nhm_systemd_list_units:
+ * @by_patterns: If %TRUE, systemd is asked to only return the units that
+ *               match the configured patterns.
+ *
+ * The function requests the currently known units from systemd. Filtering
+ * the units on systemd side needs 'ListUnitsByPatterns', which older
+ * versions of systemd don't offer. In this case, 'ListUnits' is used and the
+ * units are only filtered locally.
+ */
+static void
+nhm_systemd_list_units(gboolean by_patterns)
+{
+  const gchar *method    = NULL;
+  GVariant    *params    = NULL;
+  gchar       *states[1] = {NULL};
+
+  if(by_patterns == TRUE)
   {
-    manager_return =
-        g_dbus_connection_call_sync(nhm_systemd_conn,
-                                    NHM_SYSTEMD_BUS_NAME,
-                                    NHM_SYSTEMD_OBJ_PATH,
-                                    NHM_SYSTEMD_MNGR_IF,
-                                    "ListUnits",
-                                    NULL,
-                                    (GVariantType*) "(a(ssssssouso))",
-                                    G_DBUS_CALL_FLAGS_NONE,
-                                    -1,
-                                    NULL,
-                                    &error);
+    method = "ListUnitsByPatterns";
+    params = g_variant_new("(^as^as)", states, nhm_systemd_list_patterns);
+  }
+  else
+  {
+    method = "ListUnits";
+    params = NULL;
+  }
 
-    if(error == NULL)
-    {
-      retval = TRUE;
+  g_dbus_connection_call(nhm_systemd_conn,
+                         NHM_SYSTEMD_BUS_NAME,
+                         NHM_SYSTEMD_OBJ_PATH,
+                         NHM_SYSTEMD_MNGR_IF,
+                         method,
+                         params,
+                         (GVariantType*) "(a(ssssssouso))",
+                         G_DBUS_CALL_FLAGS_NONE,
+                         -1,
+                         nhm_systemd_startup,
+                         &nhm_systemd_list_units_cb,
+                         GINT_TO_POINTER(by_patterns));
+}
+
+
+/**
+ * nhm_systemd_list_units_cb:
+ * @source:    Connection on which the units have been requested.
+ * @result:    Result of the asynchronous call.
+ * @user_data: %TRUE, if 'ListUnitsByPatterns' has been called.
+ *
+ * Called when the list of units arrives from systemd. Units, which are not
+ * known yet, are added with their current state. Units that have been added
+ * by a 'UnitNew' signal in the meantime, already are observed. For them, the
+ * reported state is processed like a transition.
+ */
+static void
+nhm_systemd_list_units_cb(GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GVariantIter    iter;
+  GError         *error          = NULL;
+  GVariant       *manager_return = NULL;
+  GVariant       *unit_array     = NULL;
+  GVariant       *unit           = NULL;
+  const gchar    *unit_name      = NULL;
+  const gchar    *unit_path      = NULL;
+  const gchar    *active_state   = NULL;
+  NhmSystemdUnit *known_unit     = NULL;
+  NhmSystemdUnit *new_unit       = NULL;
+
+  manager_return = g_dbus_connection_call_finish((GDBusConnection*) source,
+                                                 result,
+                                                 &error);
+  if(error == NULL)
+  {
+    unit_array = g_variant_get_child_value(manager_return, 0);
+    g_variant_iter_init (&iter, unit_array);
 
-      unit_array = g_variant_get_child_value(manager_return, 0);
-      g_variant_iter_init (&iter, unit_array);
+    while((unit = g_variant_iter_next_value(&iter)))
+    {
+      /* Return for a unit is of type '(ssssssouso)' with member #:
+       * 0: Unit name. 3: Active state. 6: Object path */
+      g_variant_get_child(unit, 0, "&s", &unit_name);
 
-      while((unit = g_variant_iter_next_value(&iter)))
+      if(nhm_systemd_unit_is_observed(unit_name) == TRUE)
       {
-        /* Return for a unit is of type '(ssssssouso)' with member #:
-         * 0: Unit name. 3: Active state. 6: Object path */
-        g_variant_get_child(unit, 0, "s", &unit_name);
+        g_variant_get_child(unit, 3, "&s", &active_state);
+        known_unit = g_hash_table_lookup(nhm_systemd_observed_units, unit_name);
 
-        if(g_str_has_suffix(unit_name, ".service") == TRUE)
+        if(known_unit == NULL)
         {
-          new_unit = g_new(NhmSystemdUnit, 1);
-          new_unit->name = unit_name;
-
-          g_variant_get_child(unit, 3, "&s", &active_state);
+          g_variant_get_child(unit, 6, "&o", &unit_path);
 
+          new_unit = nhm_systemd_add_unit(unit_name, unit_path);
           new_unit->active_state =
               nhm_systemd_active_state_string_to_enum(active_state);
-
-          g_variant_get_child(unit, 6, "o", &new_unit->path);
-
-          new_unit->sig_sub_id =
-              nhm_systemd_subscribe_properties_changed(new_unit);
-
-          nhm_systemd_observed_units =
-              g_slist_append(nhm_systemd_observed_units, new_unit);
         }
         else
         {
-          g_free(unit_name);
+          nhm_systemd_unit_set_active_state(known_unit, active_state);
         }
       }
 
-      g_variant_unref(unit_array);
-      g_variant_unref(manager_return);
-    }
-    else
-    {
-      retval = FALSE;
-      DLT_LOG(nhm_helper_trace_ctx,
-              DLT_LOG_ERROR,
-              DLT_STRING("NHM: Failed to retrieve unit list from systemd.");
-              DLT_STRING("Error: D-Bus communication failed.");
-              DLT_STRING("Reason:"); DLT_STRING(error->message));
-      g_error_free(error);
+      g_variant_unref(unit);
     }
+
+    g_variant_unref(unit_array);
+    g_variant_unref(manager_return);
+
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_INFO,
+            DLT_STRING("NHM: Systemd observation started.");
+            DLT_STRING("Units:");
+            DLT_UINT(g_hash_table_size(nhm_systemd_observed_units)));
   }
+  else if(   (GPOINTER_TO_INT(user_data) == TRUE)
+           && (g_error_matches(error,
+                               G_DBUS_ERROR,
+                               G_DBUS_ERROR_UNKNOWN_METHOD) == TRUE))
+  {
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_INFO,
+            DLT_STRING("NHM: Systemd can't filter units. Using 'ListUnits'."));
+    g_error_free(error);
 
-  /* Step 6: If there was a problem, destroy what has been created */
-  if(retval == FALSE)
+    nhm_systemd_list_units(FALSE);
+  }
+  else
+  {
+    nhm_systemd_startup_failed(error,
+                               "NHM: Failed to retrieve unit list from systemd.");
+  }
+}
+
+
+/*******************************************************************************
+*
+* Interfaces. Exported functions. See Header for detailed description.
+*
+*******************************************************************************/
+
+/**
+ * nhm_systemd_connect:
+ * @app_status_cb: Callback that should be called, if the "ActiveState" of
+ *                 a systemd Service changes between valid and invalid states.
+ *
+ * The NHM main process can start the systemd observation whith this function.
+ * The function does not block. It starts connecting to the system bus. The
+ * remaining steps of the startup are done asynchronously.
+ */
+gboolean
+nhm_systemd_connect(NhmSystemdAppStatusCb app_status_cb)
+{
+  gboolean retval = FALSE;
+
+  /* Initialize local variables */
+  nhm_systemd_app_status_cb     = NULL;
+  nhm_systemd_conn              = NULL;
+  nhm_systemd_observed_units    = g_hash_table_new_full(&g_str_hash,
+                                                        &g_str_equal,
+                                                        NULL,
+                                                        &nhm_systemd_free_unit);
+  nhm_systemd_events_subscribed = FALSE;
+  nhm_systemd_unit_add_sig_id   = 0;
+  nhm_systemd_unit_rem_sig_id   = 0;
+  nhm_systemd_prop_sig_id       = 0;
+  nhm_systemd_units_by_path     = g_hash_table_new(&g_str_hash, &g_str_equal);
+  nhm_systemd_startup           = g_cancellable_new();
+
+  /* Without configuration, all service units are observed */
+  if(nhm_systemd_unit_suffixes == NULL)
+  {
+    nhm_systemd_set_unit_filter(NULL, NULL, NULL);
+  }
+
+  /* Step 1: Save function to call if app status changes. */
+  if(app_status_cb != NULL)
+  {
+    retval = TRUE;
+    nhm_systemd_app_status_cb = app_status_cb;
+  }
+  else
+  {
+    retval = FALSE;
+    DLT_LOG(nhm_helper_trace_ctx,
+            DLT_LOG_ERROR,
+            DLT_STRING("NHM: Failed to connect to systemd dbus.");
+            DLT_STRING("Error: Invalid callback passed."));
+  }
+
+  /* Step 2: Connect to the system bus. Continues in callback. */
+  if(retval == TRUE)
+  {
+    g_bus_get(G_BUS_TYPE_SYSTEM,
+              nhm_systemd_startup,
+              &nhm_systemd_bus_get_cb,
+              NULL);
+  }
+  else
   {
     nhm_systemd_disconnect();
   }
@@ -861,6 +1196,14 @@ nhm_systemd_disconnect(void)
   /* Reset callback */
   nhm_systemd_app_status_cb = NULL;
 
+  /* Cancel a startup, which still is in progress */
+  if(nhm_systemd_startup != NULL)
+  {
+    g_cancellable_cancel(nhm_systemd_startup);
+    g_object_unref(nhm_systemd_startup);
+    nhm_systemd_startup = NULL;
+  }
+
   /* Unsubscribe from systemd signals */
   if(nhm_systemd_events_subscribed == TRUE)
   {
@@ -907,10 +1250,24 @@ nhm_systemd_disconnect(void)
     nhm_systemd_unit_rem_sig_id = 0;
   }
 
-  /* Destroy list of units (incl. unregister prop. changed) */
+  /* Unregister properties changed signal */
+  if(nhm_systemd_prop_sig_id != 0)
+  {
+    g_dbus_connection_signal_unsubscribe(nhm_systemd_conn,
+                                         nhm_systemd_prop_sig_id);
+    nhm_systemd_prop_sig_id = 0;
+  }
+
+  /* Destroy dispatch table and list of units */
+  if(nhm_systemd_units_by_path != NULL)
+  {
+    g_hash_table_destroy(nhm_systemd_units_by_path);
+    nhm_systemd_units_by_path = NULL;
+  }
+
   if(nhm_systemd_observed_units != NULL)
   {
-    g_slist_free_full(nhm_systemd_observed_units, &nhm_systemd_free_unit);
+    g_hash_table_destroy(nhm_systemd_observed_units);
     nhm_systemd_observed_units = NULL;
   }
 
@@ -920,3 +1277,85 @@ nhm_systemd_disconnect(void)
     nhm_systemd_conn = NULL;
   }
 }
+
+
+/**
+ * nhm_systemd_set_unit_filter:
+ * @include: Glob patterns of units to observe. If %NULL, all units are
+ *           observed, which match one of the @types.
+ * @exclude: Glob patterns of units, which should not be observed. May be %NULL.
+ * @types:   Types of units to observe, e.g. "service". If %NULL, only service
+ *           units are observed.
+ *
+ * The NHM main process can set the units, which should be observed, with this
+ * function. The patterns are compiled once and used for all units and signals.
+ */
+void
+nhm_systemd_set_unit_filter(gchar **include,
+                            gchar **exclude,
+                            gchar **types)
+{
+  gchar *def_types[] = {"service", NULL};
+  guint  idx         = 0;
+
+  if(types == NULL)
+  {
+    types = def_types;
+  }
+
+  nhm_systemd_free_unit_filter();
+
+  nhm_systemd_include_units = nhm_systemd_compile_patterns(include);
+  nhm_systemd_exclude_units = nhm_systemd_compile_patterns(exclude);
+  nhm_systemd_unit_suffixes = g_new0(gchar*, g_strv_length(types) + 1);
+
+  for(idx = 0; types[idx] != NULL; idx++)
+  {
+    nhm_systemd_unit_suffixes[idx] = g_strconcat(".", types[idx], NULL);
+  }
+
+  /* Let systemd filter by the include patterns or at least by the types */
+  if((include != NULL) && (include[0] != NULL))
+  {
+    nhm_systemd_list_patterns = g_strdupv(include);
+  }
+  else
+  {
+    nhm_systemd_list_patterns = g_new0(gchar*, g_strv_length(types) + 1);
+
+    for(idx = 0; types[idx] != NULL; idx++)
+    {
+      nhm_systemd_list_patterns[idx] = g_strconcat("*.", types[idx], NULL);
+    }
+  }
+}
+
+
+/**
+ * nhm_systemd_free_unit_filter:
+ *
+ * The NHM main process should call this function after
+ * nhm_systemd_disconnect() to free the filter, which has been compiled by
+ * nhm_systemd_set_unit_filter().
+ */
+void
+nhm_systemd_free_unit_filter(void)
+{
+  if(nhm_systemd_include_units != NULL)
+  {
+    g_ptr_array_unref(nhm_systemd_include_units);
+    nhm_systemd_include_units = NULL;
+  }
+
+  if(nhm_systemd_exclude_units != NULL)
+  {
+    g_ptr_array_unref(nhm_systemd_exclude_units);
+    nhm_systemd_exclude_units = NULL;
+  }
+
+  g_strfreev(nhm_systemd_unit_suffixes);
+  nhm_systemd_unit_suffixes = NULL;
+
+  g_strfreev(nhm_systemd_list_patterns);
+  nhm_systemd_list_patterns = NULL;
+}
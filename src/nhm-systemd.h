@@ -40,8 +40,12 @@ typedef void (*NhmSystemdAppStatusCb)(const gchar *name, NhmAppStatus_e status);
 *
 *******************************************************************************/
 
-gboolean nhm_systemd_connect   (NhmSystemdAppStatusCb app_status_cb);
-void     nhm_systemd_disconnect(void);
+gboolean nhm_systemd_connect         (NhmSystemdAppStatusCb   app_status_cb);
+void     nhm_systemd_disconnect      (void);
+void     nhm_systemd_set_unit_filter (gchar                 **include,
+                                      gchar                 **exclude,
+                                      gchar                 **types);
+void     nhm_systemd_free_unit_filter(void);
 
 
 #endif /* NHM_SYSTEMD */
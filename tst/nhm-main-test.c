@@ -51,14 +51,45 @@ static gint nhm_test_load_config         (void);
 static gint nhm_test_connect_to_nsm      (void);
 static gint nhm_test_nhm_bus_callbacks   (void);
 static gint nhm_test_register_app_status (void);
+static gint nhm_test_register_batch      (void);
+static gint nhm_test_write_behind        (void);
+static gint nhm_test_lc_journal          (void);
+static gint nhm_test_lc_data_format      (void);
+static gint nhm_test_nsm_call_queue      (void);
 static gint nhm_test_read_statistics     (void);
+static gint nhm_test_read_all_statistics (void);
 static gint nhm_test_userland_check      (void);
+static gint nhm_test_proc_checks         (void);
+static gint nhm_test_check_wheel         (void);
+static gint nhm_test_check_cadence       (void);
+static gint nhm_test_health_report       (void);
+static gint nhm_test_check_results       (void);
+static gint nhm_test_find_missing_prog   (void);
+static gint nhm_test_proc_events         (void);
+static gint nhm_test_watch_files         (void);
 static gint nhm_test_watchdog            (void);
 static gint nhm_test_handle_lc_request   (void);
 static gint nhm_test_app_restart_request (void);
-static gint nhm_test_is_dbus_alive       (void);
+static gint nhm_test_probe_dbus          (void);
 static gint nhm_test_on_sigterm          (void);
 
+static gsize    nhm_test_file_size          (const gchar  *file_name);
+static void     nhm_test_restart_lc         (void);
+static void     nhm_test_create_proc_dir    (void);
+static gboolean nhm_test_send_proc_event    (GIOChannel   *channel,
+                                             gint          sock_fd,
+                                             guint         what,
+                                             glong         pid,
+                                             glong         tgid,
+                                             glong         parent_tgid);
+static void     nhm_test_exit_proc_check    (NhmProcCheck *check,
+                                             gint          status);
+static void     nhm_test_run_userland_check (void);
+static void     nhm_test_queue_proc_checks  (void);
+static gboolean nhm_test_has_check_status   (GVariant     *report,
+                                             const gchar  *name,
+                                             const gchar  *status);
+
 
 /*******************************************************************************
 *
@@ -200,94 +231,140 @@ static gint nhm_test_watchdog(void)
 }
 
 
-static gint nhm_test_is_dbus_alive(void)
+/**
+ * nhm_test_probe_dbus:
+ *
+ * Tests the asynchronous probes of monitored dbusses. The answers of the bus
+ * and the expiration of the deadline are simulated by calling the callbacks.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_probe_dbus(void)
 {
   gint            retval       = 0;
-  NhmCheckedDbus *checked_dbus = g_new(NhmCheckedDbus, 1);
-  GdbusConnectionCallSyncStubCalls  g_dbus_connection_call_sync_stub_calls[1];
+  NhmCheckedDbus *checked_dbus = g_new0(NhmCheckedDbus, 1);
 
-  /* Check 1: No conn. obtained. Conn. can't be obtained. Call fails. */
-  checked_dbus->bus_addr = NULL;
-  checked_dbus->bus_conn = NULL;
-  g_dbus_connection_new_for_address_sync_stub_set_error = TRUE;
+  dbus_probe_timeout                            = 1000;
+  dbus_max_rtt                                  = 50;
+  g_dbus_connection_new_for_address_stub_called = 0;
+  g_dbus_connection_call_stub_called            = 0;
 
-  g_dbus_connection_call_sync_stub_control.count   = 1;
-  g_dbus_connection_call_sync_stub_calls[0].method = "GetId";
-  g_dbus_connection_call_sync_stub_calls[0].rval   = NULL;
-  g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+  /* Check 1: No conn. obtained. Probe starts to connect. */
+  nhm_main_probe_dbus(checked_dbus);
 
-  retval = nhm_main_is_dbus_alive(checked_dbus) == FALSE ? 0 : -1;
+  retval = (   (g_dbus_connection_new_for_address_stub_called == 1   )
+            && (g_dbus_connection_call_stub_called            == 0   )
+            && (checked_dbus->probe                           != NULL)
+            && (checked_dbus->deadline                        != 0   )) ? 0 : -1;
 
-  /* Check 2: No conn. obtained. Conn. can be obtained. Call fails. */
+  /* Check 2: Probe pending. No further probe started. */
   if(retval == 0)
   {
-    checked_dbus->bus_addr = NULL;
-    checked_dbus->bus_conn = NULL;
-    g_dbus_connection_new_for_address_sync_stub_set_error = FALSE;
+    nhm_main_probe_dbus(checked_dbus);
 
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "GetId";
-    g_dbus_connection_call_sync_stub_calls[0].rval   = NULL;
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+    retval = (g_dbus_connection_new_for_address_stub_called == 1) ? 0 : -1;
+  }
 
-    retval = nhm_main_is_dbus_alive(checked_dbus) == FALSE ? 0 : -1;
+  /* Check 3: Conn. can't be obtained. Probe finished. */
+  if(retval == 0)
+  {
+    g_dbus_connection_new_for_address_finish_stub_set_error = TRUE;
+    nhm_main_dbus_connected_cb(NULL, NULL, checked_dbus);
+    g_dbus_connection_new_for_address_finish_stub_set_error = FALSE;
+
+    retval = (   (checked_dbus->bus_conn    == NULL)
+              && (checked_dbus->probe       == NULL)
+              && (checked_dbus->deadline    == 0   )
+              && (checked_dbus->rtt_hist[0] == 1   )) ? 0 : -1;
   }
 
-  /* Check 3: No conn. obtained. Conn. can be obtained. Call succeeds. */
+  /* Check 4: Conn. can be obtained. Call succeeds. */
   if(retval == 0)
   {
-    checked_dbus->bus_addr = NULL;
-    checked_dbus->bus_conn = NULL;
-    g_dbus_connection_new_for_address_sync_stub_set_error = FALSE;
+    nhm_main_probe_dbus(checked_dbus);
+    nhm_main_dbus_connected_cb(NULL, NULL, checked_dbus);
+
+    retval = (   (checked_dbus->bus_conn                                != NULL)
+              && (g_dbus_connection_call_stub_called                    == 1   )
+              && (g_strcmp0(g_dbus_connection_call_stub_method, "GetId") == 0   )) ? 0 : -1;
 
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "GetId";
-    g_dbus_connection_call_sync_stub_calls[0].rval   = g_variant_new("()");
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+    g_dbus_connection_call_finish_stub_rval = g_variant_new("()");
+    nhm_main_dbus_get_id_cb(NULL, NULL, checked_dbus);
+    g_dbus_connection_call_finish_stub_rval = NULL;
 
-    retval = nhm_main_is_dbus_alive(checked_dbus) == TRUE ? 0 : -1;
+    retval = (   (retval                    == 0   )
+              && (checked_dbus->probe       == NULL)
+              && (checked_dbus->rtt_hist[0] == 2   )) ? 0 : -1;
   }
 
-  /* Check 4: Conn. obtained. Call succeeds. */
+  /* Check 5: Conn. obtained. Call fails. */
   if(retval == 0)
   {
-    checked_dbus->bus_addr = NULL;
-    checked_dbus->bus_conn = g_object_new(G_TYPE_DBUS_CONNECTION, NULL);
+    nhm_main_probe_dbus(checked_dbus);
+    nhm_main_dbus_get_id_cb(NULL, NULL, checked_dbus);
 
-    g_dbus_connection_new_for_address_sync_stub_set_error = FALSE;
+    retval = (   (g_dbus_connection_new_for_address_stub_called == 2   )
+              && (g_dbus_connection_call_stub_called            == 2   )
+              && (checked_dbus->probe                           == NULL)
+              && (checked_dbus->rtt_hist[0]                     == 3   )) ? 0 : -1;
+  }
 
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "GetId";
-    g_dbus_connection_call_sync_stub_calls[0].rval   = g_variant_new("()");
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+  /* Check 6: Conn. obtained. Call too slow. RTT counted in histogram. */
+  if(retval == 0)
+  {
+    nhm_main_probe_dbus(checked_dbus);
+    checked_dbus->start_time -= 100000;
 
-    retval = nhm_main_is_dbus_alive(checked_dbus) == TRUE ? 0 : -1;
+    g_dbus_connection_call_finish_stub_rval = g_variant_new("()");
+    nhm_main_dbus_get_id_cb(NULL, NULL, checked_dbus);
+    g_dbus_connection_call_finish_stub_rval = NULL;
 
-    g_object_unref(checked_dbus->bus_conn);
-    checked_dbus->bus_conn = NULL;
+    retval = (   (checked_dbus->probe       == NULL)
+              && (checked_dbus->rtt_hist[4] == 1   )) ? 0 : -1;
   }
 
-  /* Check 5: Conn. obtained. Call fails. */
+  /* Check 7: Deadline missed. Probe cancelled and connection dropped. */
+  if(retval == 0)
+  {
+    nhm_main_probe_dbus(checked_dbus);
+    g_source_remove(checked_dbus->deadline);
+    (void) nhm_main_dbus_deadline_cb(checked_dbus);
+
+    retval = (   (checked_dbus->deadline    == 0   )
+              && (checked_dbus->probe       == NULL)
+              && (checked_dbus->bus_conn    == NULL)
+              && (checked_dbus->rtt_hist[0] == 4   )) ? 0 : -1;
+  }
+
+  /* Check 8: Next cycle after missed deadline. Bus probed again. */
   if(retval == 0)
   {
-    checked_dbus->bus_addr = NULL;
-    checked_dbus->bus_conn = g_object_new(G_TYPE_DBUS_CONNECTION, NULL);
+    nhm_main_probe_dbus(checked_dbus);
 
-    g_dbus_connection_new_for_address_sync_stub_set_error = FALSE;
+    retval = (   (g_dbus_connection_new_for_address_stub_called == 3   )
+              && (checked_dbus->probe                           != NULL)) ? 0 : -1;
+  }
 
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "GetId";
-    g_dbus_connection_call_sync_stub_calls[0].rval   = NULL;
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+  /* Check 9: No probe timeout configured. Deadline armed nevertheless. */
+  if(retval == 0)
+  {
+    g_source_remove(checked_dbus->deadline);
+    (void) nhm_main_dbus_deadline_cb(checked_dbus);
 
-    retval = nhm_main_is_dbus_alive(checked_dbus) == FALSE ? 0 : -1;
+    dbus_probe_timeout = 0;
+    nhm_main_probe_dbus(checked_dbus);
 
-    g_object_unref(checked_dbus->bus_conn);
-    checked_dbus->bus_conn = NULL;
+    retval = (   (checked_dbus->probe    != NULL)
+              && (checked_dbus->deadline != 0   )) ? 0 : -1;
   }
 
+  /* Check 10: Bus destroyed while probe is pending. Probe is cancelled. */
+  nhm_main_probe_dbus(checked_dbus);
   nhm_main_free_checked_dbus(checked_dbus);
 
+  dbus_probe_timeout = 0;
+  dbus_max_rtt       = 0;
+
   return retval;
 }
 
@@ -304,7 +381,6 @@ static gint nhm_test_userland_check(void)
   gchar          *my_monitored_files[]    = {"missing_file",          NULL};
   gchar          *my_monitored_progs[]    = {"invalid_prog",          NULL};
   gchar          *my_monitored_procs[]    = {"/usr/bin/invalid_proc", NULL};
-  NhmCheckedDbus  my_checked_dbus         = {NULL, NULL};
 
   /* Check 1: No monitored files. No monitored progs. No monitored procs. No monitored dbus */
   monitored_files = NULL;
@@ -312,7 +388,7 @@ static gint nhm_test_userland_check(void)
   monitored_procs = NULL;
   checked_dbusses = NULL;
 
-  nhm_main_timer_userland_check_cb(NULL);
+  nhm_test_run_userland_check();
 
   nhm_main_free_check_objects();
   nhm_main_free_config_objects();
@@ -323,7 +399,7 @@ static gint nhm_test_userland_check(void)
   monitored_procs = g_strdupv(my_monitored_procs);
   checked_dbusses = NULL;
 
-  nhm_main_timer_userland_check_cb(NULL);
+  nhm_test_run_userland_check();
 
   nhm_main_free_check_objects();
   nhm_main_free_config_objects();
@@ -335,7 +411,7 @@ static gint nhm_test_userland_check(void)
   monitored_procs       = g_strdupv(my_monitored_procs);
   checked_dbusses       = NULL;
 
-  nhm_main_timer_userland_check_cb(NULL);
+  nhm_test_run_userland_check();
 
   nhm_main_free_check_objects();
   nhm_main_free_config_objects();
@@ -345,358 +421,2041 @@ static gint nhm_test_userland_check(void)
   monitored_progs       = g_strdupv(my_monitored_progs);
   monitored_procs       = g_strdupv(my_monitored_procs);
   checked_dbusses       = NULL;
-  nhm_main_timer_userland_check_cb(NULL);
+  nhm_test_run_userland_check();
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+
+  /* Check 5: No monitored files. monitored progs ok. Monitored procs. ok. No monitored dbus. */
+  monitored_files       = NULL;
+  my_monitored_progs[0] = "/usr/bin/valid_prog1";
+  monitored_progs       = g_strdupv(my_monitored_progs);
+  monitored_procs       = g_strdupv(my_monitored_procs);
+  checked_dbusses       = NULL;
+  nhm_test_run_userland_check();
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+
+  /* Check 6: monitored files nok. monitored progs ok. Monitored procs. ok. No monitored dbus. */
+  monitored_files       = g_strdupv(my_monitored_files);
+  monitored_progs       = g_strdupv(my_monitored_progs);
+  monitored_procs       = g_strdupv(my_monitored_procs);
+  checked_dbusses       = NULL;
+  nhm_test_run_userland_check();
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+
+  /* Check 7: monitored files ok. monitored progs ok. Monitored procs. ok. No monitored dbus. */
+  my_monitored_files[0] = "valid_file";
+  monitored_files       = g_strdupv(my_monitored_files);
+  monitored_progs       = g_strdupv(my_monitored_progs);
+  monitored_procs       = g_strdupv(my_monitored_procs);
+  checked_dbusses       = NULL;
+  nhm_test_run_userland_check();
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+
+  /* Check 8: monitored files ok. monitored progs ok. Monitored procs. ok. Monitored dbus probed */
+  monitored_files       = g_strdupv(my_monitored_files);
+  monitored_progs       = g_strdupv(my_monitored_progs);
+  monitored_procs       = g_strdupv(my_monitored_procs);
+  checked_dbusses       = g_ptr_array_new_with_free_func(&nhm_main_free_checked_dbus);
+
+  g_ptr_array_add(checked_dbusses, (gpointer) g_new0(NhmCheckedDbus, 1));
+  ((NhmCheckedDbus*) g_ptr_array_index(checked_dbusses, 0))->bus_addr =
+    g_strdup("unix:path=/tmp/bus");
+  nhm_test_run_userland_check();
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+
+  return 0;
+}
+
+
+/**
+ * nhm_test_proc_checks:
+ *
+ * Tests the asynchronous execution of monitored procs. The exit of a proc.
+ * and the expiration of its timeout are simulated by calling the callbacks.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_proc_checks(void)
+{
+  gint          retval               = 0;
+  gchar        *my_monitored_procs[] = {"valid_proc",
+                                        "failing_proc",
+                                        "invalid_proc",
+                                        NULL};
+  NhmProcCheck *valid_check          = NULL;
+  NhmProcCheck *failing_check        = NULL;
+  NhmProcCheck *invalid_check        = NULL;
+
+  max_proc_checks               = 1;
+  proc_check_timeout            = 5;
+  monitored_procs               = g_strdupv(my_monitored_procs);
+  g_spawn_async_stub_called     = 0;
+
+  nhm_test_queue_proc_checks();
+
+  valid_check   = g_hash_table_lookup(proc_checks, "valid_proc");
+  failing_check = g_hash_table_lookup(proc_checks, "failing_proc");
+  invalid_check = g_hash_table_lookup(proc_checks, "invalid_proc");
+
+  /* Check 1: Only one check started. Others queued. */
+  retval = (   (valid_check                             != NULL                  )
+            && (failing_check                           != NULL                  )
+            && (invalid_check                           != NULL                  )
+            && (g_spawn_async_stub_called               == 1                     )
+            && (valid_check->child_watch                != 0                     )
+            && (valid_check->timeout                    != 0                     )
+            && (proc_checks_running                     == 1                     )
+            && (valid_check->pid                        == G_SPAWN_ASYNC_STUB_PID)
+            && (g_queue_get_length(proc_check_queue)    == 2                     )) ? 0 : -1;
+
+  /* Check 2: Running and queued checks are not queued again */
+  if(retval == 0)
+  {
+    nhm_test_queue_proc_checks();
+
+    retval = (   (g_spawn_async_stub_called             == 1)
+              && (proc_checks_running                   == 1)
+              && (g_queue_get_length(proc_check_queue)  == 2)) ? 0 : -1;
+  }
+
+  /* Check 3: Valid proc. exits. Next check is started. */
+  if(retval == 0)
+  {
+    nhm_test_exit_proc_check(valid_check, 0);
+
+    retval = (   (valid_check->pid                      == 0                     )
+              && (valid_check->status                   == 0                     )
+              && (valid_check->duration                 >= 0                     )
+              && (g_spawn_async_stub_called             == 2                     )
+              && (proc_checks_running                   == 1                     )
+              && (failing_check->pid                    == G_SPAWN_ASYNC_STUB_PID)
+              && (g_queue_get_length(proc_check_queue)  == 1                     )) ? 0 : -1;
+  }
+
+  /* Check 4: Failing proc. exits. Invalid proc. can not be started. */
+  if(retval == 0)
+  {
+    nhm_test_exit_proc_check(failing_check, 256);
+
+    retval = (   (failing_check->status                 == 256 )
+              && (g_spawn_async_stub_called             == 3   )
+              && (invalid_check->pid                    == 0   )
+              && (invalid_check->status                 == -1  )
+              && (proc_checks_running                   == 0   )
+              && (g_queue_is_empty(proc_check_queue)    == TRUE)) ? 0 : -1;
+  }
+
+  /* Check 5: Valid proc. does not exit in time. It is killed. */
+  if(retval == 0)
+  {
+    nhm_test_queue_proc_checks();
+    g_source_remove(valid_check->timeout);
+    (void) nhm_main_proc_check_timeout_cb(valid_check);
+
+    retval = (   (valid_check->timed_out                == TRUE                  )
+              && (kill_stub_pid                         == G_SPAWN_ASYNC_STUB_PID)
+              && (kill_stub_signal                      == SIGKILL               )) ? 0 : -1;
+
+    nhm_test_exit_proc_check(valid_check, SIGKILL);
+
+    retval = (   (retval                                == 0                     )
+              && (valid_check->status                   == SIGKILL               )
+              && (failing_check->pid                    == G_SPAWN_ASYNC_STUB_PID)) ? 0 : -1;
+  }
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+  max_proc_checks    = NHM_PROC_CHECKS_DEFAULT;
+  proc_check_timeout = NHM_PROC_CHECK_TIMEOUT_DEFAULT;
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_check_wheel:
+ *
+ * Tests the scheduling of the userland checks in the timer wheel. Checks
+ * with long intervals are kept in the higher levels of the wheel and have
+ * to be executed at the right tick after cascading down.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_check_wheel(void)
+{
+  gint           retval               = 0;
+  gchar         *my_monitored_files[] = {"valid_file", "valid_file", NULL};
+  gchar         *my_monitored_procs[] = {"valid_proc", NULL};
+  NhmCheckEntry *file_entry           = NULL;
+  NhmCheckEntry *proc_entry           = NULL;
+  NhmProcCheck  *proc_check           = NULL;
+
+  ul_chk_interval           = 1;
+  file_chk_interval         = 100;
+  proc_chk_interval         = 5000;
+  monitored_files           = g_strdupv(my_monitored_files);
+  monitored_procs           = g_strdupv(my_monitored_procs);
+  g_spawn_async_stub_called = 0;
+
+  nhm_main_schedule_checks();
+
+  /* Check 1: One entry per file and proc. Files are spread over interval. */
+  retval = (   (check_entries->len                                            == 3   )
+            && (((NhmCheckEntry*) g_ptr_array_index(check_entries, 0))->due  == 1   )
+            && (((NhmCheckEntry*) g_ptr_array_index(check_entries, 1))->due  == 51  )
+            && (((NhmCheckEntry*) g_ptr_array_index(check_entries, 2))->due  == 1   )
+            && (check_wheel_timer                                             != 0   )) ? 0 : -1;
+
+  file_entry = (retval == 0) ? g_ptr_array_index(check_entries, 0) : NULL;
+  proc_entry = (retval == 0) ? g_ptr_array_index(check_entries, 2) : NULL;
+
+  /* Check 2: First tick runs checks and moves them to higher levels */
+  if(retval == 0)
+  {
+    nhm_main_wheel_advance();
+    proc_check = g_hash_table_lookup(proc_checks, "valid_proc");
+
+    retval = (   (proc_check                                       != NULL      )
+              && (g_spawn_async_stub_called                        == 1         )
+              && (file_entry->due                                  == 101       )
+              && (proc_entry->due                                  == 5001      )
+              && (g_slist_find(check_wheel[1][1], file_entry)      != NULL      )
+              && (g_slist_find(check_wheel[2][1], proc_entry)      != NULL      )) ? 0 : -1;
+  }
+
+  /* Check 3: Proc. is not executed before its interval expired */
+  if(retval == 0)
+  {
+    nhm_test_exit_proc_check(proc_check, 0);
+
+    while(check_wheel_now < 5000)
+    {
+      nhm_main_wheel_advance();
+    }
+
+    retval = (   (g_spawn_async_stub_called                        == 1         )
+              && (file_entry->due                                  == 5001      )) ? 0 : -1;
+  }
+
+  /* Check 4: Proc. is executed after cascading down from level 2 */
+  if(retval == 0)
+  {
+    nhm_main_wheel_advance();
+
+    retval = (   (g_spawn_async_stub_called                        == 2         )
+              && (proc_check->pid                                  == G_SPAWN_ASYNC_STUB_PID)
+              && (file_entry->due                                  == 5101      )
+              && (proc_entry->due                                  == 10001     )) ? 0 : -1;
+
+    nhm_test_exit_proc_check(proc_check, 0);
+  }
+
+  /* Check 5: Missed ticks are caught up by the tick source */
+  if(retval == 0)
+  {
+    check_wheel_start = g_get_monotonic_time() - (gint64) 5003 * G_USEC_PER_SEC;
+
+    retval = (   (nhm_main_wheel_tick_cb(NULL)                     == TRUE      )
+              && (check_wheel_now                                  == 5003      )) ? 0 : -1;
+  }
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+
+  retval = (   (retval                                             == 0         )
+            && (check_entries                                      == NULL      )
+            && (check_wheel[1][1]                                  == NULL      )
+            && (check_wheel_timer                                  == 0         )) ? 0 : -1;
+
+  ul_chk_interval   = 0;
+  file_chk_interval = 0;
+  proc_chk_interval = 0;
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_check_cadence:
+ *
+ * Tests the adaption of the check intervals to the health of the node. The
+ * intervals grow up to the ceiling, while the checks pass. They fall back to
+ * the configured interval, when a check or an app. fails.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_check_cadence(void)
+{
+  gint           retval               = 0;
+  guint          interval             = 0;
+  gchar         *my_monitored_files[] = {"existing_file", NULL};
+  NhmCheckEntry *entry                = NULL;
+
+  ul_chk_interval    = 1;
+  file_chk_interval  = 10;
+  ul_chk_backoff_max = 40;
+  monitored_files    = g_strdupv(my_monitored_files);
+
+  /* Apps. of previous tests may still be failed */
+  g_atomic_int_set(&check_apps_failed, 0);
+
+  nhm_main_schedule_checks();
+  entry = g_ptr_array_index(check_entries, 0);
+
+  /* Check 1: Passing check backs off */
+  nhm_main_wheel_advance();
+
+  retval = (   (entry->cur_interval                  == 20  )
+            && (entry->due                           == 21  )) ? 0 : -1;
+
+  /* Check 2: Interval does not grow beyond the ceiling */
+  if(retval == 0)
+  {
+    while(check_wheel_now < 61)
+    {
+      nhm_main_wheel_advance();
+    }
+
+    retval = (   (entry->cur_interval                == 40  )
+              && (entry->due                         == 101 )) ? 0 : -1;
+  }
+
+  /* Check 3: Failure of another check. Check falls back and is pulled in. */
+  if(retval == 0)
+  {
+    nhm_main_post_check_result(NHM_CHECK_PROC,
+                               "failing_proc",
+                               "Reason: Monitored proc. failed.");
+    check_wheel_start = g_get_monotonic_time() - (gint64) 61 * G_USEC_PER_SEC;
+    (void) nhm_main_wheel_tick_cb(NULL);
+
+    retval = (   (check_wheel_now                    == 61  )
+              && (entry->cur_interval                == 10  )
+              && (entry->due                         == 62  )
+              && (g_slist_find(check_wheel[0][62], entry) != NULL)) ? 0 : -1;
+  }
+
+  /* Check 4: Check keeps fast cadence, while an app. is failed */
+  if(retval == 0)
+  {
+    g_atomic_int_set(&check_apps_failed, 1);
+    nhm_main_wheel_advance();
+
+    retval = (   (entry->cur_interval                == 10  )
+              && (entry->due                         == 72  )) ? 0 : -1;
+
+    g_atomic_int_set(&check_apps_failed, 0);
+  }
+
+  /* Check 5: Effective interval is exported by the main loop */
+  if(retval == 0)
+  {
+    (void) nhm_main_check_results_cb(NULL);
+    nhm_main_read_check_intervals_cb(NULL, NULL, NULL);
+
+    retval = (   (g_variant_lookup(nhm_dbus_info_complete_read_check_intervals_stub_CheckIntervals,
+                                   "existing_file",
+                                   "u",
+                                   &interval)            == TRUE)
+              && (interval                           == 10  )) ? 0 : -1;
+  }
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+
+  g_hash_table_unref(check_intervals);
+  check_intervals    = NULL;
+  ul_chk_interval    = 0;
+  file_chk_interval  = 0;
+  ul_chk_backoff_max = 0;
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_health_report:
+ *
+ * Tests the sweep of all userland checks and the health report built by it.
+ * The report is returned, when the last asynchronous check finished.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_health_report(void)
+{
+  gint          retval               = 0;
+  gchar        *my_monitored_files[] = {"existing_file", "missing_file", NULL};
+  gchar        *my_monitored_procs[] = {"valid_proc", NULL};
+  gchar        *my_monitored_progs[] = {"/usr/bin/invalid_prog1",
+                                        "/usr/bin/invalid_prog2",
+                                        NULL};
+  GVariant     *report               = NULL;
+  GVariant     *checks               = NULL;
+  GVariant     *check                = NULL;
+  const gchar **missing              = NULL;
+  gboolean      healthy              = FALSE;
+  guint         failed               = 0;
+  NhmProcCheck *proc_check           = NULL;
+
+  /* Check 1: Userland checks disabled. Empty report is returned at once. */
+  ul_chk_interval = 0;
+  nhm_main_get_health_report_cb(NULL, NULL, NULL);
+  report = nhm_dbus_info_complete_get_health_report_stub_Report;
+
+  retval = (   (report                                                  != NULL)
+            && (g_variant_lookup(report, "Healthy", "b", &healthy)      == TRUE)
+            && (healthy                                                 == TRUE)
+            && (g_variant_lookup(report, "Checks", "@a{sa{sv}}", &checks) == TRUE)
+            && (g_variant_n_children(checks)                            == 0   )) ? 0 : -1;
+
+  if(checks != NULL)
+  {
+    g_variant_unref(checks);
+    checks = NULL;
+  }
+
+  /* Check 2: Check worker not started. Empty report is returned at once. */
+  if(retval == 0)
+  {
+    ul_chk_interval = 1;
+    g_variant_unref(nhm_dbus_info_complete_get_health_report_stub_Report);
+    nhm_dbus_info_complete_get_health_report_stub_Report = NULL;
+    nhm_main_get_health_report_cb(NULL, NULL, NULL);
+    report = nhm_dbus_info_complete_get_health_report_stub_Report;
+
+    retval = (   (report                                              != NULL)
+              && (g_variant_lookup(report, "Healthy", "b", &healthy)  == TRUE)
+              && (healthy                                             == TRUE)
+              && (sweep_invocations                                   == NULL)) ? 0 : -1;
+  }
+
+  /* Check 3: Sweep waits for proc. Second call shares the sweep. */
+  if(retval == 0)
+  {
+    check_context             = g_main_context_default();
+    monitored_files           = g_strdupv(my_monitored_files);
+    monitored_procs           = g_strdupv(my_monitored_procs);
+    monitored_progs           = g_strdupv(my_monitored_progs);
+    g_spawn_async_stub_called = 0;
+
+    nhm_main_schedule_checks();
+    nhm_main_get_health_report_cb(NULL, NULL, NULL);
+    nhm_main_get_health_report_cb(NULL, NULL, NULL);
+    proc_check = g_hash_table_lookup(proc_checks, "valid_proc");
+
+    retval = (   (proc_check                                            != NULL)
+              && (g_spawn_async_stub_called                             == 1   )
+              && (sweep_pending                                         == 1   )
+              && (sweep_timer                                           != 0   )
+              && (g_queue_get_length(sweep_invocations)                 == 2   )
+              && (nhm_dbus_info_complete_get_health_report_stub_Report  == report)) ? 0 : -1;
+  }
+
+  /* Check 4: Proc. exits. Report with all checks returned to both calls. */
+  if(retval == 0)
+  {
+    nhm_test_exit_proc_check(proc_check, 0);
+    (void) nhm_main_check_results_cb(NULL);
+    report = nhm_dbus_info_complete_get_health_report_stub_Report;
+
+    retval = (   (sweep_pending                                         == 0    )
+              && (sweep_timer                                           == 0    )
+              && (g_queue_is_empty(sweep_invocations)                   == TRUE )
+              && (g_variant_lookup(report, "Healthy", "b", &healthy)    == TRUE )
+              && (healthy                                               == FALSE)
+              && (g_variant_lookup(report, "Failed", "u", &failed)      == TRUE )
+              && (failed                                                == 2    )
+              && (nhm_test_has_check_status(report, "existing_file", "ok"))
+              && (nhm_test_has_check_status(report, "missing_file",  "failed"))
+              && (nhm_test_has_check_status(report, "valid_proc",    "ok"))
+              && (nhm_test_has_check_status(report, NHM_PROG_CHECK_NAME, "failed"))) ? 0 : -1;
+  }
+
+  /* Check 5: All missing programs are in the report */
+  if(retval == 0)
+  {
+    retval = (   (g_variant_lookup(report, "Checks", "@a{sa{sv}}", &checks)        == TRUE)
+              && (g_variant_lookup(checks, NHM_PROG_CHECK_NAME, "@a{sv}", &check)   == TRUE)
+              && (g_variant_lookup(check, "MissingPrograms", "^a&s", &missing)     == TRUE)
+              && (g_strv_length((gchar**) missing)                                 == 2   )
+              && (g_strcmp0(missing[0], "/usr/bin/invalid_prog1")                  == 0   )
+              && (g_strcmp0(missing[1], "/usr/bin/invalid_prog2")                  == 0   )) ? 0 : -1;
+
+    g_free(missing);
+  }
+
+  if(check != NULL)
+  {
+    g_variant_unref(check);
+  }
+
+  if(checks != NULL)
+  {
+    g_variant_unref(checks);
+  }
+
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+  check_context   = NULL;
+  ul_chk_interval = 0;
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_check_results:
+ *
+ * Tests the list, in which the checks post their failures to the main loop.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_check_results(void)
+{
+  gint retval = 0;
+
+  /* Drop results posted by previous tests */
+  (void) nhm_main_check_results_cb(NULL);
+
+  /* Check 1: Posted results are in the list. Newest result first. */
+  nhm_main_post_check_result(NHM_CHECK_FILE,
+                             "missing_file",
+                             "Reason: Monitored file does not exist.");
+  nhm_main_post_check_result(NHM_CHECK_DBUS,
+                             "unix:path=/tmp/bus",
+                             "Reason: Monitored dbus timed out.");
+
+  retval = (   (check_results                                        != NULL          )
+            && (check_results->type                                  == NHM_CHECK_DBUS)
+            && (strcmp(check_results->name, "unix:path=/tmp/bus")    == 0             )
+            && (check_results->next                                  != NULL          )
+            && (check_results->next->type                            == NHM_CHECK_FILE)
+            && (check_results->next->next                            == NULL          )) ? 0 : -1;
+
+  /* Check 2: Main loop takes all results */
+  if(retval == 0)
+  {
+    retval = (   (nhm_main_check_results_cb(NULL) == FALSE)
+              && (check_results                   == NULL )) ? 0 : -1;
+  }
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_watch_files:
+ *
+ * Tests the existence bitmap of watched monitored files.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_watch_files(void)
+{
+  gint   retval               = 0;
+  gchar *my_monitored_files[] = {"existing_file", "missing_file", NULL};
+
+  monitored_files = g_strdupv(my_monitored_files);
+
+  nhm_main_watch_files();
+
+  /* Check 1: Files watched. Existing file present. Missing file not. */
+  retval = (   (nhm_main_bitmap_get(files_watched, 0) == TRUE )
+            && (nhm_main_bitmap_get(files_watched, 1) == TRUE )
+            && (nhm_main_is_file_present(0)           == TRUE )
+            && (nhm_main_is_file_present(1)           == FALSE)) ? 0 : -1;
+
+  /* Check 2: Watched file deleted. Change of file does not update bitmap. */
+  if(retval == 0)
+  {
+    g_file_test_stub_deleted = TRUE;
+    nhm_main_file_changed_cb(NULL,
+                             NULL,
+                             NULL,
+                             G_FILE_MONITOR_EVENT_CHANGED,
+                             g_hash_table_lookup(watched_dirs, "."));
+    retval = (nhm_main_is_file_present(0) == TRUE) ? 0 : -1;
+  }
+
+  /* Check 3: Watched file deleted. Deletion updates bitmap. */
+  if(retval == 0)
+  {
+    nhm_main_file_changed_cb(NULL,
+                             NULL,
+                             NULL,
+                             G_FILE_MONITOR_EVENT_DELETED,
+                             g_hash_table_lookup(watched_dirs, "."));
+    retval = (nhm_main_is_file_present(0) == FALSE) ? 0 : -1;
+  }
+
+  /* Check 4: Watched file created again */
+  if(retval == 0)
+  {
+    g_file_test_stub_deleted = FALSE;
+    nhm_main_file_changed_cb(NULL,
+                             NULL,
+                             NULL,
+                             G_FILE_MONITOR_EVENT_CREATED,
+                             g_hash_table_lookup(watched_dirs, "."));
+    retval = (nhm_main_is_file_present(0) == TRUE) ? 0 : -1;
+  }
+
+  g_file_test_stub_deleted = FALSE;
+  nhm_main_free_check_objects();
+  nhm_main_free_config_objects();
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_find_missing_prog:
+ *
+ * Tests the single '/proc' scan for monitored programs, the cache of their
+ * processes and the lookup in the index of the proc connector. The scan uses
+ * the local process folder created by 'nhm_test_create_proc_dir'.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_find_missing_prog(void)
+{
+  gint         retval   = 0;
+  gchar       *progs[4] = {NULL, NULL, NULL, NULL};
+  const gchar *prog1    = g_intern_string("/usr/bin/valid_prog1");
+  NhmProgPid  *prog_pid = NULL;
+  guint        watch    = 0;
+  gint         failures = 0;
+  gchar       *proc_dir = NULL;
+
+  nhm_test_create_proc_dir();
+
+  /* Check 1: No programs. Nothing missing. */
+  retval = (nhm_main_find_missing_prog(progs, NULL) == NULL) ? 0 : -1;
+
+  /* Check 2: Running programs. Nothing missing. */
+  if(retval == 0)
+  {
+    progs[0] = "/usr/bin/valid_prog1";
+    progs[1] = "/usr/bin/valid_prog2";
+    retval = (nhm_main_find_missing_prog(progs, NULL) == NULL) ? 0 : -1;
+  }
+
+  /* Check 3: Processes of running programs cached with start time */
+  if(retval == 0)
+  {
+    prog_pid = g_hash_table_lookup(monitored_pids, prog1);
+    retval = (   (prog_pid                          != NULL)
+              && (prog_pid->pid                     == 100 )
+              && (prog_pid->start_time              == 1000)
+              && (g_hash_table_size(monitored_pids) == 2   )) ? 0 : -1;
+  }
+
+  /* Check 4: First missing program reported in configured order */
+  if(retval == 0)
+  {
+    progs[0] = "/usr/bin/invalid_prog1";
+    progs[1] = "/usr/bin/valid_prog1";
+    progs[2] = "/usr/bin/invalid_prog2";
+    retval = (   (g_strcmp0(nhm_main_find_missing_prog(progs, NULL),
+                            "/usr/bin/invalid_prog1") == 0)
+              && (g_hash_table_size(monitored_pids)   == 2)) ? 0 : -1;
+  }
+
+  /* Check 5: PID of cached process reused. Process found again. */
+  if(retval == 0)
+  {
+    prog_pid->start_time = 999;
+    progs[0]             = "/usr/bin/valid_prog1";
+    progs[1]             = NULL;
+    retval = (nhm_main_find_missing_prog(progs, NULL) == NULL) ? 0 : -1;
+  }
+
+  if(retval == 0)
+  {
+    prog_pid = g_hash_table_lookup(monitored_pids, prog1);
+    retval = (   (prog_pid             != NULL)
+              && (prog_pid->start_time == 1000)
+              && (prog_pid->watch      == 0   )) ? 0 : -1;
+  }
+
+  /* Check 6: Cached process gone. Program missing and dropped from cache. */
+  if(retval == 0)
+  {
+    system("rm -rf proc/100");
+    retval = (   (g_strcmp0(nhm_main_find_missing_prog(progs, NULL),
+                            "/usr/bin/valid_prog1") == 0)
+              && (g_hash_table_lookup(monitored_pids, prog1) == NULL)) ? 0 : -1;
+  }
+
+  nhm_main_free_check_objects();
+
+  /* Check 7: Watched process is not verified. Its exit drops it from cache */
+  if(retval == 0)
+  {
+    watch  = nhm_main_watch_prog_pid(prog1, getpid());
+    retval = (watch != 0) ? 0 : -1;
+  }
+
+  if(retval == 0)
+  {
+    monitored_pids = g_hash_table_new_full(&g_str_hash,
+                                           &g_str_equal,
+                                           NULL,
+                                           &nhm_main_free_prog_pid);
+    prog_pid             = g_slice_new(NhmProgPid);
+    prog_pid->pid        = getpid();
+    prog_pid->start_time = 0;
+    prog_pid->watch      = watch;
+    g_hash_table_insert(monitored_pids, (gpointer) prog1, prog_pid);
+
+    failures = g_atomic_int_get(&check_failures);
+    retval = (   (nhm_main_find_missing_prog(progs, NULL)                == NULL        )
+              && (nhm_main_prog_exit_cb(NULL, G_IO_IN, (gpointer) prog1) == FALSE       )
+              && (g_hash_table_size(monitored_pids)                      == 0           )
+              && (g_atomic_int_get(&check_failures)                      == failures + 1)) ? 0 : -1;
+
+    g_source_remove(watch);
+  }
+
+  /* Check 8: Other process still runs program. Its exit is not reported. */
+  if(retval == 0)
+  {
+    nhm_test_create_proc_dir();
+
+    prog_pid             = g_slice_new(NhmProgPid);
+    prog_pid->pid        = 555;
+    prog_pid->start_time = 0;
+    prog_pid->watch      = 0;
+    g_hash_table_insert(monitored_pids, (gpointer) prog1, prog_pid);
+
+    failures = g_atomic_int_get(&check_failures);
+    (void) nhm_main_prog_exit_cb(NULL, G_IO_IN, (gpointer) prog1);
+
+    prog_pid = g_hash_table_lookup(monitored_pids, prog1);
+    retval = (   (prog_pid                          != NULL    )
+              && (prog_pid->pid                     == 100     )
+              && (g_atomic_int_get(&check_failures) == failures)) ? 0 : -1;
+  }
+
+  nhm_main_free_check_objects();
+
+  /* Check 9: Index of proc connector used. Running program found in it. */
+  if(retval == 0)
+  {
+    proc_events_pids  = g_hash_table_new(&g_direct_hash, &g_direct_equal);
+    proc_events_progs = g_hash_table_new(&g_str_hash, &g_str_equal);
+    g_hash_table_insert(proc_events_progs,
+                        (gpointer) g_intern_string("/usr/bin/valid_prog2"),
+                        GUINT_TO_POINTER(0));
+
+    progs[0] = "/usr/bin/valid_prog2";
+    nhm_main_proc_events_add_pid(101);
+    retval = (   (nhm_main_find_missing_prog(progs, NULL) == NULL)
+              && (g_hash_table_size(monitored_pids)       == 0   )) ? 0 : -1;
+  }
+
+  /* Check 10: Process exited. Program missing without scan of '/proc'. */
+  if(retval == 0)
+  {
+    nhm_main_proc_events_remove_pid(101);
+    retval = (   (g_strcmp0(nhm_main_find_missing_prog(progs, NULL),
+                            "/usr/bin/valid_prog2") == 0)
+              && (g_hash_table_size(monitored_pids) == 0)) ? 0 : -1;
+  }
+
+  /* Check 11: Watched process exited before its exit event. Other watched. */
+  if(retval == 0)
+  {
+    watch_progs = TRUE;
+    proc_dir    = g_strdup_printf("mkdir -p proc/%d", getpid());
+    system(proc_dir);
+    g_free(proc_dir);
+    proc_dir    = g_strdup_printf("proc/%d/stat", getpid());
+    g_file_set_contents(proc_dir,
+                        "1 (test) S 1 1 1 0 -1 4194560 100 0 0 0 "
+                        "0 0 0 0 20 0 1 0 3000 1000000 100",
+                        -1,
+                        NULL);
+    g_free(proc_dir);
+
+    g_hash_table_insert(proc_events_progs, (gpointer) prog1, GUINT_TO_POINTER(0));
+    nhm_main_proc_events_index_pid(100, (gpointer) prog1);
+    nhm_main_proc_events_index_pid(getpid(), (gpointer) prog1);
+
+    prog_pid             = g_slice_new(NhmProgPid);
+    prog_pid->pid        = 100;
+    prog_pid->start_time = 1000;
+    prog_pid->watch      = 0;
+    g_hash_table_insert(monitored_pids, (gpointer) prog1, prog_pid);
+
+    failures = g_atomic_int_get(&check_failures);
+    (void) nhm_main_prog_exit_cb(NULL, G_IO_IN, (gpointer) prog1);
+
+    prog_pid = g_hash_table_lookup(monitored_pids, prog1);
+    retval = (   (prog_pid                                       != NULL                )
+              && (prog_pid->pid                                  == getpid()            )
+              && (prog_pid->start_time                           == 3000                )
+              && (prog_pid->watch                                != 0                   )
+              && (g_hash_table_lookup(proc_events_progs, prog1)  == GUINT_TO_POINTER(1) )
+              && (g_atomic_int_get(&check_failures)              == failures            )) ? 0 : -1;
+  }
+
+  /* Check 12: Last process of program exits before its exit event. Reported. */
+  if(retval == 0)
+  {
+    watch = prog_pid->watch;
+    (void) nhm_main_prog_exit_cb(NULL, G_IO_IN, (gpointer) prog1);
+    g_source_remove(watch);
+
+    retval = (   (g_hash_table_lookup(monitored_pids, prog1)    == NULL                )
+              && (g_hash_table_lookup(proc_events_progs, prog1) == GUINT_TO_POINTER(0) )
+              && (g_atomic_int_get(&check_failures)             == failures + 1        )) ? 0 : -1;
+  }
+
+  watch_progs = FALSE;
+
+  nhm_main_free_check_objects();
+  system("rm -rf proc");
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_proc_events:
+ *
+ * Tests the update of the process index by the events of the proc connector.
+ * The events are sent as netlink messages through a local socket pair and
+ * received by 'nhm_main_proc_events_cb'.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_proc_events(void)
+{
+  gint         retval     = 0;
+  gchar       *progs[2]   = {"/usr/bin/valid_prog1", NULL};
+  const gchar *prog1      = g_intern_string("/usr/bin/valid_prog1");
+  gint         sockets[2] = {-1, -1};
+  GIOChannel  *channel    = NULL;
+
+  nhm_test_create_proc_dir();
+
+  proc_events_pids  = g_hash_table_new(&g_direct_hash, &g_direct_equal);
+  proc_events_progs = g_hash_table_new(&g_str_hash, &g_str_equal);
+  g_hash_table_insert(proc_events_progs, (gpointer) prog1, GUINT_TO_POINTER(0));
+  nhm_main_proc_events_scan();
+
+  retval = (   (socketpair(AF_UNIX, SOCK_DGRAM, 0, sockets)  == 0)
+            && (g_hash_table_lookup(proc_events_progs, prog1) == GUINT_TO_POINTER(1)))
+           ? 0 : -1;
+
+  if(retval == 0)
+  {
+    channel = g_io_channel_unix_new(sockets[0]);
+    g_io_channel_set_close_on_unref(channel, TRUE);
+  }
+
+  /* Check 1: Process of program forks. Child indexed for the program. */
+  if(retval == 0)
+  {
+    retval = (   (nhm_test_send_proc_event(channel, sockets[1], PROC_EVENT_FORK,
+                                           200, 200, 100)                == TRUE)
+              && (g_hash_table_lookup(proc_events_pids,
+                                      GINT_TO_POINTER(200))              == prog1)
+              && (g_hash_table_lookup(proc_events_progs, prog1)          == GUINT_TO_POINTER(2)))
+             ? 0 : -1;
+  }
+
+  /* Check 2: New thread and fork of other program. Not indexed. */
+  if(retval == 0)
+  {
+    retval = (   (nhm_test_send_proc_event(channel, sockets[1], PROC_EVENT_FORK,
+                                           201, 200, 100)                == TRUE)
+              && (nhm_test_send_proc_event(channel, sockets[1], PROC_EVENT_FORK,
+                                           300, 300, 101)                == TRUE)
+              && (g_hash_table_lookup(proc_events_pids,
+                                      GINT_TO_POINTER(201))              == NULL)
+              && (g_hash_table_lookup(proc_events_pids,
+                                      GINT_TO_POINTER(300))              == NULL)
+              && (g_hash_table_lookup(proc_events_progs, prog1)          == GUINT_TO_POINTER(2)))
+             ? 0 : -1;
+  }
+
+  /* Check 3: Parent exits. Program still runs in the forked child. */
+  if(retval == 0)
+  {
+    retval = (   (nhm_test_send_proc_event(channel, sockets[1], PROC_EVENT_EXIT,
+                                           201, 200, 0)                  == TRUE)
+              && (nhm_test_send_proc_event(channel, sockets[1], PROC_EVENT_EXIT,
+                                           100, 100, 0)                  == TRUE)
+              && (g_hash_table_lookup(proc_events_progs, prog1)          == GUINT_TO_POINTER(1))
+              && (nhm_main_find_missing_prog(progs, NULL)                == NULL))
+             ? 0 : -1;
+  }
+
+  /* Check 4: Child executes other program. Program missing. */
+  if(retval == 0)
+  {
+    retval = (   (nhm_test_send_proc_event(channel, sockets[1], PROC_EVENT_EXEC,
+                                           200, 200, 0)                  == TRUE)
+              && (g_hash_table_lookup(proc_events_pids,
+                                      GINT_TO_POINTER(200))              == NULL)
+              && (g_strcmp0(nhm_main_find_missing_prog(progs, NULL),
+                            prog1)                                       == 0))
+             ? 0 : -1;
+  }
+
+  /* Check 5: Other process executes program. Program running again. */
+  if(retval == 0)
+  {
+    system("mkdir -p proc/102");
+    system("ln -s /usr/bin/valid_prog1 proc/102/exe");
+
+    retval = (   (nhm_test_send_proc_event(channel, sockets[1], PROC_EVENT_EXEC,
+                                           102, 102, 0)                  == TRUE)
+              && (g_hash_table_lookup(proc_events_progs, prog1)          == GUINT_TO_POINTER(1))
+              && (nhm_main_find_missing_prog(progs, NULL)                == NULL))
+             ? 0 : -1;
+  }
+
+  if(channel != NULL)
+  {
+    g_io_channel_unref(channel);
+  }
+
+  if(sockets[1] >= 0)
+  {
+    close(sockets[1]);
+  }
+
+  nhm_main_free_check_objects();
+  system("rm -rf proc");
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_read_statistics:
+ *
+ * Tests the read statistics dbus interface of the NHM.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint nhm_test_read_statistics(void)
+{
+  NhmLcInfo *lc_info[3] = {0};
+  gint       retval     = 0;
+  gchar     *rmcmd      = NULL;
+
+  /*
+   * Create initial nodeinfo for the test:
+   *
+   * LC1: NHM_NODESTATE_SHUTDOWN. (App1, 3), (App2, 4), (App3, 5)
+   * LC2: NHM_NODESTATE_STARTED.  (App1, 4), (App2, 5)
+   * LC3: NHM_NODESTATE_SHUTDOWN. NULL
+   */
+
+  /* Create three LCs */
+  lc_info[0] = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
+  lc_info[1] = nhm_main_new_lc_info(NHM_NODESTATE_STARTED);
+  lc_info[2] = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
+
+  /* Add App1, App2 and App3 to LC1 */
+  (void) nhm_main_add_failed_app(lc_info[0], "App1", 3);
+  (void) nhm_main_add_failed_app(lc_info[0], "App2", 4);
+  (void) nhm_main_add_failed_app(lc_info[0], "App3", 5);
+
+  /* Add App1 and App2 to LC2 */
+  (void) nhm_main_add_failed_app(lc_info[1], "App1", 4);
+  (void) nhm_main_add_failed_app(lc_info[1], "App2", 5);
+
+  /* Create array and add LCs */
+  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  g_ptr_array_add(nodeinfo, lc_info[0]);
+  g_ptr_array_add(nodeinfo, lc_info[1]);
+  g_ptr_array_add(nodeinfo, lc_info[2]);
+
+  /*
+   * Create initial set of current failed apps: App1, App2, app3
+   */
+  current_failed_apps = g_hash_table_new(&g_str_hash, &g_str_equal);
+  g_hash_table_insert(current_failed_apps, "App1", "App1");
+  g_hash_table_insert(current_failed_apps, "App2", "App2");
+  g_hash_table_insert(current_failed_apps, "App3", "App3");
+
+  nhm_main_reset_lc_stats();
+
+  /* Check 1: Request info for "App1" for up to 5 LCs => 3 LCs are delivered */
+  max_lc_count = 5;
+
+  nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
+  nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
+  nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+
+  nhm_main_read_statistics_cb(NULL, NULL, "App1", NULL);
+
+  retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 3)
+            && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 7)
+            && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 3)) ? 0 : -1;
+
+  /* Check 2: Request info for "App1" for up to 1 LCs => 1 LC is delivered */
+  if(retval == 0)
+  {
+    max_lc_count = 0;
+
+    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+
+    nhm_main_read_statistics_cb(NULL, NULL, "App1", NULL);
+
+    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 3)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 3)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 1)) ? 0 : -1;
+  }
+
+  /* Check 3: Request node info for up to 5 LCs => 3 LCs are delivered */
+  if(retval == 0)
+  {
+    max_lc_count = 5;
+
+    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+
+    nhm_main_read_statistics_cb(NULL, NULL, "", NULL);
+
+    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 3)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 1)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 3)) ? 0 : -1;
+  }
+
+  /* Check 4: Request node info for up to 2 LCs => 2 LCs are delivered */
+  if(retval == 0)
+  {
+    max_lc_count = 1;
+
+    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+
+    nhm_main_read_statistics_cb(NULL, NULL, "", NULL);
+
+    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 3)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 1)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 2)) ? 0 : -1;
+  }
+
+  /* Check 5: Request app info for App4 for up to 2 LCs => 2 LCs are delivered */
+  if(retval == 0)
+  {
+    max_lc_count = 1;
+
+    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+
+    nhm_main_read_statistics_cb(NULL, NULL, "App4", NULL);
+
+    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 0)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 0)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 2)) ? 0 : -1;
+  }
+
+  /* Check 6: No current failed apps. Request node info for 2 LCs */
+  if(retval == 0)
+  {
+    max_lc_count = 1;
+
+    g_hash_table_remove_all(current_failed_apps);
+
+    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+
+    nhm_main_read_statistics_cb(NULL, NULL, "", NULL);
+
+    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 0)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 1)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 2)) ? 0 : -1;
+  }
+
+  /* Check 7: App1 and App4 fail in current LC => Statistics updated */
+  if(retval == 0)
+  {
+    max_lc_count = 1;
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+
+    nhm_main_register_app_status("App1", NhmAppStatus_Failed);
+    nhm_main_register_app_status("App4", NhmAppStatus_Failed);
+
+    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
+    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+
+    nhm_main_read_statistics_cb(NULL, NULL, "App1", NULL);
+
+    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 4)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 8)
+              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 2)) ? 0 : -1;
+
+    if(retval == 0)
+    {
+      nhm_main_read_statistics_cb(NULL, NULL, "App4", NULL);
+
+      retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 1)
+                && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 1)
+                && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 2)) ? 0 : -1;
+    }
+  }
+
+  /* Clean up objects after test */
+  nhm_main_reset_lc_stats();
+
+  g_hash_table_unref(current_failed_apps);
+  current_failed_apps = NULL;
+
+  g_ptr_array_unref(nodeinfo);
+
+  nhm_main_close_journal();
+  rmcmd = g_strdup_printf("rm -f %s %s", NHM_LC_DATA_FILE, NHM_LC_JOURNAL_FILE);
+  system(rmcmd);
+  g_free(rmcmd);
+
+  return retval;
+}
+
+/**
+ * nhm_test_read_all_statistics:
+ *
+ * Test the read all statistics interface.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint
+nhm_test_read_all_statistics(void)
+{
+  NhmLcInfo *lc_info[2]     = {NULL, NULL};
+  gint       retval         = 0;
+  GVariant  *app_statistics = NULL;
+  guint      current_fails  = 0;
+  guint      total_fails    = 0;
+  guint      lifecycles     = 0;
+
+  /*
+   * Create initial nodeinfo for the test:
+   *
+   * LC1: NHM_NODESTATE_SHUTDOWN. (App1, 3), (App2, 4)
+   * LC2: NHM_NODESTATE_STARTED.  (App1, 4), (Other, 1)
+   */
+  lc_info[0] = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
+  lc_info[1] = nhm_main_new_lc_info(NHM_NODESTATE_STARTED);
+
+  (void) nhm_main_add_failed_app(lc_info[0], "App1",  3);
+  (void) nhm_main_add_failed_app(lc_info[0], "App2",  4);
+  (void) nhm_main_add_failed_app(lc_info[1], "App1",  4);
+  (void) nhm_main_add_failed_app(lc_info[1], "Other", 1);
+
+  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  g_ptr_array_add(nodeinfo, lc_info[0]);
+  g_ptr_array_add(nodeinfo, lc_info[1]);
+
+  max_lc_count = 5;
+  nhm_main_reset_lc_stats();
+
+  /* Check 1: Empty prefix => All apps. of all LCs are delivered */
+  nhm_main_read_all_statistics_cb(NULL, NULL, "", NULL);
+  app_statistics = nhm_dbus_info_complete_read_all_statistics_stub_AppStatistics;
+
+  retval = (   (g_variant_n_children(app_statistics) == 3)
+            && (g_variant_lookup(app_statistics, "App1", "(uuu)",
+                                 &current_fails, &total_fails, &lifecycles) == TRUE)
+            && (current_fails == 3) && (total_fails == 7) && (lifecycles == 2)
+            && (g_variant_lookup(app_statistics, "Other", "(uuu)",
+                                 &current_fails, &total_fails, &lifecycles) == TRUE)
+            && (current_fails == 0) && (total_fails == 1) && (lifecycles == 2)) ? 0 : -1;
+
+  /* Check 2: Prefix "App" => Only App1 and App2 are delivered */
+  if(retval == 0)
+  {
+    nhm_main_read_all_statistics_cb(NULL, NULL, "App", NULL);
+    app_statistics = nhm_dbus_info_complete_read_all_statistics_stub_AppStatistics;
+
+    retval = (   (g_variant_n_children(app_statistics) == 2)
+              && (g_variant_lookup(app_statistics, "App2", "(uuu)",
+                                   &current_fails, &total_fails, &lifecycles) == TRUE)
+              && (current_fails == 4) && (total_fails == 4) && (lifecycles == 2)) ? 0 : -1;
+  }
+
+  /* Check 3: Unknown prefix => Empty dictionary */
+  if(retval == 0)
+  {
+    nhm_main_read_all_statistics_cb(NULL, NULL, "Unknown", NULL);
+    app_statistics = nhm_dbus_info_complete_read_all_statistics_stub_AppStatistics;
+
+    retval = (g_variant_n_children(app_statistics) == 0) ? 0 : -1;
+  }
+
+  /* Clean up objects after test */
+  nhm_main_reset_lc_stats();
+  g_ptr_array_unref(nodeinfo);
+
+  return retval;
+}
+
+/**
+ * nhm_test_register_app_status:
+ *
+ * Tests the register app status dbus interface of the NHM.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint
+nhm_test_register_app_status(void)
+{
+  gint       retval          = 0;
+  NhmLcInfo *initial_lc_info = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
+  gchar     *rmcmd           = NULL;
+
+  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  g_ptr_array_add(nodeinfo, initial_lc_info);
+  current_failed_apps = g_hash_table_new(&g_str_hash, &g_str_equal);
+
+  /* Check 1: App1 fails. NSM nok => App1 in current_failed_apps */
+  nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = TRUE;
+  nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Failed, NULL);
+  retval = (nhm_main_find_current_failed_app("App1") != NULL) ? 0 : -1;
+
+  /* Check 2: App2 fails. NSM ok  => App2 in current_failed_apps */
+  if(retval == 0)
+  {
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+    nhm_main_register_app_status_cb(NULL, NULL, "App2", NhmAppStatus_Failed, NULL);
+    retval = (nhm_main_find_current_failed_app("App2") != NULL) ? 0 : -1;
+  }
+
+  /* Check 3: App1 becomes valid. NSM ok => App1 not in current_failed_apps */
+  if(retval == 0)
+  {
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+    nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Ok, NULL);
+    retval = (nhm_main_find_current_failed_app("App1") == NULL) ? 0 : -1;
+  }
+
+  /* Check 4: App2 becomes valid. NSM ok => App2 not in current_failed_apps */
+  if(retval == 0)
+  {
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+    nhm_main_register_app_status_cb(NULL, NULL, "App2", NhmAppStatus_Ok, NULL);
+    retval = (nhm_main_find_current_failed_app("App2") == NULL) ? 0 : -1;
+  }
+
+  /* Check 5: App1 becomes valid. NSM ok => App1 not in current_failed_apps */
+  if(retval == 0)
+  {
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+    nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Ok, NULL);
+    retval = (nhm_main_find_current_failed_app("App1") == NULL) ? 0 : -1;
+  }
+
+  /* Check 6: App1 fails. NSM ok => App1 in current_failed_apps */
+  if(retval == 0)
+  {
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+    nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Failed, NULL);
+    retval = (nhm_main_find_current_failed_app("App1") != NULL) ? 0 : -1;
+  }
+
+  /* Check 7: App1 fails. NSM ok => App1 in current_failed_apps */
+  if(retval == 0)
+  {
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+    nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Failed, NULL);
+    retval = (nhm_main_find_current_failed_app("App1") != NULL) ? 0 : -1;
+  }
+
+  /* Clean up objects created during the test */
+  g_hash_table_unref(current_failed_apps);
+  current_failed_apps = NULL;
+
+  g_ptr_array_unref(nodeinfo);
+
+  nhm_main_close_journal();
+  rmcmd = g_strdup_printf("rm -f %s %s", NHM_LC_DATA_FILE, NHM_LC_JOURNAL_FILE);
+  system(rmcmd);
+  g_free(rmcmd);
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_register_batch:
+ *
+ * Tests the register app status batch dbus interface of the NHM.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint
+nhm_test_register_batch(void)
+{
+  gint             retval          = 0;
+  NhmLcInfo       *initial_lc_info = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
+  gchar           *rmcmd           = NULL;
+  GVariantBuilder  builder;
+  GVariant        *batch           = NULL;
+
+  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  g_ptr_array_add(nodeinfo, initial_lc_info);
+  current_failed_apps = g_hash_table_new(&g_str_hash, &g_str_equal);
+
+  nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+  nsm_dbus_lc_control_call_set_app_health_status_stub_calls            = 0;
+  nhm_dbus_info_emit_app_health_status_stub_called                     = 0;
+  nhm_dbus_info_emit_app_health_status_batch_stub_called               = 0;
+  nhm_dbus_info_complete_register_app_status_batch_stub_called         = 0;
+
+  /* Check 1: App1 fails, App2 fails, App1 recovers => Only App2 failed */
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a(si)"));
+  g_variant_builder_add(&builder, "(si)", "App1", NhmAppStatus_Failed);
+  g_variant_builder_add(&builder, "(si)", "App2", NhmAppStatus_Failed);
+  g_variant_builder_add(&builder, "(si)", "App1", NhmAppStatus_Ok);
+  batch = g_variant_ref_sink(g_variant_builder_end(&builder));
+
+  nhm_main_register_batch_cb(NULL, NULL, batch, NULL);
+
+  retval = (   (nhm_main_find_current_failed_app("App1")                       == NULL)
+            && (nhm_main_find_current_failed_app("App2")                       != NULL)
+            && (nhm_main_find_failed_app(initial_lc_info, "App1")->failcount   == 1   )
+            && (nhm_main_find_failed_app(initial_lc_info, "App2")->failcount   == 1   )
+            && (nsm_dbus_lc_control_call_set_app_health_status_stub_calls      == 3   )
+            && (nhm_dbus_info_emit_app_health_status_stub_called               == 0   )
+            && (nhm_dbus_info_emit_app_health_status_batch_stub_called         == 1   )
+            && (nhm_dbus_info_complete_register_app_status_batch_stub_called   == 1   )) ? 0 : -1;
+
+  g_variant_unref(batch);
+
+  /* Check 2: Empty batch => Signal sent, call completed, nothing changed */
+  if(retval == 0)
+  {
+    batch = g_variant_ref_sink(g_variant_new_array(G_VARIANT_TYPE("(si)"), NULL, 0));
+
+    nhm_main_register_batch_cb(NULL, NULL, batch, NULL);
+
+    retval = (   (g_hash_table_size(current_failed_apps)                         == 1)
+              && (nhm_dbus_info_emit_app_health_status_batch_stub_called         == 2)
+              && (nhm_dbus_info_complete_register_app_status_batch_stub_called   == 2)) ? 0 : -1;
+
+    g_variant_unref(batch);
+  }
+
+  /* Clean up objects created during the test */
+  g_hash_table_unref(current_failed_apps);
+  current_failed_apps = NULL;
+
+  g_ptr_array_unref(nodeinfo);
+
+  nhm_main_close_journal();
+  rmcmd = g_strdup_printf("rm -f %s %s", NHM_LC_DATA_FILE, NHM_LC_JOURNAL_FILE);
+  system(rmcmd);
+  g_free(rmcmd);
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_file_size:
+ * @file_name: File whose size should be returned
+ *
+ * Helper to get the size of a file.
+ *
+ * Returns the size of the file in bytes or 0, if the file does not exist.
+ */
+static gsize
+nhm_test_file_size(const gchar *file_name)
+{
+  gchar *content = NULL;
+  gsize  length  = 0;
+
+  if(g_file_get_contents(file_name, &content, &length, NULL) == TRUE)
+  {
+    g_free(content);
+  }
+  else
+  {
+    length = 0;
+  }
+
+  return length;
+}
+
+
+/**
+ * nhm_test_exit_proc_check:
+ * @check:  Running check of a monitored proc.
+ * @status: Wait status of the proc.
+ *
+ * Helper to simulate the exit of a monitored proc. Like the main loop, the
+ * child watch is removed before the callback is called.
+ */
+static void
+nhm_test_exit_proc_check(NhmProcCheck *check,
+                         gint          status)
+{
+  g_source_remove(check->child_watch);
+  nhm_main_proc_check_exit_cb(check->pid, status, check);
+}
+
+
+/**
+ * nhm_test_run_userland_check:
+ *
+ * Helper to run all userland checks once. The checks are scheduled with an
+ * interval of 1 s and the timer wheel is advanced by one tick.
+ */
+static void
+nhm_test_run_userland_check(void)
+{
+  ul_chk_interval = 1;
+
+  nhm_main_schedule_checks();
+  nhm_main_wheel_advance();
+
+  ul_chk_interval = 0;
+}
+
+
+/**
+ * nhm_test_queue_proc_checks:
+ *
+ * Helper to queue the checks of all monitored procs, like the timer wheel
+ * does, when their checks are due.
+ */
+static void
+nhm_test_queue_proc_checks(void)
+{
+  guint proc_idx = 0;
+
+  for(proc_idx = 0; monitored_procs[proc_idx] != NULL; proc_idx++)
+  {
+    nhm_main_queue_proc_check(monitored_procs[proc_idx]);
+  }
+}
+
+
+/**
+ * nhm_test_has_check_status:
+ * @report: Health report of the NHM.
+ * @name:   Name of the check.
+ * @status: Expected status of the check.
+ *
+ * Helper to look up the status of a check in a health report.
+ *
+ * Returns %TRUE, if the check is in the report and has the status.
+ */
+static gboolean
+nhm_test_has_check_status(GVariant    *report,
+                          const gchar *name,
+                          const gchar *status)
+{
+  GVariant    *checks       = NULL;
+  GVariant    *check        = NULL;
+  const gchar *check_status = NULL;
+  gboolean     retval       = FALSE;
+
+  if(g_variant_lookup(report, "Checks", "@a{sa{sv}}", &checks) == TRUE)
+  {
+    if(g_variant_lookup(checks, name, "@a{sv}", &check) == TRUE)
+    {
+      retval =    (g_variant_lookup(check, "Status", "&s", &check_status) == TRUE)
+               && (g_strcmp0(check_status, status)                       == 0   );
+
+      g_variant_unref(check);
+    }
+
+    g_variant_unref(checks);
+  }
+
+  return retval;
+}
+
+
+/**
+ * nhm_test_restart_lc:
+ *
+ * Helper to simulate a restart of the NHM. The LC data is dropped and a new
+ * LC is started with the data read from the LC data file and journal.
+ */
+static void
+nhm_test_restart_lc(void)
+{
+  nhm_main_close_journal();
+  g_ptr_array_unref(nodeinfo);
+
+  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  g_ptr_array_add(nodeinfo, nhm_main_new_lc_info(NHM_NODESTATE_STARTED));
+
+  nhm_main_read_data();
+}
+
+
+/**
+ * nhm_test_create_proc_dir:
+ *
+ * Helper to create a local process folder, which is used by the NHM instead
+ * of '/proc'. The processes 100 and 101 run '/usr/bin/valid_prog1' and
+ * '/usr/bin/valid_prog2'. Their start times are 1000 and 2000. The command
+ * names contain spaces and brackets, like real command names can do.
+ */
+static void
+nhm_test_create_proc_dir(void)
+{
+  system("rm -rf proc");
+  system("mkdir -p proc/100 proc/101");
+  system("ln -s /usr/bin/valid_prog1 proc/100/exe");
+  system("ln -s /usr/bin/valid_prog2 proc/101/exe");
+
+  g_file_set_contents("proc/100/stat",
+                      "100 (valid (prog1)) S 1 100 100 0 -1 4194560 100 0 0 0 "
+                      "0 0 0 0 20 0 1 0 1000 1000000 100",
+                      -1,
+                      NULL);
+  g_file_set_contents("proc/101/stat",
+                      "101 (valid prog2) S 1 101 101 0 -1 4194560 100 0 0 0 "
+                      "0 0 0 0 20 0 1 0 2000 1000000 100",
+                      -1,
+                      NULL);
+}
+
+
+/**
+ * nhm_test_send_proc_event:
+ * @channel:     Channel of the receiving socket.
+ * @sock_fd:     Sending socket.
+ * @what:        Type of the event.
+ * @pid:         ID of the (child) thread.
+ * @tgid:        ID of the (child) process.
+ * @parent_tgid: ID of the parent process of a fork.
+ *
+ * Helper to send an event of the proc connector as netlink message and to
+ * process it with 'nhm_main_proc_events_cb'.
+ *
+ * Return value: Return value of 'nhm_main_proc_events_cb'.
+ */
+static gboolean
+nhm_test_send_proc_event(GIOChannel *channel,
+                         gint        sock_fd,
+                         guint       what,
+                         glong       pid,
+                         glong       tgid,
+                         glong       parent_tgid)
+{
+  struct cn_msg     *msg   = NULL;
+  struct proc_event *event = NULL;
+  union
+  {
+    struct nlmsghdr hdr;
+    gchar           buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(struct proc_event))];
+  } req;
+
+  memset(&req, 0, sizeof(req));
+  req.hdr.nlmsg_len  = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(struct proc_event));
+  req.hdr.nlmsg_type = NLMSG_DONE;
+  msg                = (struct cn_msg*) NLMSG_DATA(&req.hdr);
+  msg->id.idx        = CN_IDX_PROC;
+  msg->id.val        = CN_VAL_PROC;
+  msg->len           = sizeof(struct proc_event);
+  event              = (struct proc_event*) msg->data;
+  event->what        = what;
+
+  switch(what)
+  {
+    case PROC_EVENT_FORK:
+      event->event_data.fork.parent_pid  = parent_tgid;
+      event->event_data.fork.parent_tgid = parent_tgid;
+      event->event_data.fork.child_pid   = pid;
+      event->event_data.fork.child_tgid  = tgid;
+    break;
+
+    case PROC_EVENT_EXEC:
+      event->event_data.exec.process_pid  = pid;
+      event->event_data.exec.process_tgid = tgid;
+    break;
+
+    default:
+      event->event_data.exit.process_pid  = pid;
+      event->event_data.exit.process_tgid = tgid;
+    break;
+  }
+
+  (void) send(sock_fd, &req, req.hdr.nlmsg_len, 0);
+
+  return nhm_main_proc_events_cb(channel, G_IO_IN, NULL);
+}
+
+
+/**
+ * nhm_test_write_behind:
+ *
+ * Tests the delayed writing of the LC data.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint
+nhm_test_write_behind(void)
+{
+  gint       retval          = 0;
+  NhmLcInfo *initial_lc_info = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
+  gchar     *rmcmd           = NULL;
+  gsize      header_size     = sizeof(NhmJournalHeader);
+  gsize      record_size     = sizeof(NhmJournalRecord);
+
+  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  g_ptr_array_add(nodeinfo, initial_lc_info);
+  current_failed_apps = g_hash_table_new(&g_str_hash, &g_str_equal);
 
-  nhm_main_free_check_objects();
-  nhm_main_free_config_objects();
+  nhm_main_close_journal();
+  rmcmd = g_strdup_printf("rm -f %s %s", NHM_LC_DATA_FILE, NHM_LC_JOURNAL_FILE);
+  system(rmcmd);
 
-  /* Check 5: No monitored files. monitored progs ok. Monitored procs. ok. No monitored dbus. */
-  monitored_files       = NULL;
-  my_monitored_progs[0] = "/usr/bin/valid_prog1";
-  monitored_progs       = g_strdupv(my_monitored_progs);
-  monitored_procs       = g_strdupv(my_monitored_procs);
-  checked_dbusses       = NULL;
-  nhm_main_timer_userland_check_cb(NULL);
+  max_lc_count = 5;
+  memset(&lc_data_stats, 0, sizeof(lc_data_stats));
+  nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
 
-  nhm_main_free_check_objects();
-  nhm_main_free_config_objects();
+  /* Check 1: No delay. App1 fails, no journal => All data written at once */
+  lc_data_write_delay = 0;
+  nhm_main_register_app_status("App1", NhmAppStatus_Failed);
 
-  /* Check 6: monitored files nok. monitored progs ok. Monitored procs. ok. No monitored dbus. */
-  monitored_files       = g_strdupv(my_monitored_files);
-  monitored_progs       = g_strdupv(my_monitored_progs);
-  monitored_procs       = g_strdupv(my_monitored_procs);
-  checked_dbusses       = NULL;
-  nhm_main_timer_userland_check_cb(NULL);
+  retval = (   (nhm_does_file_exist(NHM_LC_DATA_FILE)     == TRUE       )
+            && (nhm_test_file_size(NHM_LC_JOURNAL_FILE)   == header_size)
+            && (lc_data_changes                           == 0          )
+            && (lc_data_timer                             == 0          )
+            && (lc_data_stats.flushes                     == 1          )
+            && (lc_data_stats.snapshots                   == 1          )) ? 0 : -1;
 
-  nhm_main_free_check_objects();
-  nhm_main_free_config_objects();
+  /* Check 2: Delay. App2 and App3 fail => Nothing written, timer started */
+  if(retval == 0)
+  {
+    lc_data_write_delay = 1000;
+    nhm_main_register_app_status("App2", NhmAppStatus_Failed);
+    nhm_main_register_app_status("App3", NhmAppStatus_Failed);
+
+    retval = (   (nhm_test_file_size(NHM_LC_JOURNAL_FILE) == header_size)
+              && (lc_data_changes                         == 2          )
+              && (lc_data_timer                           != 0          )
+              && (lc_data_stats.flushes                   == 1          )) ? 0 : -1;
+  }
 
-  /* Check 7: monitored files ok. monitored progs ok. Monitored procs. ok. No monitored dbus. */
-  my_monitored_files[0] = "valid_file";
-  monitored_files       = g_strdupv(my_monitored_files);
-  monitored_progs       = g_strdupv(my_monitored_progs);
-  monitored_procs       = g_strdupv(my_monitored_procs);
-  checked_dbusses       = NULL;
-  nhm_main_timer_userland_check_cb(NULL);
+  /* Check 3: Timer elapses => Both changes appended at once */
+  if(retval == 0)
+  {
+    (void) nhm_main_timer_write_data_cb(NULL);
+
+    retval = (   (nhm_test_file_size(NHM_LC_JOURNAL_FILE) == header_size + 2 * record_size)
+              && (lc_data_changes                         == 0   )
+              && (lc_data_timer                           == 0   )
+              && (lc_data_stats.flushes                   == 2   )
+              && (lc_data_stats.snapshots                 == 1   )
+              && (lc_data_stats.records                   == 2   )
+              && (lc_data_stats.coalesced                 == 1   )) ? 0 : -1;
+  }
 
-  nhm_main_free_check_objects();
-  nhm_main_free_config_objects();
+  /* Check 4: App4 fails, NSM shuts down => Change flushed before timer */
+  if(retval == 0)
+  {
+    nhm_main_register_app_status("App4", NhmAppStatus_Failed);
+    (void) nhm_main_lc_request_cb(NULL, NULL, NSM_SHUTDOWNTYPE_NORMAL, 0, NULL);
 
-  /* Check 8: monitored files ok. monitored progs ok. Monitored procs. ok. Monitored dbus nok */
-  monitored_files       = g_strdupv(my_monitored_files);
-  monitored_progs       = g_strdupv(my_monitored_progs);
-  monitored_procs       = g_strdupv(my_monitored_procs);
-  checked_dbusses       = g_ptr_array_new();
+    retval = (   (nhm_test_file_size(NHM_LC_JOURNAL_FILE) == header_size + 3 * record_size)
+              && (lc_data_changes                         == 0   )
+              && (lc_data_timer                           == 0   )
+              && (lc_data_stats.flushes                   == 3   )) ? 0 : -1;
+  }
 
-  g_ptr_array_add(checked_dbusses, (gpointer) &my_checked_dbus);
-  g_dbus_connection_new_for_address_sync_stub_set_error = TRUE;
-  g_dbus_connection_new_for_address_sync_stub_set_error = TRUE;
-  nhm_main_timer_userland_check_cb(NULL);
+  /* Check 5: Nothing changed, NSM shuts down => Nothing written */
+  if(retval == 0)
+  {
+    (void) nhm_main_lc_request_cb(NULL, NULL, NSM_SHUTDOWNTYPE_NORMAL, 0, NULL);
 
-  nhm_main_free_check_objects();
-  nhm_main_free_config_objects();
+    retval = (lc_data_stats.flushes == 3) ? 0 : -1;
+  }
 
-  /* Check 9: monitored files ok. monitored progs ok. Monitored procs. ok. Monitored dbus ok */
-  monitored_files       = g_strdupv(my_monitored_files);
-  monitored_progs       = g_strdupv(my_monitored_progs);
-  monitored_procs       = g_strdupv(my_monitored_procs);
-  checked_dbusses       = g_ptr_array_new();
+  /* Clean up objects created during the test */
+  lc_data_write_delay = 0;
 
-  g_ptr_array_add(checked_dbusses, (gpointer) &my_checked_dbus);
-  g_dbus_connection_new_for_address_sync_stub_set_error = FALSE;
-  g_dbus_connection_new_for_address_sync_stub_set_error = FALSE;
-  nhm_main_timer_userland_check_cb(NULL);
+  g_hash_table_unref(current_failed_apps);
+  current_failed_apps = NULL;
 
-  nhm_main_free_check_objects();
-  nhm_main_free_config_objects();
+  g_ptr_array_unref(nodeinfo);
 
-  return 0;
+  nhm_main_close_journal();
+  system(rmcmd);
+  g_free(rmcmd);
+
+  return retval;
 }
 
 
 /**
- * nhm_test_read_statistics:
+ * nhm_test_lc_journal:
  *
- * Tests the read statistics dbus interface of the NHM.
+ * Tests storing the changes of the current LC in the journal and restoring
+ * them from the journal after a restart.
  *
  * Returns 0, if test succeeds. Otherwise, it will return -1.
  */
-static gint nhm_test_read_statistics(void)
+static gint
+nhm_test_lc_journal(void)
 {
-  guint               app_idx                = 0;
-  NhmLcInfo           *lc_info[3]            = {0};
-  NhmFailedApp        *lc_apps[5]            = {0};
-  NhmCurrentFailedApp *current_failed_app[3] = {0};
-  gint                 retval                = 0;
+  gint          retval          = 0;
+  NhmLcInfo    *initial_lc_info = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
+  NhmLcInfo    *prev_lc_info    = NULL;
+  gchar        *rmcmd           = NULL;
+  gchar        *journal         = NULL;
+  gsize         journal_len     = 0;
+  FILE         *file            = NULL;
+  gsize         header_size     = sizeof(NhmJournalHeader);
+  gsize         record_size     = sizeof(NhmJournalRecord);
 
-  /*
-   * Create initial nodeinfo for the test:
-   *
-   * LC1: NHM_NODESTATE_SHUTDOWN. (App1, 3), (App2, 4), (App3, 5)
-   * LC2: NHM_NODESTATE_STARTED.  (App1, 4), (App2, 5)
-   * LC3: NHM_NODESTATE_SHUTDOWN. NULL
-   */
+  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  g_ptr_array_add(nodeinfo, initial_lc_info);
+  (void) nhm_main_add_failed_app(initial_lc_info, "App1", 1);
+  current_failed_apps = g_hash_table_new(&g_str_hash, &g_str_equal);
 
-  /* Create five apps that will be assigned to the LCs */
-  lc_apps[0]            = g_new(NhmFailedApp, 1);
-  lc_apps[0]->name      = g_strdup("App1");
-  lc_apps[0]->failcount = 3;
+  nhm_main_close_journal();
+  rmcmd = g_strdup_printf("rm -f %s %s", NHM_LC_DATA_FILE, NHM_LC_JOURNAL_FILE);
+  system(rmcmd);
 
-  lc_apps[1]            = g_new(NhmFailedApp, 1);
-  lc_apps[1]->name      = g_strdup("App2");
-  lc_apps[1]->failcount = 4;
+  max_lc_count        = 5;
+  lc_data_write_delay = 0;
+  nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
 
-  lc_apps[2]            = g_new(NhmFailedApp, 1);
-  lc_apps[2]->name      = g_strdup("App3");
-  lc_apps[2]->failcount = 5;
+  /* Check 1: LC started, App2 and App1 fail => One record per failure */
+  nhm_main_write_data();
+  nhm_main_register_app_status("App2", NhmAppStatus_Failed);
+  nhm_main_register_app_status("App1", NhmAppStatus_Failed);
 
-  lc_apps[3]            = g_new(NhmFailedApp, 1);
-  lc_apps[3]->name      = g_strdup("App1");
-  lc_apps[3]->failcount = 4;
+  retval = (   (nhm_test_file_size(NHM_LC_JOURNAL_FILE)         == header_size + 2 * record_size)
+            && (nhm_main_find_failed_app(initial_lc_info, "App1")->failcount == 2)) ? 0 : -1;
 
-  lc_apps[4]            = g_new(NhmFailedApp, 1);
-  lc_apps[4]->name      = g_strdup("App2");
-  lc_apps[4]->failcount = 5;
+  /* Check 2: Restart => Previous LC restored from LC data and journal */
+  if(retval == 0)
+  {
+    nhm_test_restart_lc();
+    prev_lc_info = (nodeinfo->len == 2) ? g_ptr_array_index(nodeinfo, 1) : NULL;
+
+    retval = (   (prev_lc_info                                          != NULL)
+              && (prev_lc_info->start_state              == NHM_NODESTATE_SHUTDOWN)
+              && (g_hash_table_size(nhm_main_get_failed_apps(prev_lc_info)) == 2)
+              && (nhm_main_find_failed_app(prev_lc_info, "App1")->failcount == 2)
+              && (nhm_main_find_failed_app(prev_lc_info, "App2")->failcount == 1)) ? 0 : -1;
+  }
 
-  /* Create three LCs */
-  lc_info[0]              = g_new(NhmLcInfo, 1);
-  lc_info[0]->start_state = NHM_NODESTATE_SHUTDOWN;
-  lc_info[0]->failed_apps = NULL;
+  /* Check 3: Torn record at end of journal => Complete records restored */
+  if(retval == 0)
+  {
+    file = fopen(NHM_LC_JOURNAL_FILE, "a");
+    fwrite("NHMR", 4, 1, file);
+    fclose(file);
 
-  lc_info[1]              = g_new(NhmLcInfo, 1);
-  lc_info[1]->start_state = NHM_NODESTATE_STARTED;
-  lc_info[1]->failed_apps = NULL;
+    nhm_test_restart_lc();
+    prev_lc_info = (nodeinfo->len == 2) ? g_ptr_array_index(nodeinfo, 1) : NULL;
 
-  lc_info[2]              = g_new(NhmLcInfo, 1);
-  lc_info[2]->start_state = NHM_NODESTATE_SHUTDOWN;
-  lc_info[2]->failed_apps = NULL;
+    retval = (   (prev_lc_info                                          != NULL)
+              && (nhm_main_find_failed_app(prev_lc_info, "App1")->failcount == 2)
+              && (nhm_main_find_failed_app(prev_lc_info, "App2")->failcount == 1)) ? 0 : -1;
+  }
 
-  /* Add lc_apps[0], lc_apps[1] and lc_apps[2] to list of LC1 */
-  lc_info[0]->failed_apps = g_slist_append(lc_info[0]->failed_apps, lc_apps[0]);
-  lc_info[0]->failed_apps = g_slist_append(lc_info[0]->failed_apps, lc_apps[1]);
-  lc_info[0]->failed_apps = g_slist_append(lc_info[0]->failed_apps, lc_apps[2]);
+  /* Check 4: Last complete record corrupted => Only first record restored */
+  if(retval == 0)
+  {
+    file = fopen(NHM_LC_JOURNAL_FILE, "r+");
+    fseek(file, header_size + record_size + 10, SEEK_SET);
+    fputc('X', file);
+    fclose(file);
 
-  /* Add lc_apps[4] and lc_apps[5] to list of LC2*/
-  lc_info[1]->failed_apps = g_slist_append(lc_info[1]->failed_apps, lc_apps[3]);
-  lc_info[1]->failed_apps = g_slist_append(lc_info[1]->failed_apps, lc_apps[4]);
+    nhm_test_restart_lc();
+    prev_lc_info = (nodeinfo->len == 2) ? g_ptr_array_index(nodeinfo, 1) : NULL;
 
-  /* Create array and add LCs */
-  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
-  g_ptr_array_add(nodeinfo, lc_info[0]);
-  g_ptr_array_add(nodeinfo, lc_info[1]);
-  g_ptr_array_add(nodeinfo, lc_info[2]);
+    retval = (   (prev_lc_info                                          != NULL)
+              && (nhm_main_find_failed_app(prev_lc_info, "App1")->failcount == 1)
+              && (nhm_main_find_failed_app(prev_lc_info, "App2")->failcount == 1)) ? 0 : -1;
+  }
 
-  /*
-   * Create initial list of current failed apps: App1, App2, app3
-   */
-  current_failed_app[0]       = g_new(NhmCurrentFailedApp, 1);
-  current_failed_app[0]->name = g_strdup("App1");
+  /* Check 5: LC data written again, old journal restored => Journal ignored */
+  if(retval == 0)
+  {
+    (void) g_file_get_contents(NHM_LC_JOURNAL_FILE, &journal, &journal_len, NULL);
+    nhm_main_write_data();
+    (void) g_file_set_contents(NHM_LC_JOURNAL_FILE, journal, journal_len, NULL);
+    g_free(journal);
 
-  current_failed_app[1]       = g_new(NhmCurrentFailedApp, 1);
-  current_failed_app[1]->name = g_strdup("App2");
+    nhm_test_restart_lc();
 
-  current_failed_app[2]       = g_new(NhmCurrentFailedApp, 1);
-  current_failed_app[2]->name = g_strdup("App3");
+    retval = (   (nodeinfo->len                                         == 3)
+              && (g_hash_table_size(nhm_main_get_failed_apps(g_ptr_array_index(nodeinfo, 1))) == 0)
+              && (g_hash_table_size(nhm_main_get_failed_apps(g_ptr_array_index(nodeinfo, 2))) == 2)) ? 0 : -1;
+  }
 
+  /* Clean up objects created during the test */
+  g_hash_table_unref(current_failed_apps);
   current_failed_apps = NULL;
-  for(app_idx = 0; app_idx < sizeof(current_failed_app)/sizeof(NhmCurrentFailedApp); app_idx++)
-  {
-    current_failed_apps = g_slist_append(current_failed_apps, current_failed_app[app_idx]);
-  }
 
-  /* Check 1: Request info for "App1" for up to 5 LCs => 3 LCs are delivered */
-  max_lc_count = 5;
+  g_ptr_array_unref(nodeinfo);
 
-  nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
-  nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
-  nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+  nhm_main_close_journal();
+  system(rmcmd);
+  g_free(rmcmd);
 
-  nhm_main_read_statistics_cb(NULL, NULL, "App1", NULL);
+  return retval;
+}
 
-  retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 3)
-            && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 7)
-            && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 3)) ? 0 : -1;
 
-  /* Check 2: Request info for "App1" for up to 1 LCs => 1 LC is delivered */
-  if(retval == 0)
-  {
-    max_lc_count = 0;
+/**
+ * nhm_test_lc_data_format:
+ *
+ * Tests reading and writing of the LC data file. LCs that are read from the
+ * file should only be decoded, when they are accessed.
+ *
+ * Returns 0, if test succeeds. Otherwise, it will return -1.
+ */
+static gint
+nhm_test_lc_data_format(void)
+{
+  gint        retval      = 0;
+  NhmLcInfo  *lc_info[3]  = {NULL, NULL, NULL};
+  gchar      *rmcmd       = NULL;
+  GByteArray *legacy      = NULL;
+  guint       legacy_val  = 0;
+  gchar      *data        = NULL;
+  gsize       data_len    = 0;
+
+  /* Create three LCs. LC1 without apps, App1 failed in LC2 and LC3. */
+  lc_info[0] = nhm_main_new_lc_info(NHM_NODESTATE_STARTED);
+  lc_info[1] = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
+  lc_info[2] = nhm_main_new_lc_info(NHM_NODESTATE_STARTED);
+
+  (void) nhm_main_add_failed_app(lc_info[1], "App1", 2);
+  (void) nhm_main_add_failed_app(lc_info[1], "App2", 3);
+  (void) nhm_main_add_failed_app(lc_info[2], "App1", 4);
 
-    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+  nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
+  g_ptr_array_add(nodeinfo, lc_info[0]);
+  g_ptr_array_add(nodeinfo, lc_info[1]);
+  g_ptr_array_add(nodeinfo, lc_info[2]);
 
-    nhm_main_read_statistics_cb(NULL, NULL, "App1", NULL);
+  nhm_main_close_journal();
+  rmcmd = g_strdup_printf("rm -f %s %s", NHM_LC_DATA_FILE, NHM_LC_JOURNAL_FILE);
+  system(rmcmd);
 
-    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 3)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 3)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 1)) ? 0 : -1;
-  }
+  max_lc_count = 5;
 
-  /* Check 3: Request node info for up to 5 LCs => 3 LCs are delivered */
-  if(retval == 0)
-  {
-    max_lc_count = 5;
+  /* Check 1: Data written and read => LCs restored, but not decoded */
+  nhm_main_write_data();
+  nhm_test_restart_lc();
 
-    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+  lc_info[0] = (nodeinfo->len == 4) ? g_ptr_array_index(nodeinfo, 1) : NULL;
+  lc_info[1] = (nodeinfo->len == 4) ? g_ptr_array_index(nodeinfo, 2) : NULL;
+  lc_info[2] = (nodeinfo->len == 4) ? g_ptr_array_index(nodeinfo, 3) : NULL;
 
-    nhm_main_read_statistics_cb(NULL, NULL, "", NULL);
+  retval = (   (lc_info[0]              != NULL                  )
+            && (lc_info[0]->start_state == NHM_NODESTATE_STARTED )
+            && (lc_info[0]->failed_apps == NULL                  )
+            && (lc_info[1]->start_state == NHM_NODESTATE_SHUTDOWN)
+            && (lc_info[1]->failed_apps == NULL                  )
+            && (lc_info[1]->app_count   == 2                     )
+            && (lc_info[2]->failed_apps == NULL                  )) ? 0 : -1;
 
-    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 3)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 1)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 3)) ? 0 : -1;
+  /* Check 2: Access LC3 => Only LC3 is decoded */
+  if(retval == 0)
+  {
+    retval = (   (nhm_main_find_failed_app(lc_info[2], "App1")->failcount == 4   )
+              && (nhm_main_find_failed_app(lc_info[2], "App2")            == NULL)
+              && (lc_info[2]->map                                         == NULL)
+              && (lc_info[1]->failed_apps                                 == NULL)) ? 0 : -1;
   }
 
-  /* Check 4: Request node info for up to 2 LCs => 2 LCs are delivered */
+  /* Check 3: Data written with undecoded LCs and read => LCs unchanged */
   if(retval == 0)
   {
-    max_lc_count = 1;
-
-    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+    nhm_main_write_data();
+    nhm_test_restart_lc();
 
-    nhm_main_read_statistics_cb(NULL, NULL, "", NULL);
+    lc_info[0] = (nodeinfo->len == 5) ? g_ptr_array_index(nodeinfo, 3) : NULL;
+    lc_info[1] = (nodeinfo->len == 5) ? g_ptr_array_index(nodeinfo, 4) : NULL;
 
-    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 3)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 1)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 2)) ? 0 : -1;
+    retval = (   (lc_info[0]                                              != NULL)
+              && (nhm_main_find_failed_app(lc_info[0], "App1")->failcount == 2   )
+              && (nhm_main_find_failed_app(lc_info[0], "App2")->failcount == 3   )
+              && (nhm_main_find_failed_app(lc_info[1], "App1")->failcount == 4   )) ? 0 : -1;
   }
 
-  /* Check 5: Request app info for App4 for up to 2 LCs => 2 LCs are delivered */
+  /* Check 4: File truncated => Only LCs with complete block are read */
   if(retval == 0)
   {
-    max_lc_count = 1;
+    (void) g_file_get_contents(NHM_LC_DATA_FILE, &data, &data_len, NULL);
+    (void) g_file_set_contents(NHM_LC_DATA_FILE, data, data_len - 1, NULL);
+    g_free(data);
 
-    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
-
-    nhm_main_read_statistics_cb(NULL, NULL, "App4", NULL);
+    nhm_test_restart_lc();
 
-    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 0)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 0)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 2)) ? 0 : -1;
+    retval = (nodeinfo->len == 4) ? 0 : -1;
   }
 
-  /* Check 6: No current failed apps. Request node info for 2 LCs */
+  /* Check 5: Index of file truncated => Only LCs with index are read */
   if(retval == 0)
   {
-    max_lc_count = 1;
-
-    if(current_failed_apps != NULL)
-    {
-      g_slist_free_full(current_failed_apps, &nhm_main_free_current_failed_app);
-      current_failed_apps = NULL;
-    }
-
-    nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
-    nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
+    (void) g_file_get_contents(NHM_LC_DATA_FILE, &data, &data_len, NULL);
+    (void) g_file_set_contents(NHM_LC_DATA_FILE,
+                               data,
+                               sizeof(NhmLcDataHeader) + sizeof(NhmLcDataIndex),
+                               NULL);
+    g_free(data);
 
-    nhm_main_read_statistics_cb(NULL, NULL, "", NULL);
+    nhm_test_restart_lc();
 
-    retval = (   (nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount == 0)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalFailures    == 1)
-              && (nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  == 2)) ? 0 : -1;
+    retval = (nodeinfo->len == 1) ? 0 : -1;
   }
 
-  /* Clean up objects after test */
-  if(current_failed_apps != NULL)
+  /* Check 6: File of former NHM version => LCs are read and decoded */
+  if(retval == 0)
   {
-    g_slist_free_full(current_failed_apps, &nhm_main_free_current_failed_app);
+    legacy = g_byte_array_new();
+    legacy_val = 0x01000000;             /* NHM version */
+    g_byte_array_append(legacy, (guint8*) &legacy_val, sizeof(legacy_val));
+    legacy_val = 1;                      /* # of LCs    */
+    g_byte_array_append(legacy, (guint8*) &legacy_val, sizeof(legacy_val));
+    legacy_val = NHM_NODESTATE_SHUTDOWN; /* State       */
+    g_byte_array_append(legacy, (guint8*) &legacy_val, sizeof(legacy_val));
+    legacy_val = 1;                      /* # of apps   */
+    g_byte_array_append(legacy, (guint8*) &legacy_val, sizeof(legacy_val));
+    legacy_val = 5;                      /* # app chars */
+    g_byte_array_append(legacy, (guint8*) &legacy_val, sizeof(legacy_val));
+    g_byte_array_append(legacy, (guint8*) "App1", 5);
+    legacy_val = 7;                      /* app fails   */
+    g_byte_array_append(legacy, (guint8*) &legacy_val, sizeof(legacy_val));
+
+    (void) g_file_set_contents(NHM_LC_DATA_FILE,
+                               (gchar*) legacy->data,
+                               legacy->len,
+                               NULL);
+    g_byte_array_unref(legacy);
+
+    nhm_test_restart_lc();
+
+    lc_info[0] = (nodeinfo->len == 2) ? g_ptr_array_index(nodeinfo, 1) : NULL;
+
+    retval = (   (lc_info[0]                                              != NULL                  )
+              && (lc_info[0]->start_state                                 == NHM_NODESTATE_SHUTDOWN)
+              && (lc_info[0]->map                                         == NULL                  )
+              && (nhm_main_find_failed_app(lc_info[0], "App1")->failcount == 7                     )) ? 0 : -1;
   }
 
+  /* Clean up objects created during the test */
   g_ptr_array_unref(nodeinfo);
 
+  nhm_main_close_journal();
+  system(rmcmd);
+  g_free(rmcmd);
+
   return retval;
 }
 
+
 /**
- * nhm_test_register_app_status:
+ * nhm_test_nsm_call_queue:
  *
- * Tests the register app status dbus interface of the NHM.
+ * Tests the asynchronous forwarding of app. states to the NSM.
  *
  * Returns 0, if test succeeds. Otherwise, it will return -1.
  */
 static gint
-nhm_test_register_app_status(void)
+nhm_test_nsm_call_queue(void)
 {
-  gint      retval           = 0;
-  NhmLcInfo *initial_lc_info = g_new(NhmLcInfo, 1);
+  gint       retval          = 0;
+  NhmLcInfo *initial_lc_info = nhm_main_new_lc_info(NHM_NODESTATE_SHUTDOWN);
   gchar     *rmcmd           = NULL;
 
-  initial_lc_info->start_state = NHM_NODESTATE_SHUTDOWN;
-  initial_lc_info->failed_apps = NULL;
-
   nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
   g_ptr_array_add(nodeinfo, initial_lc_info);
-  current_failed_apps = NULL;
-
-  /* Check 1: App1 fails. NSM nok => App1 in current_failed_apps */
-  nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error = TRUE;
-  nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Failed, NULL);
-  retval = (nhm_main_find_current_failed_app("App1") != NULL) ? 0 : -1;
-
-  /* Check 2: App2 fails. NSM ok  => App2 in current_failed_apps */
-  if(retval == 0)
-  {
-    nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error = FALSE;
-    nhm_main_register_app_status_cb(NULL, NULL, "App2", NhmAppStatus_Failed, NULL);
-    retval = (nhm_main_find_current_failed_app("App2") != NULL) ? 0 : -1;
-  }
-
-  /* Check 3: App1 becomes valid. NSM ok => App1 not in current_failed_apps */
-  if(retval == 0)
-  {
-    nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error = FALSE;
-    nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Ok, NULL);
-    retval = (nhm_main_find_current_failed_app("App1") == NULL) ? 0 : -1;
-  }
-
-  /* Check 4: App2 becomes valid. NSM ok => App2 not in current_failed_apps */
+  current_failed_apps = g_hash_table_new(&g_str_hash, &g_str_equal);
+
+  max_nsm_calls = 2;
+  memset(&nsm_call_stats, 0, sizeof(nsm_call_stats));
+  nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+  nsm_dbus_lc_control_call_set_app_health_status_stub_defer            = TRUE;
+  nsm_dbus_lc_control_call_set_app_health_status_stub_calls            = 0;
+
+  /* Check 1: Four states registered. Only two calls may be pending. */
+  nhm_main_register_app_status("App1", NhmAppStatus_Failed);
+  nhm_main_register_app_status("App1", NhmAppStatus_Ok);
+  nhm_main_register_app_status("App2", NhmAppStatus_Failed);
+  nhm_main_register_app_status("App3", NhmAppStatus_Failed);
+
+  retval = (   (nsm_dbus_lc_control_call_set_app_health_status_stub_calls == 2)
+            && (nsm_calls_pending                                         == 2)
+            && (g_queue_get_length(nsm_call_queue)                        == 2)
+            && (g_strcmp0(nsm_dbus_lc_control_call_set_app_health_status_stub_AppName,
+                          "App2")                                         == 0)) ? 0 : -1;
+
+  /* Check 2: First state of App1 finished => Second state of App1 sent */
   if(retval == 0)
   {
-    nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error = FALSE;
-    nhm_main_register_app_status_cb(NULL, NULL, "App2", NhmAppStatus_Ok, NULL);
-    retval = (nhm_main_find_current_failed_app("App2") == NULL) ? 0 : -1;
+    (void) nsm_dbus_lc_control_call_set_app_health_status_stub_finish();
+
+    retval = (   (nsm_dbus_lc_control_call_set_app_health_status_stub_calls      == 3   )
+              && (nsm_calls_pending                                              == 2   )
+              && (g_queue_get_length(nsm_call_queue)                             == 1   )
+              && (nsm_dbus_lc_control_call_set_app_health_status_stub_AppRunning == TRUE)
+              && (g_strcmp0(nsm_dbus_lc_control_call_set_app_health_status_stub_AppName,
+                            "App1")                                              == 0   )) ? 0 : -1;
   }
 
-  /* Check 5: App1 becomes valid. NSM ok => App1 not in current_failed_apps */
+  /* Check 3: Call for App2 fails => Accounted and App3 sent */
   if(retval == 0)
   {
-    nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error = FALSE;
-    nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Ok, NULL);
-    retval = (nhm_main_find_current_failed_app("App1") == NULL) ? 0 : -1;
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = TRUE;
+    (void) nsm_dbus_lc_control_call_set_app_health_status_stub_finish();
+    nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error = FALSE;
+
+    retval = (   (nsm_dbus_lc_control_call_set_app_health_status_stub_calls == 4)
+              && (nsm_call_stats.failed                                     == 1)
+              && (g_queue_is_empty(nsm_call_queue)                          == TRUE)
+              && (g_strcmp0(nsm_dbus_lc_control_call_set_app_health_status_stub_AppName,
+                            "App3")                                         == 0)) ? 0 : -1;
   }
 
-  /* Check 6: App1 fails. NSM ok => App1 in current_failed_apps */
+  /* Check 4: Remaining calls finished => Nothing pending anymore */
   if(retval == 0)
   {
-    nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error = FALSE;
-    nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Failed, NULL);
-    retval = (nhm_main_find_current_failed_app("App1") != NULL) ? 0 : -1;
-  }
+    while(nsm_dbus_lc_control_call_set_app_health_status_stub_finish() == TRUE)
+    {
+      /* Finish all deferred calls */
+    }
 
-  /* Check 7: App1 fails. NSM ok => App1 in current_failed_apps */
-  if(retval == 0)
-  {
-    nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error = FALSE;
-    nhm_main_register_app_status_cb(NULL, NULL, "App1", NhmAppStatus_Failed, NULL);
-    retval = (nhm_main_find_current_failed_app("App1") != NULL) ? 0 : -1;
+    retval = (   (nsm_calls_pending                             == 0)
+              && (g_hash_table_size(nsm_call_apps)              == 0)
+              && (nsm_call_stats.sent                           == 4)) ? 0 : -1;
   }
 
   /* Clean up objects created during the test */
-  if(current_failed_apps != NULL)
-  {
-    g_slist_free_full(current_failed_apps, &nhm_main_free_current_failed_app);
-  }
+  nsm_dbus_lc_control_call_set_app_health_status_stub_defer = FALSE;
+  max_nsm_calls = NHM_NSM_CALLS_DEFAULT;
 
-  g_ptr_array_unref(nodeinfo);
+  nhm_main_free_nhm_objects();
 
-  rmcmd = g_strdup_printf("rm %s", NHM_LC_DATA_FILE);
+  rmcmd = g_strdup_printf("rm -f %s %s", NHM_LC_DATA_FILE, NHM_LC_JOURNAL_FILE);
   system(rmcmd);
   g_free(rmcmd);
 
@@ -738,34 +2497,36 @@ nhm_test_nhm_bus_callbacks(void)
     g_object_unref(busconn);
   }
 
-  /* Check 3: NameAcquired. No UL checks => No timer scheduled */
+  /* Check 3: NameAcquired. No UL checks => No check worker started */
   if(retval == 0)
   {
     nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
     ul_chk_interval = 0;
 
-    g_timeout_add_seconds_called          = FALSE;
-    g_timeout_add_seconds_called_interval = 0;
-
     nhm_main_name_acquired_cb(NULL, NULL, NULL);
 
-    retval = (g_timeout_add_seconds_called == FALSE) ? 0 : -1;
+    retval = (check_thread == NULL) ? 0 : -1;
     g_ptr_array_unref(nodeinfo);
   }
 
-  /* Check 4: NameAcquired. UL check enabled => Timer is scheduled */
+  /* Check 4: NameAcquired. UL check enabled => Check worker started */
   if(retval == 0)
   {
     nodeinfo = g_ptr_array_new_with_free_func(&nhm_main_free_lc_info);
     ul_chk_interval = 10000;
 
-    g_timeout_add_seconds_called          = FALSE;
-    g_timeout_add_seconds_called_interval = 0;
-
     nhm_main_name_acquired_cb(NULL, NULL, NULL);
 
-    retval = (    (g_timeout_add_seconds_called          == TRUE )
-               && (g_timeout_add_seconds_called_interval == 10000)) ? 0 : -1;
+    retval = (   (check_thread  != NULL)
+              && (check_context != NULL)) ? 0 : -1;
+
+    nhm_main_stop_check_worker();
+
+    retval = (   (retval        == 0   )
+              && (check_thread  == NULL)
+              && (check_context == NULL)) ? 0 : -1;
+
+    ul_chk_interval = 0;
     g_ptr_array_unref(nodeinfo);
   }
 
@@ -785,6 +2546,9 @@ nhm_test_nhm_bus_callbacks(void)
     retval = (g_main_loop_quit_stub_called == TRUE) ? 0 : -1;
   }
 
+  /* Clean up journal created when name was acquired */
+  nhm_main_close_journal();
+
   return retval;
 }
 
@@ -901,10 +2665,29 @@ nhm_test_load_config(void)
   retval =     (max_lc_count                      == 5   )
             && (max_failed_apps                   == 8   )
             && (no_restart_apps                   == NULL)
+            && (max_nsm_calls                     == 8   )
+            && (nsm_call_timeout                  == 5000)
+            && (lc_data_write_delay               == 2000)
             && (ul_chk_interval                   == 0   )
+            && (watch_progs                       == FALSE)
+            && (max_proc_checks                   == 4    )
+            && (proc_check_timeout                == 10   )
+            && (dbus_probe_timeout                == 0    )
+            && (dbus_max_rtt                      == 0    )
+            && (file_chk_interval                 == 0    )
+            && (prog_chk_interval                 == 0    )
+            && (proc_chk_interval                 == 0    )
+            && (dbus_chk_interval                 == 0    )
+            && (ul_chk_jitter                     == 0    )
+            && (ul_chk_backoff_max                == 0    )
             && (monitored_files                   == NULL)
             && (monitored_procs                   == NULL)
-            && (monitored_progs                   == NULL) ? 0 : -1;
+            && (monitored_progs                   == NULL)
+            && (include_units                     == NULL)
+            && (exclude_units                     == NULL)
+            && (unit_types                        != NULL)
+            && (strcmp(unit_types[0], "service")  == 0   )
+            && (unit_types[1]                     == NULL) ? 0 : -1;
 
   nhm_main_free_config_objects();
 
@@ -967,6 +2750,7 @@ nhm_test_load_config(void)
   {
     system("sed -i 's/ul_chk_interval = 0/ul_chk_interval = 10/g'        node-health-monitor.conf");
     system("sed -i 's/monitored_files =/monitored_files = File1;File2/g' node-health-monitor.conf");
+    system("sed -i 's/include_units =/include_units = app-*/g'           node-health-monitor.conf");
 
     nhm_main_load_config();
 
@@ -979,13 +2763,19 @@ nhm_test_load_config(void)
               && (strcmp(monitored_files[1], "File2") == 0   )
               && (monitored_files[2]                  == NULL)
               && (monitored_procs                     == NULL)
-              && (monitored_progs                     == NULL) ? 0 : -1;
+              && (monitored_progs                     == NULL)
+              && (include_units                       != NULL)
+              && (strcmp(include_units[0], "app-*")   == 0   )
+              && (include_units[1]                    == NULL) ? 0 : -1;
 
     nhm_main_free_config_objects();
   }
 
   system("rm -rf node-health-monitor.conf");
 
+  /* Restore default, so that following tests write LC data immediately */
+  lc_data_write_delay = 0;
+
   return retval;
 }
 
@@ -1085,25 +2875,67 @@ main(void)
   /* Test 5: Test NHM register_app_status dbus interface */
   retval = (retval == 0) ? nhm_test_register_app_status() : -1;
 
-  /* Test 6: Test NHM read_statistics dbus interface */
+  /* Test 6: Test NHM register_app_status_batch dbus interface */
+  retval = (retval == 0) ? nhm_test_register_batch() : -1;
+
+  /* Test 7: Test delayed writing of the LC data */
+  retval = (retval == 0) ? nhm_test_write_behind() : -1;
+
+  /* Test 8: Test journal of the LC data */
+  retval = (retval == 0) ? nhm_test_lc_journal() : -1;
+
+  /* Test 9: Test format of the LC data file */
+  retval = (retval == 0) ? nhm_test_lc_data_format() : -1;
+
+  /* Test 10: Test forwarding of app. states to the NSM */
+  retval = (retval == 0) ? nhm_test_nsm_call_queue() : -1;
+
+  /* Test 11: Test NHM read_statistics dbus interface */
   retval = (retval == 0) ? nhm_test_read_statistics() : -1;
 
-  /* Test 7: Test NHM request node restart dbus interface */
+  /* Test 12: Test NHM read_all_statistics dbus interface */
+  retval = (retval == 0) ? nhm_test_read_all_statistics() : -1;
+
+  /* Test 13: Test NHM request node restart dbus interface */
   retval = (retval == 0) ? nhm_test_app_restart_request() : -1;
 
-  /* Test 8: Test NHM user land check functionality */
+  /* Test 14: Test NHM user land check functionality */
   retval = (retval == 0) ? nhm_test_userland_check() : -1;
 
-  /* Test 9: Test NHM WDOG handling */
+  /* Test 15: Test NHM asynchronous execution of monitored procs */
+  retval = (retval == 0) ? nhm_test_proc_checks() : -1;
+
+  /* Test 16: Test NHM scheduling of userland checks in the timer wheel */
+  retval = (retval == 0) ? nhm_test_check_wheel() : -1;
+
+  /* Test 17: Test NHM adaptive cadence of userland checks */
+  retval = (retval == 0) ? nhm_test_check_cadence() : -1;
+
+  /* Test 18: Test NHM sweep of userland checks and health report */
+  retval = (retval == 0) ? nhm_test_health_report() : -1;
+
+  /* Test 19: Test NHM posting of check results to the main loop */
+  retval = (retval == 0) ? nhm_test_check_results() : -1;
+
+  /* Test 20: Test NHM single scan for monitored programs */
+  retval = (retval == 0) ? nhm_test_find_missing_prog() : -1;
+
+  /* Test 21: Test NHM process index of the proc connector */
+  retval = (retval == 0) ? nhm_test_proc_events() : -1;
+
+  /* Test 22: Test NHM watching of monitored files */
+  retval = (retval == 0) ? nhm_test_watch_files() : -1;
+
+  /* Test 23: Test NHM WDOG handling */
   retval = (retval == 0) ? nhm_test_watchdog() : -1;
 
-  /* Test 10: Test NHM LC request handling */
+  /* Test 24: Test NHM LC request handling */
   retval = (retval == 0) ? nhm_test_handle_lc_request() : -1;
 
-  /* Test 11: Test dbus alive */
-  retval = (retval == 0) ? nhm_test_is_dbus_alive() : -1;
+  /* Test 25: Test probes of monitored dbusses */
+  retval = (retval == 0) ? nhm_test_probe_dbus() : -1;
 
-  /* Test 12: Test SIGTERM */
+  /* Test 26: Test SIGTERM */
   retval = (retval == 0) ? nhm_test_on_sigterm() : -1;
 
   return retval;
@@ -38,6 +38,12 @@
 #define nhm_systemd_disconnect \
         nhm_systemd_disconnect_stub
 
+#define nhm_systemd_set_unit_filter \
+        nhm_systemd_set_unit_filter_stub
+
+#define nhm_systemd_free_unit_filter \
+        nhm_systemd_free_unit_filter_stub
+
 #define dlt_register_app \
         dlt_register_app_stub
 
@@ -71,12 +77,27 @@
 #define nhm_dbus_info_emit_app_health_status \
         nhm_dbus_info_emit_app_health_status_stub
 
+#define nhm_dbus_info_emit_app_health_status_batch \
+        nhm_dbus_info_emit_app_health_status_batch_stub
+
 #define nhm_dbus_info_complete_register_app_status \
         nhm_dbus_info_complete_register_app_status_stub
 
+#define nhm_dbus_info_complete_register_app_status_batch \
+        nhm_dbus_info_complete_register_app_status_batch_stub
+
 #define nhm_dbus_info_complete_read_statistics \
         nhm_dbus_info_complete_read_statistics_stub
 
+#define nhm_dbus_info_complete_read_all_statistics \
+        nhm_dbus_info_complete_read_all_statistics_stub
+
+#define nhm_dbus_info_complete_get_health_report \
+        nhm_dbus_info_complete_get_health_report_stub
+
+#define nhm_dbus_info_complete_read_check_intervals \
+        nhm_dbus_info_complete_read_check_intervals_stub
+
 #define nhm_dbus_info_complete_request_node_restart \
         nhm_dbus_info_complete_request_node_restart_stub
 
@@ -95,8 +116,11 @@
 #define nsm_dbus_lc_control_proxy_new_sync \
         nsm_dbus_lc_control_proxy_new_sync_stub
 
-#define nsm_dbus_lc_control_call_set_app_health_status_sync \
-        nsm_dbus_lc_control_call_set_app_health_status_sync_stub
+#define nsm_dbus_lc_control_call_set_app_health_status \
+        nsm_dbus_lc_control_call_set_app_health_status_stub
+
+#define nsm_dbus_lc_control_call_set_app_health_status_finish \
+        nsm_dbus_lc_control_call_set_app_health_status_finish_stub
 
 #define nsm_dbus_lc_control_call_request_node_restart_sync \
         nsm_dbus_lc_control_call_request_node_restart_sync_stub
@@ -104,18 +128,6 @@
 #define g_file_test \
         g_file_test_stub
 
-#define g_file_read_link \
-        g_file_read_link_stub
-
-#define g_dir_open \
-        g_dir_open_stub
-
-#define g_dir_read_name \
-        g_dir_read_name_stub
-
-#define g_dir_close \
-        g_dir_close_stub
-
 #define g_main_loop_run \
         g_main_loop_run_stub
 
@@ -134,8 +146,17 @@
 #define g_dbus_interface_skeleton_export \
         g_dbus_interface_skeleton_export_stub
 
-#define g_dbus_connection_new_for_address_sync \
-        g_dbus_connection_new_for_address_sync_stub
+#define g_dbus_connection_new_for_address \
+        g_dbus_connection_new_for_address_stub
+
+#define g_dbus_connection_new_for_address_finish \
+        g_dbus_connection_new_for_address_finish_stub
+
+#define g_dbus_connection_call \
+        g_dbus_connection_call_stub
+
+#define g_dbus_connection_call_finish \
+        g_dbus_connection_call_finish_stub
 
 #define g_dbus_connection_call_sync \
         g_dbus_connection_call_sync_stub
@@ -155,8 +176,11 @@
 #define g_signal_connect_data \
         g_signal_connect_data_stub
 
-#define g_spawn_sync \
-        g_spawn_sync_stub
+#define g_spawn_async \
+        g_spawn_async_stub
+
+#define kill \
+        kill_stub
 
 #define sd_notify \
         sd_notify_stub
@@ -186,6 +210,7 @@
 /* Undefine previous redefinitions */
 #undef nhm_systemd_connect
 #undef nhm_systemd_disconnect
+#undef nhm_systemd_set_unit_filter
 #undef dlt_check_library_version
 #undef dlt_register_context
 #undef dlt_unregister_context
@@ -196,35 +221,41 @@
 #undef dlt_user_log_write_int
 #undef dlt_user_log_write_uint
 #undef nhm_dbus_info_emit_app_health_status
+#undef nhm_dbus_info_emit_app_health_status_batch
 #undef nhm_dbus_info_complete_register_app_status
+#undef nhm_dbus_info_complete_register_app_status_batch
 #undef nhm_dbus_info_complete_read_statistics
+#undef nhm_dbus_info_complete_read_all_statistics
+#undef nhm_dbus_info_complete_get_health_report
+#undef nhm_dbus_info_complete_read_check_intervals
 #undef nhm_dbus_info_complete_request_node_restart
 #undef nsm_dbus_consumer_proxy_new_sync
 #undef nsm_dbus_consumer_call_register_shutdown_client_sync
 #undef nsm_dbus_lc_consumer_proxy_new_sync
 #undef nsm_dbus_lc_consumer_complete_lifecycle_request
 #undef nsm_dbus_lc_control_proxy_new_sync
-#undef nsm_dbus_lc_control_call_set_app_health_status_sync
+#undef nsm_dbus_lc_control_call_set_app_health_status
+#undef nsm_dbus_lc_control_call_set_app_health_status_finish
 #undef nsm_dbus_lc_control_call_request_node_restart_sync
 #undef g_file_test
-#undef g_file_read_link
-#undef g_dir_open
-#undef g_dir_read_name
-#undef g_dir_close
 #undef g_main_loop_run
 #undef g_main_loop_quit
 #undef g_bus_get_sync
 #undef g_dbus_connection_get_unique_name
 #undef g_bus_own_name
 #undef g_dbus_interface_skeleton_export
-#undef g_dbus_connection_new_for_address_sync
+#undef g_dbus_connection_new_for_address
+#undef g_dbus_connection_new_for_address_finish
+#undef g_dbus_connection_call
+#undef g_dbus_connection_call_finish
 #undef g_dbus_connection_call_sync
 #undef g_dbus_connection_signal_subscribe
 #undef g_dbus_connection_signal_unsubscribe
 #undef g_dbus_connection_call_sync
 #undef g_timeout_add_seconds
 #undef g_signal_connect_data
-#undef g_spawn_sync
+#undef g_spawn_async
+#undef kill
 #undef sd_notify
 #undef pclKeyWriteData
 #undef pclKeyReadData
@@ -89,94 +89,145 @@ nhm_test_systemd_connect(void)
 {
   gint                              retval   = 0;
   NhmSystemdAppStatusCb             callback = NULL;
-  GdbusConnectionCallSyncStubCalls  g_dbus_connection_call_sync_stub_calls[3];
+  NhmSystemdUnit                   *unit     = NULL;
+  GdbusConnectionCallSyncStubCalls  g_dbus_connection_call_sync_stub_calls[1];
   GVariantBuilder                  *builder;
 
   /* Check 1: Callback nok. */
   callback = NULL;
   retval = (nhm_systemd_connect(callback) == FALSE) ? 0 : -1;
 
-  /* Check 2: Callback ok. Bus conn. nok. */
+  /* Check 2: Callback ok. Connection to bus is started, but not awaited. */
   if(retval == 0)
   {
     callback = &nhm_systemd_test_app_state_changed_cb;
-    g_bus_get_sync_set_error = TRUE;
+    g_bus_get_stub_called = FALSE;
 
-    retval = (nhm_systemd_connect(callback) == FALSE) ? 0 : -1;
+    retval = (   (nhm_systemd_connect(callback) == TRUE)
+              && (g_bus_get_stub_called == TRUE)
+              && (nhm_systemd_startup   != NULL)
+              && (nhm_systemd_conn      == NULL))
+             ? 0 : -1;
   }
 
-  /* Check 3: Callback ok. Bus conn. ok. Subscribe nok. */
+  /* Check 3: Bus conn. nok. Observation stopped. */
   if(retval == 0)
   {
-    callback = &nhm_systemd_test_app_state_changed_cb;
+    g_bus_get_sync_set_error = TRUE;
+
+    nhm_systemd_bus_get_cb(NULL, NULL, NULL);
+
     g_bus_get_sync_set_error = FALSE;
+    retval = (   (nhm_systemd_app_status_cb  == NULL)
+              && (nhm_systemd_startup        == NULL)
+              && (nhm_systemd_observed_units == NULL))
+             ? 0 : -1;
+  }
+
+  /* Check 4: Bus conn. ok. Signals registered and 'Subscribe' called. */
+  if(retval == 0)
+  {
+    (void) nhm_systemd_connect(callback);
+    g_dbus_connection_call_stub_method = NULL;
 
-    g_dbus_connection_call_sync_stub_control.count    = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method  = "Subscribe";
-    g_dbus_connection_call_sync_stub_calls[0].rval    = NULL;
-    g_dbus_connection_call_sync_stub_control.calls    = g_dbus_connection_call_sync_stub_calls;
+    nhm_systemd_bus_get_cb(NULL, NULL, NULL);
 
-    retval = (nhm_systemd_connect(callback) == FALSE) ? 0 : -1;
+    retval = (   (nhm_systemd_conn != NULL)
+              && (g_strcmp0(g_dbus_connection_call_stub_method, "Subscribe") == 0))
+             ? 0 : -1;
   }
 
-  /* Check 4: Callback ok. Bus conn. ok. Subscribe ok. ListUnits nok */
+  /* Check 5: Subscribe nok. Observation stopped. */
   if(retval == 0)
   {
-    callback = &nhm_systemd_test_app_state_changed_cb;
+    g_dbus_connection_call_finish_stub_rval = NULL;
 
-    g_bus_get_sync_set_error = FALSE;
+    nhm_systemd_subscribe_cb(NULL, NULL, NULL);
 
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "Subscribe";
-    g_dbus_connection_call_sync_stub_calls[0].rval   = g_variant_new("()");
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+    retval = (   (nhm_systemd_conn              == NULL)
+              && (nhm_systemd_events_subscribed == FALSE)
+              && (nhm_systemd_startup           == NULL))
+             ? 0 : -1;
+  }
 
-    g_dbus_connection_call_sync_stub_control.count   = 2;
-    g_dbus_connection_call_sync_stub_calls[1].method = "ListUnits";
-    g_dbus_connection_call_sync_stub_calls[1].rval   = NULL;
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+  /* Check 6: Subscribe ok. 'ListUnitsByPatterns' called. */
+  if(retval == 0)
+  {
+    (void) nhm_systemd_connect(callback);
+    nhm_systemd_bus_get_cb(NULL, NULL, NULL);
 
-    g_dbus_connection_call_sync_stub_control.count   = 3;
-    g_dbus_connection_call_sync_stub_calls[2].method = "Unsubscribe";
-    g_dbus_connection_call_sync_stub_calls[2].rval   = NULL;
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+    /* Reply is owned and released by the callback */
+    g_dbus_connection_call_finish_stub_rval =
+        g_variant_ref_sink(g_variant_new("()"));
 
-    retval = (nhm_systemd_connect(callback) == FALSE) ? 0 : -1;
+    nhm_systemd_subscribe_cb(NULL, NULL, NULL);
+
+    g_dbus_connection_call_finish_stub_rval = NULL;
+    retval = (   (nhm_systemd_events_subscribed == TRUE)
+              && (g_strcmp0(g_dbus_connection_call_stub_method,
+                            "ListUnitsByPatterns") == 0))
+             ? 0 : -1;
   }
 
-  /* Check 5: Callback ok. Bus conn. ok. Subscribe ok. ListUnits ok */
+  /* Check 7: 'ListUnitsByPatterns' unknown. Fallback to 'ListUnits'. */
   if(retval == 0)
   {
-    /* Callback ok */
-    callback = &nhm_systemd_test_app_state_changed_cb;
+    g_dbus_connection_call_finish_stub_rval       = NULL;
+    g_dbus_connection_call_finish_stub_error_code = G_DBUS_ERROR_UNKNOWN_METHOD;
 
-    /* Bus conn. ok */
-    g_bus_get_sync_set_error = FALSE;
+    nhm_systemd_list_units_cb(NULL, NULL, GINT_TO_POINTER(TRUE));
 
-    /* Subscribe ok */
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "Subscribe";
-    g_dbus_connection_call_sync_stub_calls[0].rval   = g_variant_new("()");
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
+    g_dbus_connection_call_finish_stub_error_code = G_DBUS_ERROR_FAILED;
+    retval = (   (nhm_systemd_conn != NULL)
+              && (g_strcmp0(g_dbus_connection_call_stub_method, "ListUnits") == 0))
+             ? 0 : -1;
+  }
 
-    /* ListUnits ok */
-    g_dbus_connection_call_sync_stub_control.count   = 2;
-    g_dbus_connection_call_sync_stub_calls[1].method = "ListUnits";
+  /* Check 8: ListUnits ok. Services added. Unit added in between updated. */
+  if(retval == 0)
+  {
+    unit = nhm_systemd_add_unit("2.service", "/a/b/d");
+    unit->active_state = NHM_ACTIVE_STATE_ACTIVE;
+    nhm_systemd_test_app_state_changed_cb_called = FALSE;
 
     builder = g_variant_builder_new (G_VARIANT_TYPE("a(ssssssouso)"));
     g_variant_builder_add (builder, "(ssssssouso)",  "1", "2", "3", "4", "5", "6", "/a/b/c", 100, "7", "/a/b/c");
-    g_variant_builder_add (builder, "(ssssssouso)",  "1.service", "2", "3", "4", "5", "6", "/a/b/c", 100, "7", "/a/b/c");
-    g_dbus_connection_call_sync_stub_calls[1].rval = g_variant_new("(a(ssssssouso))", builder);
+    g_variant_builder_add (builder, "(ssssssouso)",  "1.service", "2", "3", "active", "5", "6", "/a/b/c", 100, "7", "/a/b/c");
+    g_variant_builder_add (builder, "(ssssssouso)",  "2.service", "2", "3", "failed", "5", "6", "/a/b/d", 100, "7", "/a/b/d");
+    g_dbus_connection_call_finish_stub_rval =
+        g_variant_ref_sink(g_variant_new("(a(ssssssouso))", builder));
     g_variant_builder_unref (builder);
 
-    g_dbus_connection_call_sync_stub_control.calls = g_dbus_connection_call_sync_stub_calls;
+    nhm_systemd_list_units_cb(NULL, NULL, NULL);
+
+    g_dbus_connection_call_finish_stub_rval = NULL;
+    retval = (   (g_hash_table_size(nhm_systemd_observed_units) == 2)
+              && (g_hash_table_lookup(nhm_systemd_units_by_path, "/a/b/c") != NULL)
+              && (unit->active_state == NHM_ACTIVE_STATE_FAILED)
+              && (nhm_systemd_test_app_state_changed_cb_called == TRUE)
+              && (g_strcmp0(nhm_systemd_test_app_state_changed_cb_name, "2.service") == 0))
+             ? 0 : -1;
 
-    /* Call */
-    retval = (nhm_systemd_connect(callback) == TRUE) ? 0 : -1;
+    /* Stop observation */
+    g_dbus_connection_call_sync_stub_control.count   = 1;
+    g_dbus_connection_call_sync_stub_calls[0].method = "Unsubscribe";
+    g_dbus_connection_call_sync_stub_calls[0].rval   = g_variant_new("()");
+    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
 
-    /* Free created unit object. Destroy bus conn. */
-    g_slist_free_full(nhm_systemd_observed_units, &nhm_systemd_free_unit);
-    g_object_unref(nhm_systemd_conn);
+    nhm_systemd_disconnect();
+  }
+
+  /* Check 9: Reply for a cancelled startup. Nothing done. */
+  if(retval == 0)
+  {
+    g_dbus_connection_call_finish_stub_cancelled = TRUE;
+
+    nhm_systemd_list_units_cb(NULL, NULL, NULL);
+
+    g_dbus_connection_call_finish_stub_cancelled = FALSE;
+    retval = (   (nhm_systemd_observed_units == NULL)
+              && (nhm_systemd_conn           == NULL))
+             ? 0 : -1;
   }
 
   return retval;
@@ -192,8 +243,7 @@ nhm_test_systemd_connect(void)
 static gint
 nhm_test_systemd_disconnect(void)
 {
-  NhmSystemdUnit                   *unit = NULL;
-  GdbusConnectionCallSyncStubCalls  g_dbus_connection_call_sync_stub_calls[1];
+  GdbusConnectionCallSyncStubCalls g_dbus_connection_call_sync_stub_calls[1];
 
   /* Check 1: Sub nok. No UnitAdd sig. No UnitRem sig. No obs. units. No systemd conn. */
   nhm_systemd_events_subscribed = FALSE;
@@ -233,12 +283,12 @@ nhm_test_systemd_disconnect(void)
   nhm_systemd_unit_add_sig_id = 1;
   nhm_systemd_unit_rem_sig_id = 1;
 
-  unit = g_new(NhmSystemdUnit, 1);
-  unit->active_state = NHM_ACTIVE_STATE_UNKNOWN;
-  unit->name         = g_strdup("Unit");
-  unit->path         = g_strdup("/a/unit/to/destroy");
-  unit->sig_sub_id   = 0;
-  nhm_systemd_observed_units  = g_slist_append(nhm_systemd_observed_units, unit);
+  nhm_systemd_observed_units = g_hash_table_new_full(&g_str_hash,
+                                                     &g_str_equal,
+                                                     NULL,
+                                                     &nhm_systemd_free_unit);
+  nhm_systemd_units_by_path  = g_hash_table_new(&g_str_hash, &g_str_equal);
+  nhm_systemd_add_unit("Unit", "/a/unit/to/destroy");
 
   nhm_systemd_conn = g_object_new(G_TYPE_DBUS_CONNECTION, NULL);
 
@@ -309,6 +359,64 @@ nhm_systemd_test_active_state_string_to_enum(void)
 }
 
 
+/**
+ * nhm_systemd_test_unit_is_observed:
+ * @Return: 0, if test succeeded. Otherwise -1.
+ *
+ * Test nhm_systemd_set_unit_filter() and nhm_systemd_unit_is_observed().
+ */
+static gint
+nhm_systemd_test_unit_is_observed(void)
+{
+  gint   retval    = 0;
+  gchar *include[] = {"app-*", "nhm.service", NULL};
+  gchar *exclude[] = {"app-test*", NULL};
+  gchar *types[]   = {"service", "socket", NULL};
+
+  /* Check 1: Default filter. Only services observed. */
+  nhm_systemd_set_unit_filter(NULL, NULL, NULL);
+
+  retval = (   (nhm_systemd_unit_is_observed("a.service")    == TRUE)
+            && (nhm_systemd_unit_is_observed("a.socket")     == FALSE)
+            && (nhm_systemd_unit_is_observed("a.service.d")  == FALSE)
+            && (g_strcmp0(nhm_systemd_list_patterns[0], "*.service") == 0)
+            && (nhm_systemd_list_patterns[1] == NULL))
+           ? 0 : -1;
+
+  /* Check 2: Types only. */
+  if(retval == 0)
+  {
+    nhm_systemd_set_unit_filter(NULL, NULL, types);
+
+    retval = (   (nhm_systemd_unit_is_observed("a.service") == TRUE)
+              && (nhm_systemd_unit_is_observed("a.socket")  == TRUE)
+              && (nhm_systemd_unit_is_observed("a.mount")   == FALSE)
+              && (g_strcmp0(nhm_systemd_list_patterns[1], "*.socket") == 0))
+             ? 0 : -1;
+  }
+
+  /* Check 3: Include and exclude patterns. */
+  if(retval == 0)
+  {
+    nhm_systemd_set_unit_filter(include, exclude, types);
+
+    retval = (   (nhm_systemd_unit_is_observed("app-a.service")    == TRUE)
+              && (nhm_systemd_unit_is_observed("app-a.socket")     == TRUE)
+              && (nhm_systemd_unit_is_observed("app-a.mount")      == FALSE)
+              && (nhm_systemd_unit_is_observed("nhm.service")      == TRUE)
+              && (nhm_systemd_unit_is_observed("dlt.service")      == FALSE)
+              && (nhm_systemd_unit_is_observed("app-test.service") == FALSE)
+              && (g_strcmp0(nhm_systemd_list_patterns[0], "app-*") == 0))
+             ? 0 : -1;
+  }
+
+  /* Restore default for following tests */
+  nhm_systemd_set_unit_filter(NULL, NULL, NULL);
+
+  return retval;
+}
+
+
 /**
  * nhm_systemd_test_subscribe_properties_changed:
  * @Return: 0, if test succeeded. Otherwise -1.
@@ -318,47 +426,59 @@ nhm_systemd_test_active_state_string_to_enum(void)
 static gint
 nhm_systemd_test_subscribe_properties_changed(void)
 {
-  NhmSystemdUnit unit;
-
   /* Check 1: Do a subscription */
-  return (nhm_systemd_subscribe_properties_changed(&unit) == 0) ? 0 : -1;
+  return (nhm_systemd_subscribe_properties_changed() == 0) ? 0 : -1;
 }
 
 
 /**
- * nhm_systemd_test_find_unit_by_name:
+ * nhm_systemd_test_add_unit:
  * @Return: 0, if test succeeded. Otherwise -1.
  *
- * Test nhm_systemd_find_unit_by_name() function.
+ * Test nhm_systemd_add_unit() function.
  */
 static gint
-nhm_systemd_test_find_unit_by_name(void)
+nhm_systemd_test_add_unit(void)
 {
-  gint           retval = 0;
-  NhmSystemdUnit u1;
-  NhmSystemdUnit u2;
+  gint            retval = 0;
+  gchar          *name   = g_strdup("Unit.service");
+  NhmSystemdUnit *unit   = NULL;
 
-  /* Check 1: Valid compare */
-  u1.name = "Unit1";
-  u2.name = "Unit1";
-  retval = (nhm_systemd_find_unit_by_name(&u1, &u2) == 0) ? 0 : -1;
+  nhm_systemd_observed_units = g_hash_table_new_full(&g_str_hash,
+                                                     &g_str_equal,
+                                                     NULL,
+                                                     &nhm_systemd_free_unit);
+  nhm_systemd_units_by_path  = g_hash_table_new(&g_str_hash, &g_str_equal);
 
-  /* Check 2: Invalid compare I */
-  if(retval == 0)
-  {
-    u1.name = "Unit1";
-    u2.name = "Unit2";
-    retval = (nhm_systemd_find_unit_by_name(&u1, &u2) == -1) ? 0 : -1;
-  }
+  /* Check 1: Add unit. Name copied. Unit found by name and path. */
+  unit = nhm_systemd_add_unit(name, "/Path/to/Unit");
 
-  /* Check 3: Invalid compare II */
+  retval = (   (unit->name != name)
+            && (g_strcmp0(unit->name, "Unit.service") == 0)
+            && (unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)
+            && (g_hash_table_lookup(nhm_systemd_observed_units, name) == unit)
+            && (g_hash_table_lookup(nhm_systemd_units_by_path,
+                                    "/Path/to/Unit") == unit))
+           ? 0 : -1;
+
+  /* Check 2: Add unit with same name again. Old unit replaced. */
   if(retval == 0)
   {
-    u1.name = "Unit2";
-    u2.name = "Unit1";
-    retval = (nhm_systemd_find_unit_by_name(&u1, &u2) == 1) ? 0 : -1;
+    unit = nhm_systemd_add_unit(name, "/Path/to/Unit2");
+
+    retval = (   (g_hash_table_size(nhm_systemd_observed_units) == 1)
+              && (g_hash_table_size(nhm_systemd_units_by_path)  == 1)
+              && (g_hash_table_lookup(nhm_systemd_units_by_path,
+                                      "/Path/to/Unit2") == unit))
+             ? 0 : -1;
   }
 
+  g_hash_table_destroy(nhm_systemd_units_by_path);
+  nhm_systemd_units_by_path = NULL;
+  g_hash_table_destroy(nhm_systemd_observed_units);
+  nhm_systemd_observed_units = NULL;
+  g_free(name);
+
   return retval;
 }
 
@@ -372,17 +492,33 @@ nhm_systemd_test_find_unit_by_name(void)
 static gint
 nhm_systemd_test_free_unit(void)
 {
-  NhmSystemdUnit *unit = g_new(NhmSystemdUnit, 1);
+  gint            retval  = 0;
+  GCancellable   *refresh = NULL;
+  NhmSystemdUnit *unit    = g_slice_new(NhmSystemdUnit);
 
   /* Check 1: Free normal unit object */
   unit->active_state = NHM_ACTIVE_STATE_UNKNOWN;
   unit->name         = g_strdup("Unit");
   unit->path         = g_strdup("/path/to/unit");
-  unit->sig_sub_id   = 0;
+  unit->refresh      = NULL;
 
   nhm_systemd_free_unit(unit);
 
-  return 0;
+  /* Check 2: Free unit object with pending refresh. Refresh cancelled. */
+  refresh = g_cancellable_new();
+
+  unit = g_slice_new(NhmSystemdUnit);
+  unit->active_state = NHM_ACTIVE_STATE_UNKNOWN;
+  unit->name         = g_strdup("Unit");
+  unit->path         = g_strdup("/path/to/unit");
+  unit->refresh      = g_object_ref(refresh);
+
+  nhm_systemd_free_unit(unit);
+
+  retval = (g_cancellable_is_cancelled(refresh) == TRUE) ? 0 : -1;
+  g_object_unref(refresh);
+
+  return retval;
 }
 
 
@@ -447,50 +583,6 @@ nhm_systemd_test_unit_active_state_changed(void)
 }
 
 
-/**
- * nhm_systemd_test_unit_get_active_state:
- * @Return: 0, if test succeeded. Otherwise -1.
- *
- * Test nhm_systemd_unit_get_active_state() function.
- */
-static gint
-nhm_systemd_test_unit_get_active_state(void)
-{
-  gint                             retval             = 0;
-  GVariant                        *unit_state_variant = NULL;
-  NhmSystemdUnit                   unit               = {"Name", "Path", NHM_ACTIVE_STATE_ACTIVE, 0};
-  GdbusConnectionCallSyncStubCalls g_dbus_connection_call_sync_stub_calls[1];
-
-  /* Check 1: D-Bus error getting ActiveState property */
-  g_dbus_connection_call_sync_stub_control.count   = 1;
-  g_dbus_connection_call_sync_stub_calls[0].method = "Get";
-  g_dbus_connection_call_sync_stub_calls[0].rval   = NULL;
-  g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
-
-  retval = (nhm_systemd_unit_get_active_state(&unit) == NHM_ACTIVE_STATE_UNKNOWN)
-           ? 0 : -1;
-
-  /* Check 2: Retrieve D-Bus property value successful */
-  if(retval == 0)
-  {
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "Get";
-
-    unit_state_variant = g_variant_new_string("active");
-    unit_state_variant = g_variant_new_variant(unit_state_variant);
-    unit_state_variant = g_variant_new_tuple(&unit_state_variant, 1);
-    g_dbus_connection_call_sync_stub_calls[0].rval  = unit_state_variant;
-
-    g_dbus_connection_call_sync_stub_control.calls   = g_dbus_connection_call_sync_stub_calls;
-
-    retval = (nhm_systemd_unit_get_active_state(&unit) == NHM_ACTIVE_STATE_ACTIVE)
-             ? 0 : -1;
-  }
-
-  return retval;
-}
-
-
 /**
  * nhm_systemd_test_unit_added:
  * @Return: 0, if test succeeded. Otherwise -1.
@@ -500,14 +592,16 @@ nhm_systemd_test_unit_get_active_state(void)
 static gint
 nhm_systemd_test_unit_added(void)
 {
-  gint                              retval             = 0;
-  GVariant                         *param              = NULL;
-  GVariant                         *unit_state_variant = NULL;
-  NhmSystemdUnit                   *unit               = NULL;
-  GdbusConnectionCallSyncStubCalls  g_dbus_connection_call_sync_stub_calls[1];
+  gint            retval = 0;
+  GVariant       *param  = NULL;
+  NhmSystemdUnit *unit   = NULL;
 
   /* Check 1: Wrong parameter format */
-  nhm_systemd_observed_units = NULL;
+  nhm_systemd_observed_units = g_hash_table_new_full(&g_str_hash,
+                                                     &g_str_equal,
+                                                     NULL,
+                                                     &nhm_systemd_free_unit);
+  nhm_systemd_units_by_path  = g_hash_table_new(&g_str_hash, &g_str_equal);
   param = g_variant_new("(uss)", 10, "Wrong", "Unit");
 
   nhm_systemd_unit_added(NULL,
@@ -518,25 +612,13 @@ nhm_systemd_test_unit_added(void)
                          param,
                          NULL);
 
-  retval = (nhm_systemd_observed_units == NULL) ? 0 : -1;
+  retval = (g_hash_table_size(nhm_systemd_observed_units) == 0) ? 0 : -1;
 
   /* Check 2: New unit added, but no service */
   if(retval == 0)
   {
-    nhm_systemd_observed_units = NULL;
     param = g_variant_new("(so)", "Unit", "/Path/to/Unit");
 
-    /* Function will retrieve unit's active state */
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "Get";
-
-    unit_state_variant = g_variant_new_string("active");
-    unit_state_variant = g_variant_new_variant(unit_state_variant);
-    unit_state_variant = g_variant_new_tuple(&unit_state_variant, 1);
-    g_dbus_connection_call_sync_stub_calls[0].rval  = unit_state_variant;
-
-    g_dbus_connection_call_sync_stub_control.calls = g_dbus_connection_call_sync_stub_calls;
-
     nhm_systemd_unit_added(NULL,
                            NULL,
                            NULL,
@@ -546,25 +628,17 @@ nhm_systemd_test_unit_added(void)
                            NULL);
     g_variant_unref(param);
     /* Check that unit was not added */
-    retval = (nhm_systemd_observed_units == NULL) ? 0 : -1;
+    retval = (g_hash_table_size(nhm_systemd_observed_units) == 0) ? 0 : -1;
   }
 
   /* Check 3: Add new service */
   if(retval == 0)
   {
-    nhm_systemd_observed_units = NULL;
     param = g_variant_new("(so)", "Unit.service", "/Path/to/Unit");
 
-    /* Function will retrieve unit's active state */
-    g_dbus_connection_call_sync_stub_control.count   = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method = "Get";
-
-    unit_state_variant = g_variant_new_string("active");
-    unit_state_variant = g_variant_new_variant(unit_state_variant);
-    unit_state_variant = g_variant_new_tuple(&unit_state_variant, 1);
-    g_dbus_connection_call_sync_stub_calls[0].rval  = unit_state_variant;
-
-    g_dbus_connection_call_sync_stub_control.calls = g_dbus_connection_call_sync_stub_calls;
+    /* Function will request unit's active state asynchronously */
+    g_dbus_connection_call_stub_called = 0;
+    g_dbus_connection_call_stub_method = NULL;
 
     nhm_systemd_unit_added(NULL,
                            NULL,
@@ -575,30 +649,43 @@ nhm_systemd_test_unit_added(void)
                            NULL);
 
     g_variant_unref(param);
-    /* Check that unit was not added */
-    unit = (NhmSystemdUnit*) nhm_systemd_observed_units->data;
-    retval = (   (g_strcmp0(unit->name, "Unit.service") == 0)
+    /* Check that unit was added */
+    unit = g_hash_table_lookup(nhm_systemd_observed_units, "Unit.service");
+    retval = (   (unit != NULL)
+              && (g_strcmp0(unit->name, "Unit.service") == 0)
               && (g_strcmp0(unit->path, "/Path/to/Unit") == 0)
-              && (unit->active_state == NHM_ACTIVE_STATE_ACTIVE)
-              && (unit->sig_sub_id   == 0)) ? 0 : -1;
+              && (unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)
+              && (unit->refresh != NULL)
+              && (g_dbus_connection_call_stub_called == 1)
+              && (g_strcmp0(g_dbus_connection_call_stub_method, "GetAll") == 0))
+             ? 0 : -1;
+  }
 
-    g_slist_free_full(nhm_systemd_observed_units, &nhm_systemd_free_unit);
+  /* Check 4: Initial state replied. Taken over without app status change. */
+  if(retval == 0)
+  {
+    nhm_systemd_test_app_state_changed_cb_called = FALSE;
+
+    /* Reply is owned and released by the callback */
+    g_dbus_connection_call_finish_stub_rval =
+        g_variant_ref_sink(g_variant_new_parsed("({'ActiveState': <'active'>},)"));
+
+    nhm_systemd_unit_refresh_cb(NULL, NULL, unit);
+
+    g_dbus_connection_call_finish_stub_rval = NULL;
+
+    retval = (   (nhm_systemd_test_app_state_changed_cb_called == FALSE)
+              && (unit->active_state == NHM_ACTIVE_STATE_ACTIVE)
+              && (unit->refresh == NULL))
+             ? 0 : -1;
   }
 
-  /* Check 4: Add same service */
+  /* Check 5: Add same service */
   if(retval == 0)
   {
     param = g_variant_new("(so)", "Unit.service", "/Path/to/Unit");
 
-    /* Add unit to the list */
-    nhm_systemd_observed_units = NULL;
-    unit = g_new(NhmSystemdUnit, 1);
-    unit->name         = g_strdup("Unit.service");
-    unit->path         = g_strdup("/Path/to/Unit");
-    unit->active_state = NHM_ACTIVE_STATE_UNKNOWN;
-    unit->sig_sub_id   = 0;
-    nhm_systemd_observed_units = g_slist_append(nhm_systemd_observed_units, unit);
-
+    /* Unit from check 3 still is in the table */
     nhm_systemd_unit_added(NULL,
                            NULL,
                            NULL,
@@ -608,11 +695,17 @@ nhm_systemd_test_unit_added(void)
                            NULL);
 
     g_variant_unref(param);
-    retval = (g_slist_length(nhm_systemd_observed_units) == 1) ? 0 : -1;
-
-    g_slist_free_full(nhm_systemd_observed_units, &nhm_systemd_free_unit);
+    retval = (   (g_hash_table_size(nhm_systemd_observed_units) == 1)
+              && (g_hash_table_lookup(nhm_systemd_observed_units,
+                                      "Unit.service") == unit))
+             ? 0 : -1;
   }
 
+  g_hash_table_destroy(nhm_systemd_units_by_path);
+  nhm_systemd_units_by_path = NULL;
+  g_hash_table_destroy(nhm_systemd_observed_units);
+  nhm_systemd_observed_units = NULL;
+
   return retval;
 }
 
@@ -630,18 +723,13 @@ nhm_systemd_test_unit_removed(void)
   GVariant       *param  = NULL;
   NhmSystemdUnit *unit;
 
-  /* Preparation: Build up a list with an observed unit */
-  nhm_systemd_observed_units = NULL;
-  unit = g_new(NhmSystemdUnit, 1);
-  unit->name         = g_strdup("Unit.service");
-  unit->path         = g_strdup("/Path/to/Unit");
-  unit->active_state = NHM_ACTIVE_STATE_UNKNOWN;
-  unit->sig_sub_id   = 0;
-  nhm_systemd_observed_units = g_slist_append(nhm_systemd_observed_units, unit);
-
-  /* Reuse unit variable to point on first list element */
-  unit = (NhmSystemdUnit*) (nhm_systemd_observed_units->data);
-
+  /* Preparation: Build up a table with an observed unit */
+  nhm_systemd_observed_units = g_hash_table_new_full(&g_str_hash,
+                                                     &g_str_equal,
+                                                     NULL,
+                                                     &nhm_systemd_free_unit);
+  nhm_systemd_units_by_path  = g_hash_table_new(&g_str_hash, &g_str_equal);
+  unit = nhm_systemd_add_unit("Unit.service", "/Path/to/Unit");
 
   /* Check 1: Invalid parameter format  */
   param = g_variant_new("(uss)", 10, "Unit", "/Path/to/Unit");
@@ -654,11 +742,10 @@ nhm_systemd_test_unit_removed(void)
                            param,
                            NULL);
   g_variant_unref(param);
-  /* Assert unit still on the list */
+  /* Assert unit still in the table */
   retval = (   (g_strcmp0(unit->name, "Unit.service") == 0)
             && (g_strcmp0(unit->path, "/Path/to/Unit") == 0)
-            && (unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)
-            && (unit->sig_sub_id   == 0)) ? 0 : -1;
+            && (unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)) ? 0 : -1;
 
   /* Check 2: No service removed */
   if(retval == 0)
@@ -673,11 +760,10 @@ nhm_systemd_test_unit_removed(void)
                              param,
                              NULL);
     g_variant_unref(param);
-    /* Assert unit still on the list */
+    /* Assert unit still in the table */
     retval = (   (g_strcmp0(unit->name, "Unit.service") == 0)
               && (g_strcmp0(unit->path, "/Path/to/Unit") == 0)
-              && (unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)
-              && (unit->sig_sub_id   == 0)) ? 0 : -1;
+              && (unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)) ? 0 : -1;
   }
 
   /* Check 3: Unknown unit removed */
@@ -693,11 +779,10 @@ nhm_systemd_test_unit_removed(void)
                              param,
                              NULL);
     g_variant_unref(param);
-    /* Assert unit still on the list */
+    /* Assert unit still in the table */
     retval = (   (g_strcmp0(unit->name, "Unit.service") == 0)
               && (g_strcmp0(unit->path, "/Path/to/Unit") == 0)
-              && (unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)
-              && (unit->sig_sub_id   == 0)) ? 0 : -1;
+              && (unit->active_state == NHM_ACTIVE_STATE_UNKNOWN)) ? 0 : -1;
   }
 
   /* Check 4: Unit removed */
@@ -713,9 +798,16 @@ nhm_systemd_test_unit_removed(void)
                              param,
                              NULL);
     g_variant_unref(param);
-    retval = (nhm_systemd_observed_units == NULL) ? 0 : -1;
+    retval = (   (g_hash_table_size(nhm_systemd_observed_units) == 0)
+              && (g_hash_table_size(nhm_systemd_units_by_path)  == 0))
+             ? 0 : -1;
   }
 
+  g_hash_table_destroy(nhm_systemd_units_by_path);
+  nhm_systemd_units_by_path = NULL;
+  g_hash_table_destroy(nhm_systemd_observed_units);
+  nhm_systemd_observed_units = NULL;
+
   return retval;
 }
 
@@ -729,12 +821,19 @@ nhm_systemd_test_unit_removed(void)
 static gint
 nhm_systemd_test_unit_properties_changed(void)
 {
-  gint                              retval             = 0;
-  GVariant                         *param              = NULL;
-  GVariant                         *unit_state_variant = NULL;
-  gchar                            *inv_prop[2]        = {"state", NULL};
-  NhmSystemdUnit                    unit;
-  GdbusConnectionCallSyncStubCalls  g_dbus_connection_call_sync_stub_calls[1];
+  gint            retval      = 0;
+  GVariant       *param       = NULL;
+  gchar          *inv_prop[2] = {"state", NULL};
+  NhmSystemdUnit  unit;
+
+  /* Preparation: Observed unit, reachable by its object path */
+  unit.name         = "Unit";
+  unit.path         = "Path";
+  unit.active_state = NHM_ACTIVE_STATE_ACTIVE;
+  unit.refresh      = NULL;
+
+  nhm_systemd_units_by_path = g_hash_table_new(&g_str_hash, &g_str_equal);
+  g_hash_table_insert(nhm_systemd_units_by_path, unit.path, &unit);
 
   /* Check 1: Parameter format nok. */
   param = g_variant_new("(s)", "Test");
@@ -743,7 +842,7 @@ nhm_systemd_test_unit_properties_changed(void)
 
   nhm_systemd_unit_properties_changed(NULL,
                                       NULL,
-                                      NULL,
+                                      "Path",
                                       NULL,
                                       NULL,
                                       param,
@@ -762,7 +861,7 @@ nhm_systemd_test_unit_properties_changed(void)
 
     nhm_systemd_unit_properties_changed(NULL,
                                         NULL,
-                                        NULL,
+                                        "Path",
                                         NULL,
                                         NULL,
                                         param,
@@ -771,70 +870,154 @@ nhm_systemd_test_unit_properties_changed(void)
     retval = (nhm_systemd_test_app_state_changed_cb_called == FALSE) ? 0 : -1;
   }
 
-  /* Check 3: Parameter format ok. Same ActiveState. */
+  /* Check 3: ActiveState changed, but state of unit is the same. */
   if(retval == 0)
   {
-    inv_prop[0] = "ActiveState";
-    param = g_variant_new("(sa{sv}^as)", "Test", NULL, inv_prop);
+    inv_prop[0] = NULL;
+    param = g_variant_new("(s@a{sv}^as)", "Test",
+                          g_variant_new_parsed("{'ActiveState': <'active'>}"),
+                          inv_prop);
 
-    unit.name = "Unit";
-    unit.path = "Path";
     unit.active_state = NHM_ACTIVE_STATE_ACTIVE;
-    unit.sig_sub_id = 0;
-
-    g_dbus_connection_call_sync_stub_control.count    = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method  = "Get";
-    unit_state_variant = g_variant_new_string("active");
-    unit_state_variant = g_variant_new_variant(unit_state_variant);
-    unit_state_variant = g_variant_new_tuple(&unit_state_variant, 1);
-    g_dbus_connection_call_sync_stub_calls[0].rval  = unit_state_variant;
-    g_dbus_connection_call_sync_stub_control.calls  = g_dbus_connection_call_sync_stub_calls;
 
     nhm_systemd_app_status_cb = &nhm_systemd_test_app_state_changed_cb;
     nhm_systemd_test_app_state_changed_cb_called = FALSE;
+    g_dbus_connection_call_stub_called = 0;
 
     nhm_systemd_unit_properties_changed(NULL,
                                         NULL,
+                                        "Path",
+                                        NULL,
+                                        NULL,
+                                        param,
+                                        NULL);
+    g_variant_unref(param);
+    retval = (   (nhm_systemd_test_app_state_changed_cb_called == FALSE)
+              && (g_dbus_connection_call_stub_called           == 0))
+             ? 0 : -1;
+  }
+
+  /* Check 4: ActiveState changed. New state taken from the signal. */
+  if(retval == 0)
+  {
+    inv_prop[0] = NULL;
+    param = g_variant_new("(s@a{sv}^as)", "Test",
+                          g_variant_new_parsed("{'ActiveState': <'active'>}"),
+                          inv_prop);
+
+    unit.active_state = NHM_ACTIVE_STATE_FAILED;
+
+    nhm_systemd_test_app_state_changed_cb_called = FALSE;
+    g_dbus_connection_call_stub_called = 0;
+
+    nhm_systemd_unit_properties_changed(NULL,
                                         NULL,
+                                        "Path",
                                         NULL,
                                         NULL,
                                         param,
-                                        &unit);
+                                        NULL);
     g_variant_unref(param);
-    retval = (nhm_systemd_test_app_state_changed_cb_called == FALSE) ? 0 : -1;
+    retval = (   (nhm_systemd_test_app_state_changed_cb_called == TRUE)
+              && (nhm_systemd_test_app_state_changed_cb_status == NhmAppStatus_Ok)
+              && (unit.active_state == NHM_ACTIVE_STATE_ACTIVE)
+              && (g_dbus_connection_call_stub_called == 0))
+             ? 0 : -1;
   }
 
-  /* Check 4: Parameter format ok. ActiveState changed. */
+  /* Check 5: ActiveState invalidated twice. One async refresh started. */
   if(retval == 0)
   {
     inv_prop[0] = "ActiveState";
-    param = g_variant_new("(sa{sv}^as)", "Test", NULL, inv_prop);
-
-    unit.name = "Unit";
-    unit.path = "Path";
     unit.active_state = NHM_ACTIVE_STATE_FAILED;
-    unit.sig_sub_id = 0;
-    g_dbus_connection_call_sync_stub_control.count = 1;
-    g_dbus_connection_call_sync_stub_calls[0].method  = "Get";
-    unit_state_variant = g_variant_new_string("active");
-    unit_state_variant = g_variant_new_variant(unit_state_variant);
-    unit_state_variant = g_variant_new_tuple(&unit_state_variant, 1);
-    g_dbus_connection_call_sync_stub_calls[0].rval  = unit_state_variant;
-    g_dbus_connection_call_sync_stub_control.calls  = g_dbus_connection_call_sync_stub_calls;
 
     nhm_systemd_test_app_state_changed_cb_called = FALSE;
-    nhm_systemd_app_status_cb = &nhm_systemd_test_app_state_changed_cb;
+    g_dbus_connection_call_stub_called = 0;
+    g_dbus_connection_call_stub_method = NULL;
+
+    param = g_variant_new("(sa{sv}^as)", "Test", NULL, inv_prop);
     nhm_systemd_unit_properties_changed(NULL,
+                                        NULL,
+                                        "Path",
                                         NULL,
                                         NULL,
+                                        param,
+                                        NULL);
+    g_variant_unref(param);
+
+    param = g_variant_new("(sa{sv}^as)", "Test", NULL, inv_prop);
+    nhm_systemd_unit_properties_changed(NULL,
+                                        NULL,
+                                        "Path",
                                         NULL,
                                         NULL,
                                         param,
-                                        &unit);
+                                        NULL);
     g_variant_unref(param);
-    retval = (nhm_systemd_test_app_state_changed_cb_called == TRUE) ? 0 : -1;
+
+    retval = (   (nhm_systemd_test_app_state_changed_cb_called == FALSE)
+              && (g_dbus_connection_call_stub_called == 1)
+              && (g_strcmp0(g_dbus_connection_call_stub_method, "GetAll") == 0)
+              && (unit.refresh != NULL))
+             ? 0 : -1;
   }
 
+  /* Check 6: Refresh cancelled. Unit not accessed. */
+  if(retval == 0)
+  {
+    g_dbus_connection_call_finish_stub_cancelled = TRUE;
+
+    nhm_systemd_unit_refresh_cb(NULL, NULL, &unit);
+
+    g_dbus_connection_call_finish_stub_cancelled = FALSE;
+    retval = (   (nhm_systemd_test_app_state_changed_cb_called == FALSE)
+              && (unit.refresh != NULL))
+             ? 0 : -1;
+  }
+
+  /* Check 7: Refresh replied. New state processed. */
+  if(retval == 0)
+  {
+    /* Reply is owned and released by the callback */
+    g_dbus_connection_call_finish_stub_rval =
+        g_variant_ref_sink(g_variant_new_parsed("({'ActiveState': <'active'>},)"));
+
+    nhm_systemd_unit_refresh_cb(NULL, NULL, &unit);
+
+    g_dbus_connection_call_finish_stub_rval = NULL;
+
+    retval = (   (nhm_systemd_test_app_state_changed_cb_called == TRUE)
+              && (unit.active_state == NHM_ACTIVE_STATE_ACTIVE)
+              && (unit.refresh == NULL))
+             ? 0 : -1;
+  }
+
+  /* Check 8: Signal for an object, which is no observed unit. Ignored. */
+  if(retval == 0)
+  {
+    inv_prop[0] = NULL;
+    param = g_variant_new("(s@a{sv}^as)", "Test",
+                          g_variant_new_parsed("{'ActiveState': <'failed'>}"),
+                          inv_prop);
+
+    nhm_systemd_test_app_state_changed_cb_called = FALSE;
+
+    nhm_systemd_unit_properties_changed(NULL,
+                                        NULL,
+                                        "Other",
+                                        NULL,
+                                        NULL,
+                                        param,
+                                        NULL);
+    g_variant_unref(param);
+    retval = (   (nhm_systemd_test_app_state_changed_cb_called == FALSE)
+              && (unit.active_state == NHM_ACTIVE_STATE_ACTIVE))
+             ? 0 : -1;
+  }
+
+  g_hash_table_destroy(nhm_systemd_units_by_path);
+  nhm_systemd_units_by_path = NULL;
+
   return retval;
 }
 
@@ -860,7 +1043,8 @@ main(void)
   g_type_init();
 
   /* Test interfaces */
-  retval = nhm_test_systemd_connect();
+  retval = nhm_systemd_test_unit_is_observed();
+  retval = (retval == 0) ? nhm_test_systemd_connect()                      : -1;
   retval = (retval == 0) ? nhm_test_systemd_disconnect()                   : -1;
 
   /* Test static functions */
@@ -868,15 +1052,17 @@ main(void)
 
   /* Test helper functions */
   retval = (retval == 0) ? nhm_systemd_test_subscribe_properties_changed() : -1;
-  retval = (retval == 0) ? nhm_systemd_test_find_unit_by_name()            : -1;
+  retval = (retval == 0) ? nhm_systemd_test_add_unit()                     : -1;
   retval = (retval == 0) ? nhm_systemd_test_free_unit()                    : -1;
 
   /* Test unit state change chain */
   retval = (retval == 0) ? nhm_systemd_test_unit_active_state_changed()    : -1;
-  retval = (retval == 0) ? nhm_systemd_test_unit_get_active_state()        : -1;
   retval = (retval == 0) ? nhm_systemd_test_unit_added()                   : -1;
   retval = (retval == 0) ? nhm_systemd_test_unit_removed()                 : -1;
   retval = (retval == 0) ? nhm_systemd_test_unit_properties_changed()      : -1;
 
+  /* Free the unit filter, set by the tests */
+  nhm_systemd_free_unit_filter();
+
   return retval;
 }
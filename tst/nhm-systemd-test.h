@@ -59,9 +59,21 @@
 #define g_bus_get_sync \
         g_bus_get_sync_stub
 
+#define g_bus_get \
+        g_bus_get_stub
+
+#define g_bus_get_finish \
+        g_bus_get_finish_stub
+
 #define g_dbus_connection_call_sync \
         g_dbus_connection_call_sync_stub
 
+#define g_dbus_connection_call \
+        g_dbus_connection_call_stub
+
+#define g_dbus_connection_call_finish \
+        g_dbus_connection_call_finish_stub
+
 #define g_dbus_connection_signal_subscribe \
         g_dbus_connection_signal_subscribe_stub
 
@@ -83,7 +95,11 @@
 #undef dlt_user_log_write_uint
 
 #undef g_bus_get_sync
+#undef g_bus_get
+#undef g_bus_get_finish
 #undef g_dbus_connection_call_sync
+#undef g_dbus_connection_call
+#undef g_dbus_connection_call_finish
 #undef g_dbus_connection_signal_subscribe
 #undef g_dbus_connection_signal_unsubscribe
 
@@ -31,6 +31,12 @@ gint nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount = 0;
 gint nhm_dbus_info_complete_read_statistics_stub_TotalFailures    = 0;
 gint nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = 0;
 gint nhm_dbus_info_complete_request_node_restart_stub_ErrorStatus = 0;
+GVariant *nhm_dbus_info_complete_read_all_statistics_stub_AppStatistics = NULL;
+GVariant *nhm_dbus_info_complete_read_check_intervals_stub_CheckIntervals = NULL;
+GVariant *nhm_dbus_info_complete_get_health_report_stub_Report = NULL;
+gint nhm_dbus_info_emit_app_health_status_stub_called             = 0;
+gint nhm_dbus_info_emit_app_health_status_batch_stub_called       = 0;
+gint nhm_dbus_info_complete_register_app_status_batch_stub_called = 0;
 
 
 /*******************************************************************************
@@ -49,7 +55,19 @@ nhm_dbus_info_emit_app_health_status_stub(NhmDbusInfo *object,
                                           const gchar *arg_AppName,
                                           gint         arg_AppStatus)
 {
+  nhm_dbus_info_emit_app_health_status_stub_called++;
+}
 
+/**
+ * nhm_dbus_info_emit_app_health_status_batch_stub:
+ *
+ * Stub for nhm_dbus_info_emit_app_health_status_batch()
+ */
+void
+nhm_dbus_info_emit_app_health_status_batch_stub(NhmDbusInfo *object,
+                                                GVariant    *arg_AppStatusList)
+{
+  nhm_dbus_info_emit_app_health_status_batch_stub_called++;
 }
 
 /**
@@ -64,6 +82,18 @@ nhm_dbus_info_complete_register_app_status_stub(NhmDbusInfo           *object,
 
 }
 
+/**
+ * nhm_dbus_info_complete_register_app_status_batch_stub:
+ *
+ * Stub for nhm_dbus_info_complete_register_app_status_batch()
+ */
+void
+nhm_dbus_info_complete_register_app_status_batch_stub(NhmDbusInfo           *object,
+                                                      GDBusMethodInvocation *invocation)
+{
+  nhm_dbus_info_complete_register_app_status_batch_stub_called++;
+}
+
 /**
  * nhm_dbus_info_complete_read_statistics_stub:
  *
@@ -82,6 +112,66 @@ nhm_dbus_info_complete_read_statistics_stub(NhmDbusInfo           *object,
   nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles  = TotalLifecycles;
 }
 
+/**
+ * nhm_dbus_info_complete_read_all_statistics_stub:
+ *
+ * Stub for nhm_dbus_info_complete_read_all_statistics(). Keeps the returned
+ * dictionary. The previously kept dictionary is freed.
+ */
+void
+nhm_dbus_info_complete_read_all_statistics_stub(NhmDbusInfo           *object,
+                                                GDBusMethodInvocation *invocation,
+                                                GVariant              *AppStatistics,
+                                                gint                   ErrorStatus)
+{
+  if(nhm_dbus_info_complete_read_all_statistics_stub_AppStatistics != NULL)
+  {
+    g_variant_unref(nhm_dbus_info_complete_read_all_statistics_stub_AppStatistics);
+  }
+
+  nhm_dbus_info_complete_read_all_statistics_stub_AppStatistics =
+    g_variant_ref_sink(AppStatistics);
+}
+
+/**
+ * nhm_dbus_info_complete_get_health_report_stub:
+ *
+ * Stub for nhm_dbus_info_complete_get_health_report(). Keeps the returned
+ * report. The previously kept report is freed.
+ */
+void
+nhm_dbus_info_complete_get_health_report_stub(NhmDbusInfo           *object,
+                                              GDBusMethodInvocation *invocation,
+                                              GVariant              *Report)
+{
+  if(nhm_dbus_info_complete_get_health_report_stub_Report != NULL)
+  {
+    g_variant_unref(nhm_dbus_info_complete_get_health_report_stub_Report);
+  }
+
+  nhm_dbus_info_complete_get_health_report_stub_Report = g_variant_ref_sink(Report);
+}
+
+/**
+ * nhm_dbus_info_complete_read_check_intervals_stub:
+ *
+ * Stub for nhm_dbus_info_complete_read_check_intervals(). Keeps the returned
+ * dictionary. The previously kept dictionary is freed.
+ */
+void
+nhm_dbus_info_complete_read_check_intervals_stub(NhmDbusInfo           *object,
+                                                 GDBusMethodInvocation *invocation,
+                                                 GVariant              *CheckIntervals)
+{
+  if(nhm_dbus_info_complete_read_check_intervals_stub_CheckIntervals != NULL)
+  {
+    g_variant_unref(nhm_dbus_info_complete_read_check_intervals_stub_CheckIntervals);
+  }
+
+  nhm_dbus_info_complete_read_check_intervals_stub_CheckIntervals =
+    g_variant_ref_sink(CheckIntervals);
+}
+
 /**
  * nhm_dbus_info_complete_request_node_restart_stub:
  *
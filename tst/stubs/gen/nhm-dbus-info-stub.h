@@ -33,6 +33,12 @@ extern gint nhm_dbus_info_complete_read_statistics_stub_CurrentFailCount;
 extern gint nhm_dbus_info_complete_read_statistics_stub_TotalFailures;
 extern gint nhm_dbus_info_complete_read_statistics_stub_TotalLifecycles;
 extern gint nhm_dbus_info_complete_request_node_restart_stub_ErrorStatus;
+extern GVariant *nhm_dbus_info_complete_read_all_statistics_stub_AppStatistics;
+extern GVariant *nhm_dbus_info_complete_read_check_intervals_stub_CheckIntervals;
+extern GVariant *nhm_dbus_info_complete_get_health_report_stub_Report;
+extern gint nhm_dbus_info_emit_app_health_status_stub_called;
+extern gint nhm_dbus_info_emit_app_health_status_batch_stub_called;
+extern gint nhm_dbus_info_complete_register_app_status_batch_stub_called;
 
 /*******************************************************************************
 *
@@ -44,9 +50,17 @@ void nhm_dbus_info_emit_app_health_status_stub       (NhmDbusInfo           *obj
                                                       const gchar           *arg_AppName,
                                                       gint                   arg_AppStatus);
 
+void nhm_dbus_info_emit_app_health_status_batch_stub
+                                                     (NhmDbusInfo           *object,
+                                                      GVariant              *arg_AppStatusList);
+
 void nhm_dbus_info_complete_register_app_status_stub (NhmDbusInfo           *object,
                                                       GDBusMethodInvocation *invocation);
 
+void nhm_dbus_info_complete_register_app_status_batch_stub
+                                                     (NhmDbusInfo           *object,
+                                                      GDBusMethodInvocation *invocation);
+
 void nhm_dbus_info_complete_read_statistics_stub     (NhmDbusInfo           *object,
                                                       GDBusMethodInvocation *invocation,
                                                       guint                  CurrentFailCount,
@@ -54,6 +68,19 @@ void nhm_dbus_info_complete_read_statistics_stub     (NhmDbusInfo           *obj
                                                       guint                  TotalLifecycles,
                                                       gint                   ErrorStatus);
 
+void nhm_dbus_info_complete_read_all_statistics_stub (NhmDbusInfo           *object,
+                                                      GDBusMethodInvocation *invocation,
+                                                      GVariant              *AppStatistics,
+                                                      gint                   ErrorStatus);
+
+void nhm_dbus_info_complete_get_health_report_stub   (NhmDbusInfo           *object,
+                                                      GDBusMethodInvocation *invocation,
+                                                      GVariant              *Report);
+
+void nhm_dbus_info_complete_read_check_intervals_stub
+                                                     (NhmDbusInfo           *object,
+                                                      GDBusMethodInvocation *invocation,
+                                                      GVariant              *CheckIntervals);
 
 void nhm_dbus_info_complete_request_node_restart_stub(NhmDbusInfo           *object,
                                                       GDBusMethodInvocation *invocation,
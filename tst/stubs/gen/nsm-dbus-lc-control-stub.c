@@ -28,10 +28,23 @@
 *******************************************************************************/
 
 gboolean nsm_dbus_lc_control_proxy_new_sync_stub_set_error                     = FALSE;
-gboolean nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error    = FALSE;
+gboolean nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error  = FALSE;
+gboolean nsm_dbus_lc_control_call_set_app_health_status_stub_defer             = FALSE;
+guint    nsm_dbus_lc_control_call_set_app_health_status_stub_calls             = 0;
+gchar   *nsm_dbus_lc_control_call_set_app_health_status_stub_AppName           = NULL;
+gboolean nsm_dbus_lc_control_call_set_app_health_status_stub_AppRunning        = FALSE;
 gboolean nsm_dbus_lc_control_call_request_node_restart_sync_stub_set_error     = FALSE;
 gint     nsm_dbus_lc_control_call_request_node_restart_sync_stub_out_ErrorCode = 0;
 
+/*******************************************************************************
+*
+* Local variables and constants
+*
+*******************************************************************************/
+
+/* Deferred 'SetAppHealthStatus' calls */
+static GSList *deferred_calls = NULL;
+
 /*******************************************************************************
 *
 * Interfaces. Exported functions.
@@ -67,21 +80,82 @@ nsm_dbus_lc_control_proxy_new_sync_stub(GDBusConnection *connection,
 }
 
 /**
- * nsm_dbus_lc_control_call_set_app_health_status_sync_stub:
+ * nsm_dbus_lc_control_call_set_app_health_status_stub:
+ *
+ * Stub for nsm_dbus_lc_control_call_set_app_health_status(). The callback is
+ * called immediately, unless the call should be deferred. Deferred calls are
+ * finished with 'nsm_dbus_lc_control_call_set_app_health_status_stub_finish'.
+ */
+void
+nsm_dbus_lc_control_call_set_app_health_status_stub(NsmDbusLcControl    *proxy,
+                                                    const gchar         *arg_AppName,
+                                                    gboolean             arg_AppRunning,
+                                                    GCancellable        *cancellable,
+                                                    GAsyncReadyCallback  callback,
+                                                    gpointer             user_data)
+{
+  NsmDbusLcControlStubCall *call = NULL;
+
+  nsm_dbus_lc_control_call_set_app_health_status_stub_calls++;
+  g_free(nsm_dbus_lc_control_call_set_app_health_status_stub_AppName);
+  nsm_dbus_lc_control_call_set_app_health_status_stub_AppName    = g_strdup(arg_AppName);
+  nsm_dbus_lc_control_call_set_app_health_status_stub_AppRunning = arg_AppRunning;
+
+  if(nsm_dbus_lc_control_call_set_app_health_status_stub_defer == FALSE)
+  {
+    callback((GObject*) proxy, NULL, user_data);
+  }
+  else
+  {
+    call            = g_new(NsmDbusLcControlStubCall, 1);
+    call->proxy     = proxy;
+    call->callback  = callback;
+    call->user_data = user_data;
+
+    deferred_calls = g_slist_append(deferred_calls, call);
+  }
+}
+
+/**
+ * nsm_dbus_lc_control_call_set_app_health_status_stub_finish:
+ *
+ * Calls the callback of the oldest deferred call.
+ *
+ * Return value: %TRUE if a deferred call has been finished.
+ */
+gboolean
+nsm_dbus_lc_control_call_set_app_health_status_stub_finish(void)
+{
+  gboolean                  retval = FALSE;
+  NsmDbusLcControlStubCall *call   = NULL;
+
+  if(deferred_calls != NULL)
+  {
+    retval = TRUE;
+    call   = (NsmDbusLcControlStubCall*) deferred_calls->data;
+    deferred_calls = g_slist_remove(deferred_calls, call);
+
+    call->callback((GObject*) call->proxy, NULL, call->user_data);
+    g_free(call);
+  }
+
+  return retval;
+}
+
+/**
+ * nsm_dbus_lc_control_call_set_app_health_status_finish_stub:
  *
- * Stub for nsm_dbus_lc_control_call_set_app_health_status_sync()
+ * Stub for nsm_dbus_lc_control_call_set_app_health_status_finish()
  */
 gboolean
-nsm_dbus_lc_control_call_set_app_health_status_sync_stub(NsmDbusLcControl *proxy,
-                                                         const gchar      *arg_AppName,
-                                                         gboolean          arg_AppRunning,
-                                                         gint             *out_ErrorCode,
-                                                         GCancellable     *cancellable,
-                                                         GError          **error)
+nsm_dbus_lc_control_call_set_app_health_status_finish_stub(NsmDbusLcControl *proxy,
+                                                           gint             *out_ErrorCode,
+                                                           GAsyncResult     *res,
+                                                           GError          **error)
 {
   gboolean retval = FALSE;
 
-  if(nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error == FALSE)
+  if(nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error == FALSE)
   {
     retval = TRUE;
   }
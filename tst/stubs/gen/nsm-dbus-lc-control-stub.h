@@ -30,10 +30,29 @@
 *******************************************************************************/
 
 extern gboolean nsm_dbus_lc_control_proxy_new_sync_stub_set_error;
-extern gboolean nsm_dbus_lc_control_call_set_app_health_status_sync_stub_set_error;
+extern gboolean nsm_dbus_lc_control_call_set_app_health_status_finish_stub_set_error;
+extern gboolean nsm_dbus_lc_control_call_set_app_health_status_stub_defer;
+extern guint    nsm_dbus_lc_control_call_set_app_health_status_stub_calls;
+extern gchar   *nsm_dbus_lc_control_call_set_app_health_status_stub_AppName;
+extern gboolean nsm_dbus_lc_control_call_set_app_health_status_stub_AppRunning;
 extern gboolean nsm_dbus_lc_control_call_request_node_restart_sync_stub_set_error;
 extern gint     nsm_dbus_lc_control_call_request_node_restart_sync_stub_out_ErrorCode;
 
+/**
+ * NsmDbusLcControlStubCall:
+ * @proxy:     Proxy on which the call has been made.
+ * @callback:  Callback to call, when the call is finished.
+ * @user_data: User data for the callback.
+ *
+ * Asynchronous call whose callback has been deferred by the stub.
+ */
+typedef struct
+{
+  NsmDbusLcControl    *proxy;
+  GAsyncReadyCallback  callback;
+  gpointer             user_data;
+} NsmDbusLcControlStubCall;
+
 /*******************************************************************************
 *
 * Exported functions
@@ -49,12 +68,19 @@ NsmDbusLcControl* nsm_dbus_lc_control_proxy_new_sync_stub                 (GDBus
 
 
 
-gboolean          nsm_dbus_lc_control_call_set_app_health_status_sync_stub(NsmDbusLcControl *proxy,
-                                                                           const gchar      *arg_AppName,
-                                                                           gboolean          arg_AppRunning,
-                                                                           gint             *out_ErrorCode,
-                                                                           GCancellable     *cancellable,
-                                                                           GError          **error);
+void              nsm_dbus_lc_control_call_set_app_health_status_stub       (NsmDbusLcControl     *proxy,
+                                                                             const gchar          *arg_AppName,
+                                                                             gboolean              arg_AppRunning,
+                                                                             GCancellable         *cancellable,
+                                                                             GAsyncReadyCallback   callback,
+                                                                             gpointer              user_data);
+
+gboolean          nsm_dbus_lc_control_call_set_app_health_status_stub_finish(void);
+
+gboolean          nsm_dbus_lc_control_call_set_app_health_status_finish_stub(NsmDbusLcControl     *proxy,
+                                                                             gint                 *out_ErrorCode,
+                                                                             GAsyncResult         *res,
+                                                                             GError              **error);
 
 
 gboolean          nsm_dbus_lc_control_call_request_node_restart_sync_stub (NsmDbusLcControl  *proxy,
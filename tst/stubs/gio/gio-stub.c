@@ -19,6 +19,7 @@
 
 #include <stdio.h>                  /* NULL               */
 #include <string.h>                 /* strcmp             */
+#include <sys/types.h>              /* pid_t              */
 #include <gio/gio.h>                /* Header of real gio */
 #include <tst/stubs/gio/gio-stub.h> /* Header of stub gio */
 
@@ -30,23 +31,25 @@
 *******************************************************************************/
 
 gboolean  g_bus_get_sync_set_error                              = FALSE;
+gboolean  g_bus_get_stub_called                                 = FALSE;
 gboolean  g_dbus_interface_skeleton_export_stub_set_error       = FALSE;
 gboolean  g_main_loop_quit_stub_called                          = FALSE;
 guint     g_timeout_add_seconds_called_interval                 = 0;
 gboolean  g_timeout_add_seconds_called                          = FALSE;
-gboolean  g_dbus_connection_new_for_address_sync_stub_set_error = FALSE;
+gboolean  g_dbus_connection_new_for_address_finish_stub_set_error = FALSE;
+guint     g_dbus_connection_new_for_address_stub_called         = 0;
 GdbusConnectionCallSyncStubControl g_dbus_connection_call_sync_stub_control;
+guint        g_dbus_connection_call_stub_called            = 0;
+const gchar *g_dbus_connection_call_stub_method            = NULL;
+GVariant    *g_dbus_connection_call_finish_stub_rval       = NULL;
+gboolean     g_dbus_connection_call_finish_stub_cancelled  = FALSE;
+gint         g_dbus_connection_call_finish_stub_error_code = G_DBUS_ERROR_FAILED;
+gboolean     g_file_test_stub_deleted                      = FALSE;
+guint        g_spawn_async_stub_called                     = 0;
+pid_t        kill_stub_pid                                 = 0;
+int          kill_stub_signal                              = 0;
 
 
-/*******************************************************************************
-*
-* File local variables and constants
-*
-*******************************************************************************/
-
-static guint  folder_file_idx = 0;
-static gchar *folder_files[]  = {"0000", "0001", NULL};
-
 /*******************************************************************************
 *
 * Interfaces. Exported functions.
@@ -56,110 +59,67 @@ static gchar *folder_files[]  = {"0000", "0001", NULL};
 /**
  * g_file_test_stub:
  *
- * Stub for g_file_test()
+ * Stub for g_file_test(). Only "existing_file" exists, until it is deleted.
  */
 gboolean
 g_file_test_stub(const gchar *filename,
                  GFileTest    test)
 {
-  return (g_strcmp0(filename, "existing_file") == 0);
+  return    (g_strcmp0(filename, "existing_file") == 0)
+         && (g_file_test_stub_deleted == FALSE);
 }
 
+
 /**
- * g_file_read_link_stub:
+ * g_bus_get_sync_stub:
  *
- * Stub for g_file_read_link()
+ * Stub for g_bus_get_sync()
  */
-gchar*
-g_file_read_link_stub(const gchar  *filename,
-                      GError      **error)
+GDBusConnection*
+g_bus_get_sync_stub(GBusType       bus_type,
+                    GCancellable  *cancellable,
+                    GError       **error)
 {
-  gchar *linked_file = NULL;
+  gpointer retval = FALSE;
 
-  if(strcmp("/proc/0000/exe", filename) == 0)
-  {
-    linked_file = g_strdup("/usr/bin/valid_prog1");
-  }
-  else if(strcmp("/proc/0001/exe", filename) == 0)
+  if(g_bus_get_sync_set_error == FALSE)
   {
-    linked_file = g_strdup("/usr/bin/valid_prog2");
+    retval = g_object_new(G_TYPE_DBUS_CONNECTION, NULL);
   }
   else
   {
-    linked_file = NULL;
-  }
-
-  return linked_file;
-}
-
-/**
- * g_dir_open_stub:
- *
- * Stub for g_dir_open()
- */
-GDir*
-g_dir_open_stub(const gchar *path,
-                guint        flags,
-                GError     **error)
-{
-  folder_file_idx = 0;
-  return (GDir*) folder_files;
-}
-
-/**
- * g_dir_read_name_stub:
- *
- * Stub for g_dir_read_name()
- */
-const gchar*
-g_dir_read_name_stub(GDir *dir)
-{
-  gchar *file_name = NULL;
-
-  if(folder_file_idx < sizeof(folder_files)/sizeof(gchar*))
-  {
-    file_name = folder_files[folder_file_idx];
-    folder_file_idx++;
+    retval = NULL;
+    g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, NULL);
   }
 
-  return file_name;
+  return retval;
 }
 
 /**
- * g_dir_close_stub:
+ * g_bus_get_stub:
  *
- * Stub for g_dir_close()
+ * Stub for g_bus_get(). The call is only recorded. Tests invoke the callback
+ * themselves.
  */
 void
-g_dir_close_stub(GDir *dir)
+g_bus_get_stub(GBusType             bus_type,
+               GCancellable        *cancellable,
+               GAsyncReadyCallback  callback,
+               gpointer             user_data)
 {
-  folder_file_idx = 0;
+  g_bus_get_stub_called = TRUE;
 }
 
-
 /**
- * g_bus_get_sync_stub:
+ * g_bus_get_finish_stub:
  *
- * Stub for g_bus_get_sync()
+ * Stub for g_bus_get_finish()
  */
 GDBusConnection*
-g_bus_get_sync_stub(GBusType       bus_type,
-                    GCancellable  *cancellable,
-                    GError       **error)
+g_bus_get_finish_stub(GAsyncResult  *res,
+                      GError       **error)
 {
-  gpointer retval = FALSE;
-
-  if(g_bus_get_sync_set_error == FALSE)
-  {
-    retval = g_object_new(G_TYPE_DBUS_CONNECTION, NULL);
-  }
-  else
-  {
-    retval = NULL;
-    g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED, NULL);
-  }
-
-  return retval;
+  return g_bus_get_sync_stub(G_BUS_TYPE_SYSTEM, NULL, error);
 }
 
 /**
@@ -219,20 +179,35 @@ g_dbus_interface_skeleton_export_stub(GDBusInterfaceSkeleton *interface_,
 
 
 /**
- * g_dbus_connection_new_for_address_sync_stub:
+ * g_dbus_connection_new_for_address_stub:
+ *
+ * Stub for g_dbus_connection_new_for_address(). The call is only counted.
+ * Tests invoke the callback themselves.
+ */
+void
+g_dbus_connection_new_for_address_stub(const gchar          *address,
+                                       GDBusConnectionFlags  flags,
+                                       GDBusAuthObserver    *observer,
+                                       GCancellable         *cancellable,
+                                       GAsyncReadyCallback   callback,
+                                       gpointer              user_data)
+{
+  g_dbus_connection_new_for_address_stub_called++;
+}
+
+
+/**
+ * g_dbus_connection_new_for_address_finish_stub:
  *
- * Stub for g_dbus_connection_new_for_address_sync()
+ * Stub for g_dbus_connection_new_for_address_finish()
  */
 GDBusConnection*
-g_dbus_connection_new_for_address_sync_stub(const gchar          *address,
-                                            GDBusConnectionFlags  flags,
-                                            GDBusAuthObserver    *observer,
-                                            GCancellable         *cancellable,
-                                            GError              **error)
+g_dbus_connection_new_for_address_finish_stub(GAsyncResult  *res,
+                                              GError       **error)
 {
   GDBusConnection *retval = NULL;
 
-  if(g_dbus_connection_new_for_address_sync_stub_set_error == FALSE)
+  if(g_dbus_connection_new_for_address_finish_stub_set_error == FALSE)
   {
     retval = g_object_new(G_TYPE_DBUS_CONNECTION, NULL);
   }
@@ -328,6 +303,65 @@ g_dbus_connection_signal_unsubscribe_stub(GDBusConnection *connection,
 }
 
 
+/**
+ * g_dbus_connection_call_stub:
+ *
+ * Stub for g_dbus_connection_call(). The call is only counted. Tests invoke
+ * the callback themselves.
+ */
+void
+g_dbus_connection_call_stub(GDBusConnection     *connection,
+                            const gchar         *bus_name,
+                            const gchar         *object_path,
+                            const gchar         *interface_name,
+                            const gchar         *method_name,
+                            GVariant            *parameters,
+                            const GVariantType  *reply_type,
+                            GDBusCallFlags       flags,
+                            gint                 timeout_msec,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+  g_dbus_connection_call_stub_called++;
+  g_dbus_connection_call_stub_method = method_name;
+
+  if(parameters != NULL)
+  {
+    g_variant_unref(g_variant_ref_sink(parameters));
+  }
+}
+
+
+/**
+ * g_dbus_connection_call_finish_stub:
+ *
+ * Stub for g_dbus_connection_call_finish()
+ */
+GVariant*
+g_dbus_connection_call_finish_stub(GDBusConnection  *connection,
+                                   GAsyncResult     *res,
+                                   GError          **error)
+{
+  GVariant *rval = g_dbus_connection_call_finish_stub_rval;
+
+  if(g_dbus_connection_call_finish_stub_cancelled == TRUE)
+  {
+    rval = NULL;
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED, NULL);
+  }
+  else if(rval == NULL)
+  {
+    g_set_error(error,
+                G_DBUS_ERROR,
+                g_dbus_connection_call_finish_stub_error_code,
+                NULL);
+  }
+
+  return rval;
+}
+
+
 /**
  * g_main_loop_run_stub:
  *
@@ -382,35 +416,31 @@ g_signal_connect_data_stub(gpointer       instance,
 }
 
 /**
- * g_spawn_sync_stub:
+ * g_spawn_async_stub:
  *
- * Stub for g_spawn_sync()
+ * Stub for g_spawn_async(). The procs. "valid_proc", "failing_proc" and
+ * "hanging_proc" can be started. They get the PID 'G_SPAWN_ASYNC_STUB_PID'.
  */
 gboolean
-g_spawn_sync_stub(const gchar          *working_directory,
-                  gchar               **argv,
-                  gchar               **envp,
-                  GSpawnFlags           flags,
-                  GSpawnChildSetupFunc  child_setup,
-                  gpointer              user_data,
-                  gchar               **standard_output,
-                  gchar               **standard_error,
-                  gint                 *exit_status,
-                  GError              **error)
+g_spawn_async_stub(const gchar          *working_directory,
+                   gchar               **argv,
+                   gchar               **envp,
+                   GSpawnFlags           flags,
+                   GSpawnChildSetupFunc  child_setup,
+                   gpointer              user_data,
+                   GPid                 *child_pid,
+                   GError              **error)
 {
   gboolean retval = FALSE;
 
-  if(strcmp(argv[0], "valid_proc") == 0)
-  {
-    retval       = TRUE;
-    *exit_status = 0;
-    *error       = NULL;
-  }
-  else if(strcmp(argv[0], "failing_proc") == 0)
+  g_spawn_async_stub_called++;
+
+  if(   (strcmp(argv[0], "valid_proc")   == 0)
+     || (strcmp(argv[0], "failing_proc") == 0)
+     || (strcmp(argv[0], "hanging_proc") == 0))
   {
-    retval       = TRUE;
-    *exit_status = -1;
-    *error       = NULL;
+    retval     = TRUE;
+    *child_pid = G_SPAWN_ASYNC_STUB_PID;
   }
   else
   {
@@ -420,3 +450,18 @@ g_spawn_sync_stub(const gchar          *working_directory,
 
   return retval;
 }
+
+/**
+ * kill_stub:
+ *
+ * Stub for kill()
+ */
+int
+kill_stub(pid_t pid,
+          int   sig)
+{
+  kill_stub_pid    = pid;
+  kill_stub_signal = sig;
+
+  return 0;
+}
@@ -20,7 +20,8 @@
 *
 *******************************************************************************/
 
-#include <gio/gio.h> /* Include header of real gio */
+#include <sys/types.h> /* pid_t                       */
+#include <gio/gio.h>   /* Include header of real gio */
 
 /*******************************************************************************
 *
@@ -43,12 +44,25 @@ typedef struct
 
 extern gboolean                           g_main_loop_quit_stub_called;
 extern gboolean                           g_bus_get_sync_set_error;
+extern gboolean                           g_bus_get_stub_called;
 extern guint                              g_timeout_add_seconds_called_interval;
 extern gboolean                           g_timeout_add_seconds_called;
 extern gboolean                           g_dbus_interface_skeleton_export_stub_set_error;
-extern gboolean                           g_dbus_connection_new_for_address_sync_stub_set_error;
+extern gboolean                           g_dbus_connection_new_for_address_finish_stub_set_error;
+extern guint                              g_dbus_connection_new_for_address_stub_called;
 extern gboolean                           g_dbus_connection_call_sync_stub_set_error;
 extern GdbusConnectionCallSyncStubControl g_dbus_connection_call_sync_stub_control;
+extern guint                              g_dbus_connection_call_stub_called;
+extern const gchar                       *g_dbus_connection_call_stub_method;
+extern GVariant                          *g_dbus_connection_call_finish_stub_rval;
+extern gboolean                           g_dbus_connection_call_finish_stub_cancelled;
+extern gint                               g_dbus_connection_call_finish_stub_error_code;
+extern gboolean                           g_file_test_stub_deleted;
+extern guint                              g_spawn_async_stub_called;
+extern pid_t                              kill_stub_pid;
+extern int                                kill_stub_signal;
+
+#define G_SPAWN_ASYNC_STUB_PID 4711
 
 
 /*******************************************************************************
@@ -60,13 +74,6 @@ extern GdbusConnectionCallSyncStubControl g_dbus_connection_call_sync_stub_contr
 /* File and folder reading */
 gboolean          g_file_test_stub                      (const gchar             *filename,
                                                          GFileTest                test);
-gchar            *g_file_read_link_stub                 (const gchar             *filename,
-                                                         GError                 **error);
-GDir             *g_dir_open_stub                       (const gchar             *path,
-                                                         guint                    flags,
-                                                         GError                 **error);
-const gchar      *g_dir_read_name_stub                  (GDir                    *dir);
-void              g_dir_close_stub                      (GDir                    *dir);
 
 /* Mainloop handling */
 void              g_main_loop_run_stub                  (GMainLoop               *loop);
@@ -76,6 +83,12 @@ void              g_main_loop_quit_stub                 (GMainLoop
 GDBusConnection  *g_bus_get_sync_stub                   (GBusType                 bus_type,
                                                          GCancellable            *cancellable,
                                                          GError                 **error);
+void              g_bus_get_stub                        (GBusType                 bus_type,
+                                                         GCancellable            *cancellable,
+                                                         GAsyncReadyCallback      callback,
+                                                         gpointer                 user_data);
+GDBusConnection  *g_bus_get_finish_stub                 (GAsyncResult            *res,
+                                                         GError                 **error);
 const gchar      *g_dbus_connection_get_unique_name_stub(GDBusConnection         *connection);
 guint             g_bus_own_name_stub                   (GBusType                 bus_type,
                                                          const gchar             *name,
@@ -92,10 +105,13 @@ gboolean          g_dbus_interface_skeleton_export_stub (GDBusInterfaceSkeleton
                                                          const gchar             *object_path,
                                                          GError                 **error);
 
-GDBusConnection *g_dbus_connection_new_for_address_sync_stub(const gchar            *address,
+void             g_dbus_connection_new_for_address_stub     (const gchar            *address,
                                                              GDBusConnectionFlags    flags,
                                                              GDBusAuthObserver      *observer,
                                                              GCancellable           *cancellable,
+                                                             GAsyncReadyCallback     callback,
+                                                             gpointer                user_data);
+GDBusConnection *g_dbus_connection_new_for_address_finish_stub(GAsyncResult         *res,
                                                              GError                **error);
 
 GVariant        *g_dbus_connection_call_sync_stub           (GDBusConnection    *connection,
@@ -121,6 +137,21 @@ guint            g_dbus_connection_signal_subscribe_stub    (GDBusConnection
                                                              GDestroyNotify       user_data_free_func);
 void             g_dbus_connection_signal_unsubscribe_stub  (GDBusConnection     *connection,
                                                              guint                subscription_id);
+void             g_dbus_connection_call_stub                (GDBusConnection     *connection,
+                                                             const gchar         *bus_name,
+                                                             const gchar         *object_path,
+                                                             const gchar         *interface_name,
+                                                             const gchar         *method_name,
+                                                             GVariant            *parameters,
+                                                             const GVariantType  *reply_type,
+                                                             GDBusCallFlags       flags,
+                                                             gint                 timeout_msec,
+                                                             GCancellable        *cancellable,
+                                                             GAsyncReadyCallback  callback,
+                                                             gpointer             user_data);
+GVariant        *g_dbus_connection_call_finish_stub         (GDBusConnection     *connection,
+                                                             GAsyncResult        *res,
+                                                             GError             **error);
 GVariant        *g_dbus_connection_call_sync_stub           (GDBusConnection    *connection,
                                                              const gchar        *bus_name,
                                                              const gchar        *object_path,
@@ -146,16 +177,16 @@ gulong            g_signal_connect_data_stub            (gpointer
                                                          GConnectFlags            connect_flags);
 
 /* Process handling */
-gboolean          g_spawn_sync_stub                     (const gchar             *working_directory,
+gboolean          g_spawn_async_stub                    (const gchar             *working_directory,
                                                          gchar                  **argv,
                                                          gchar                  **envp,
                                                          GSpawnFlags              flags,
                                                          GSpawnChildSetupFunc     child_setup,
                                                          gpointer                 user_data,
-                                                         gchar                  **standard_output,
-                                                         gchar                  **standard_error,
-                                                         gint                    *exit_status,
+                                                         GPid                    *child_pid,
                                                          GError                 **error);
+int               kill_stub                             (pid_t                    pid,
+                                                         int                      sig);
 
 
 #endif /* GIO_STUB_H */
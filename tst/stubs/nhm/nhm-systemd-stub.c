@@ -46,3 +46,27 @@ nhm_systemd_disconnect_stub(void)
 {
 
 }
+
+/**
+ * nhm_systemd_set_unit_filter_stub:
+ *
+ * Stub for nhm_systemd_set_unit_filter()
+ */
+void
+nhm_systemd_set_unit_filter_stub(gchar **include,
+                                 gchar **exclude,
+                                 gchar **types)
+{
+
+}
+
+/**
+ * nhm_systemd_free_unit_filter_stub:
+ *
+ * Stub for nhm_systemd_free_unit_filter()
+ */
+void
+nhm_systemd_free_unit_filter_stub(void)
+{
+
+}
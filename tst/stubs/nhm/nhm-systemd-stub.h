@@ -27,7 +27,11 @@
 *
 *******************************************************************************/
 
-gboolean nhm_systemd_connect_stub   (NhmSystemdAppStatusCb app_status_cb);
-void     nhm_systemd_disconnect_stub(void);
+gboolean nhm_systemd_connect_stub         (NhmSystemdAppStatusCb   app_status_cb);
+void     nhm_systemd_disconnect_stub      (void);
+void     nhm_systemd_set_unit_filter_stub (gchar                 **include,
+                                           gchar                 **exclude,
+                                           gchar                 **types);
+void     nhm_systemd_free_unit_filter_stub(void);
 
 #endif /* NHM_SYSTEMD_STUB_H */